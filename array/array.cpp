@@ -0,0 +1,124 @@
+#include "array.hpp"
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+// Built entirely at compile time
+static constexpr fun::array<uint32_t, 256> make_crc_table() {
+    fun::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        table[i] = c;
+    }
+    return table;
+}
+
+static constexpr auto crc_table = make_crc_table();
+
+template <typename T, size_t N, size_t Align>
+static bool is_aligned(const fun::array<T, N, Align>& arr) {
+    return reinterpret_cast<uintptr_t>(arr.data()) % Align == 0;
+}
+
+TEST(ArrayTests, AggregateInit) {
+    fun::array<int, 4> arr{1, 2, 3};
+    EXPECT_EQ(arr.size(), 4);
+    EXPECT_EQ(arr[0], 1);
+    EXPECT_EQ(arr[2], 3);
+    // Missing initializers are value-initialized, like std::array
+    EXPECT_EQ(arr[3], 0);
+}
+
+TEST(ArrayTests, Deduction) {
+    fun::array arr{1.0, 2.0, 3.0};
+    static_assert(std::is_same_v<decltype(arr), fun::array<double, 3>>);
+    EXPECT_EQ(arr.back(), 3.0);
+}
+
+TEST(ArrayTests, ConstexprLookupTable) {
+    static_assert(crc_table[0] == 0);
+    static_assert(crc_table[1] == 0x77073096u);
+    static_assert(crc_table[255] == 0x2D02EF8Du);
+    EXPECT_EQ(crc_table.size(), 256);
+}
+
+TEST(ArrayTests, ConstexprAccessors) {
+    constexpr fun::array<int, 3> arr{4, 5, 6};
+    static_assert(arr.front() == 4);
+    static_assert(arr.back() == 6);
+    static_assert(arr.at(1) == 5);
+    static_assert(*(arr.end() - 1) == 6);
+    static_assert(fun::get<2>(arr) == 6);
+    static_assert(arr == fun::array<int, 3>{4, 5, 6});
+    static_assert(arr < fun::array<int, 3>{4, 6, 0});
+    SUCCEED();
+}
+
+TEST(ArrayTests, At) {
+    fun::array<int, 2> arr{1, 2};
+    EXPECT_EQ(arr.at(1), 2);
+    EXPECT_THROW(arr.at(2), std::out_of_range);
+}
+
+TEST(ArrayTests, IterateAndFill) {
+    fun::array<int, 5> arr{};
+    arr.fill(3);
+
+    int sum = 0;
+    for (int x : arr) {
+        sum += x;
+    }
+    EXPECT_EQ(sum, 15);
+}
+
+TEST(ArrayTests, Swap) {
+    fun::array<std::string, 2> a{"a", "b"};
+    fun::array<std::string, 2> b{"c", "d"};
+    a.swap(b);
+    EXPECT_EQ(a[0], "c");
+    EXPECT_EQ(b[1], "b");
+}
+
+TEST(ArrayTests, StructuredBindings) {
+    fun::array<int, 3> point{1, 2, 3};
+    auto [x, y, z] = point;
+    EXPECT_EQ(x + y + z, 6);
+}
+
+TEST(ArrayTests, TriviallyCopyable) {
+    static_assert(std::is_trivially_copyable_v<fun::array<int, 8>>);
+    static_assert(std::is_trivially_copyable_v<fun::array<float, 8, 64>>);
+    static_assert(std::is_aggregate_v<fun::array<float, 8, 64>>);
+    SUCCEED();
+}
+
+TEST(ArrayAlignTests, DefaultIsNaturalAlignment) {
+    static_assert(alignof(fun::array<float, 3>) == alignof(float));
+    static_assert(sizeof(fun::array<float, 3>) == 3 * sizeof(float));
+    SUCCEED();
+}
+
+TEST(ArrayAlignTests, OverAligned) {
+    static_assert(alignof(fun::array<float, 3, 32>) == 32);
+    // Padded to whole lines, so arrays of arrays stay aligned too
+    static_assert(sizeof(fun::array<float, 3, 32>) == 32);
+    static_assert(sizeof(fun::array<float, 20, 64>) == 128);
+
+    fun::array<float, 20, 64> on_stack{};
+    EXPECT_TRUE(is_aligned(on_stack));
+
+    fun::array<float, 20, 64> several[3]{};
+    EXPECT_TRUE(is_aligned(several[1]));
+    EXPECT_TRUE(is_aligned(several[2]));
+}
+
+TEST(ArrayAlignTests, OverAlignedOnHeap) {
+    // C++17 aligned new picks up alignof on its own
+    auto heap = std::make_unique<fun::array<double, 100, 64>>();
+    EXPECT_TRUE(is_aligned(*heap));
+}
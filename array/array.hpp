@@ -0,0 +1,136 @@
+#pragma once
+#include <cstddef>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/*
+    fun::array<float, 8> arr{1, 2, 3};
+        -> an aggregate around T[N], same as std::array, and everything is
+           constexpr so lookup tables can be built at compile time
+
+    fun::array<float, 1024, 64> samples;
+        -> elements start on a 64 byte boundary (a cache line, or two AVX
+           registers), and sizeof is padded to a multiple of 64, so loops
+           over it can use aligned loads and never straddle a line
+*/
+namespace fun {
+
+template <typename T, size_t N, size_t Align = alignof(T)> struct array {
+    static_assert((Align & (Align - 1)) == 0, "Align must be a power of two");
+    static_assert(Align >= alignof(T), "Align can't be less than alignof(T)");
+
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    static constexpr size_t alignment = Align;
+
+    // Public only so array stays an aggregate, use data() instead
+    alignas(Align) T elems_[N > 0 ? N : 1];
+
+    constexpr T& operator[](size_t idx) { return elems_[idx]; }
+    constexpr const T& operator[](size_t idx) const { return elems_[idx]; }
+
+    constexpr T& at(size_t idx) {
+        if (idx >= N) {
+            throw std::out_of_range("Value accessed out of range!");
+        }
+
+        return elems_[idx];
+    }
+    constexpr const T& at(size_t idx) const {
+        if (idx >= N) {
+            throw std::out_of_range("Value accessed out of range!");
+        }
+
+        return elems_[idx];
+    }
+
+    constexpr T& front() { return elems_[0]; }
+    constexpr const T& front() const { return elems_[0]; }
+    constexpr T& back() { return elems_[N - 1]; }
+    constexpr const T& back() const { return elems_[N - 1]; }
+
+    constexpr T* data() noexcept { return elems_; }
+    constexpr const T* data() const noexcept { return elems_; }
+    constexpr T* begin() noexcept { return elems_; }
+    constexpr const T* begin() const noexcept { return elems_; }
+    constexpr T* end() noexcept { return elems_ + N; }
+    constexpr const T* end() const noexcept { return elems_ + N; }
+
+    [[nodiscard]] static constexpr size_t size() noexcept { return N; }
+    static constexpr bool empty() noexcept { return N == 0; }
+
+    constexpr void fill(const T& val) {
+        for (size_t i = 0; i < N; i++) {
+            elems_[i] = val;
+        }
+    }
+    constexpr void swap(array& other) noexcept(std::is_nothrow_swappable_v<T>) {
+        for (size_t i = 0; i < N; i++) {
+            using std::swap;
+            swap(elems_[i], other.elems_[i]);
+        }
+    }
+};
+
+template <typename T, typename... U>
+array(T, U...) -> array<T, 1 + sizeof...(U)>;
+
+template <typename T, size_t N, size_t Align>
+constexpr bool operator==(const array<T, N, Align>& a,
+                          const array<T, N, Align>& b) {
+    for (size_t i = 0; i < N; i++) {
+        if (!(a[i] == b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+template <typename T, size_t N, size_t Align>
+constexpr bool operator!=(const array<T, N, Align>& a,
+                          const array<T, N, Align>& b) {
+    return !(a == b);
+}
+template <typename T, size_t N, size_t Align>
+constexpr bool operator<(const array<T, N, Align>& a,
+                         const array<T, N, Align>& b) {
+    for (size_t i = 0; i < N; i++) {
+        if (a[i] < b[i]) {
+            return true;
+        }
+        if (b[i] < a[i]) {
+            return false;
+        }
+    }
+    return false;
+}
+
+// For structured bindings, auto [x, y, z] = point;
+template <size_t I, typename T, size_t N, size_t Align>
+constexpr T& get(array<T, N, Align>& arr) noexcept {
+    static_assert(I < N, "get<I> out of range");
+    return arr.elems_[I];
+}
+template <size_t I, typename T, size_t N, size_t Align>
+constexpr const T& get(const array<T, N, Align>& arr) noexcept {
+    static_assert(I < N, "get<I> out of range");
+    return arr.elems_[I];
+}
+template <size_t I, typename T, size_t N, size_t Align>
+constexpr T&& get(array<T, N, Align>&& arr) noexcept {
+    static_assert(I < N, "get<I> out of range");
+    return std::move(arr.elems_[I]);
+}
+
+}; // namespace fun
+
+template <typename T, size_t N, size_t Align>
+struct std::tuple_size<fun::array<T, N, Align>>
+    : std::integral_constant<size_t, N> {};
+template <size_t I, typename T, size_t N, size_t Align>
+struct std::tuple_element<I, fun::array<T, N, Align>> {
+    using type = T;
+};
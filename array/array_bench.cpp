@@ -0,0 +1,85 @@
+#include "array.hpp"
+#include <benchmark/benchmark.h>
+#include <memory>
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+/*
+    Summing floats out of a 64-byte aligned fun::array, once from data()
+    (every 32 byte load is aligned and inside one cache line) and once from
+    data() + 1 (every load is unaligned, every other one splits a line).
+
+    Without AVX it falls back to a scalar loop, and both cases measure the
+    same thing.
+*/
+static float reduce_aligned(const float* p, size_t n) {
+#if defined(__AVX__)
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    for (size_t i = 0; i + 16 <= n; i += 16) {
+        acc0 = _mm256_add_ps(acc0, _mm256_load_ps(p + i));
+        acc1 = _mm256_add_ps(acc1, _mm256_load_ps(p + i + 8));
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, _mm256_add_ps(acc0, acc1));
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] +
+           lanes[6] + lanes[7];
+#else
+    float sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        sum += p[i];
+    }
+    return sum;
+#endif
+}
+
+static float reduce_unaligned(const float* p, size_t n) {
+#if defined(__AVX__)
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    for (size_t i = 0; i + 16 <= n; i += 16) {
+        acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(p + i));
+        acc1 = _mm256_add_ps(acc1, _mm256_loadu_ps(p + i + 8));
+    }
+    float lanes[8];
+    _mm256_storeu_ps(lanes, _mm256_add_ps(acc0, acc1));
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] +
+           lanes[6] + lanes[7];
+#else
+    float sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        sum += p[i];
+    }
+    return sum;
+#endif
+}
+
+// One spare element so the unaligned walk covers as many floats
+template <size_t N> using Samples = fun::array<float, N + 16, 64>;
+
+template <size_t N> static void BM_ReduceAligned(benchmark::State& state) {
+    auto samples = std::make_unique<Samples<N>>();
+    samples->fill(1.0f);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(reduce_aligned(samples->data(), N));
+    }
+    state.SetBytesProcessed(state.iterations() * N * sizeof(float));
+}
+
+template <size_t N> static void BM_ReduceUnaligned(benchmark::State& state) {
+    auto samples = std::make_unique<Samples<N>>();
+    samples->fill(1.0f);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(reduce_unaligned(samples->data() + 1, N));
+    }
+    state.SetBytesProcessed(state.iterations() * N * sizeof(float));
+}
+
+// L1 resident, then L2/L3 sized
+BENCHMARK_TEMPLATE(BM_ReduceAligned, 4096);
+BENCHMARK_TEMPLATE(BM_ReduceUnaligned, 4096);
+BENCHMARK_TEMPLATE(BM_ReduceAligned, 1 << 20);
+BENCHMARK_TEMPLATE(BM_ReduceUnaligned, 1 << 20);
@@ -0,0 +1,46 @@
+#pragma once
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/*
+    Shared bits for the head-to-head fun:: vs std:: suite.
+
+    elem<Bytes> is a trivially copyable payload of exactly Bytes bytes, so
+    the same benchmark can be run at a few element sizes and we can see where
+    the costs start scaling with sizeof(T) instead of with count.
+*/
+template <size_t Bytes> struct elem {
+    int key;
+    char pad[Bytes - sizeof(int)];
+
+    elem() = default;
+    elem(int k) : key{k}, pad{} {}
+};
+
+template <> struct elem<sizeof(int)> {
+    int key;
+
+    elem() = default;
+    elem(int k) : key{k} {}
+};
+
+static_assert(sizeof(elem<64>) == 64);
+static_assert(sizeof(elem<sizeof(int)>) == sizeof(int));
+
+// Same seed everywhere so fun:: and std:: see identical access patterns
+inline std::vector<uint32_t> random_indices(size_t count, size_t bound) {
+    std::mt19937 rng(42);
+    std::vector<uint32_t> idx(count);
+    for (auto& i : idx) {
+        i = static_cast<uint32_t>(rng() % bound);
+    }
+    return idx;
+}
+
+// Element counts every container benchmark sweeps
+inline void bench_counts(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(16)->Range(1 << 4, 1 << 20);
+}
@@ -0,0 +1,115 @@
+#include "bench_common.hpp"
+#include "optional.hpp"
+#include <optional>
+#include <utility>
+#include <vector>
+
+/*
+    fun::optional against std::optional. Each benchmark works on a batch of
+    n optionals (every third one empty) so the engaged check is a real
+    unpredictable-ish branch and not hoisted out of the loop.
+*/
+template <typename Opt> static std::vector<Opt> make_batch(size_t n) {
+    std::vector<Opt> batch(n);
+    for (size_t i = 0; i < n; i++) {
+        if (i % 3 != 0) {
+            batch[i] = Opt(static_cast<int>(i));
+        }
+    }
+    return batch;
+}
+
+template <typename Opt>
+static void report(benchmark::State& state, size_t n) {
+    state.SetItemsProcessed(state.iterations() * n);
+    state.SetBytesProcessed(state.iterations() * n * sizeof(Opt));
+}
+
+// Engage and disengage in place, the push_back of an optional
+template <typename Opt> static void BM_OptionalEmplace(benchmark::State& state) {
+    const size_t n = state.range(0);
+    std::vector<Opt> batch(n);
+    for (auto _ : state) {
+        for (size_t i = 0; i < n; i++) {
+            batch[i].emplace(static_cast<int>(i));
+        }
+        benchmark::DoNotOptimize(batch.data());
+        for (auto& o : batch) {
+            o.reset();
+        }
+    }
+    report<Opt>(state, n);
+}
+
+template <typename Opt> static void BM_OptionalCopy(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const auto src = make_batch<Opt>(n);
+    std::vector<Opt> dst(n);
+    for (auto _ : state) {
+        for (size_t i = 0; i < n; i++) {
+            dst[i] = src[i];
+        }
+        benchmark::DoNotOptimize(dst.data());
+    }
+    report<Opt>(state, n);
+}
+
+template <typename Opt> static void BM_OptionalMove(benchmark::State& state) {
+    const size_t n = state.range(0);
+    auto a = make_batch<Opt>(n);
+    std::vector<Opt> b(n);
+    for (auto _ : state) {
+        for (size_t i = 0; i < n; i++) {
+            b[i] = std::move(a[i]);
+        }
+        std::swap(a, b);
+        benchmark::DoNotOptimize(a.data());
+    }
+    report<Opt>(state, n);
+}
+
+template <typename Opt> static void BM_OptionalIterate(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const auto batch = make_batch<Opt>(n);
+    for (auto _ : state) {
+        long long sum = 0;
+        for (const auto& o : batch) {
+            if (o.has_value()) {
+                sum += (*o).key;
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    report<Opt>(state, n);
+}
+
+template <typename Opt>
+static void BM_OptionalRandomAccess(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const auto batch = make_batch<Opt>(n);
+    const auto idx = random_indices(n, n);
+    for (auto _ : state) {
+        long long sum = 0;
+        for (uint32_t i : idx) {
+            const Opt& o = batch[i];
+            sum += o.has_value() ? (*o).key : -1;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    report<Opt>(state, n);
+}
+
+#define OPTIONAL_BENCH(fn, T)                                                  \
+    BENCHMARK_TEMPLATE(fn, std::optional<T>)->Apply(bench_counts);             \
+    BENCHMARK_TEMPLATE(fn, fun::optional<T>)->Apply(bench_counts);
+
+#define OPTIONAL_BENCH_SIZES(fn)                                               \
+    OPTIONAL_BENCH(fn, elem<4>)                                                \
+    OPTIONAL_BENCH(fn, elem<64>)                                               \
+    OPTIONAL_BENCH(fn, elem<256>)
+
+OPTIONAL_BENCH_SIZES(BM_OptionalEmplace)
+OPTIONAL_BENCH_SIZES(BM_OptionalCopy)
+OPTIONAL_BENCH_SIZES(BM_OptionalMove)
+OPTIONAL_BENCH_SIZES(BM_OptionalIterate)
+OPTIONAL_BENCH_SIZES(BM_OptionalRandomAccess)
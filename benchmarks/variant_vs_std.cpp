@@ -0,0 +1,144 @@
+#include "bench_common.hpp"
+#include "variant.hpp"
+#include <utility>
+#include <variant>
+#include <vector>
+
+/*
+    fun::variant against std::variant over variant<int, double, elem<N>>, a
+    batch of n with the alternative picked at random. N is the element size
+    parameter, it's what the variant's storage (and every copy) scales with.
+    variant/variant_bench.cpp has the dispatch-heavy message loop, this is
+    the everyday construct/copy/move/visit side.
+*/
+template <template <typename...> class Var, typename T>
+using var_of = Var<int, double, T>;
+
+template <typename Var> static std::vector<Var> make_batch(size_t n) {
+    const auto kind = random_indices(n, 3);
+    std::vector<Var> batch;
+    batch.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        const int v = static_cast<int>(i);
+        switch (kind[i]) {
+        case 0:
+            batch.emplace_back(v);
+            break;
+        case 1:
+            batch.emplace_back(static_cast<double>(v));
+            break;
+        default:
+            batch.emplace_back(std::in_place_index<2>, v);
+            break;
+        }
+    }
+    return batch;
+}
+
+template <typename Var> static void report(benchmark::State& state, size_t n) {
+    state.SetItemsProcessed(state.iterations() * n);
+    state.SetBytesProcessed(state.iterations() * n * sizeof(Var));
+}
+
+// Picks the visit that goes with the variant, fun:: or std::
+struct visit_fn {
+    template <typename F, typename... Ts>
+    auto operator()(F&& f, const std::variant<Ts...>& v) const {
+        return std::visit(std::forward<F>(f), v);
+    }
+    template <typename F, typename... Ts>
+    auto operator()(F&& f, const fun::variant<Ts...>& v) const {
+        return fun::visit(std::forward<F>(f), v);
+    }
+};
+
+struct key_of {
+    long long operator()(int i) const { return i; }
+    long long operator()(double d) const { return static_cast<long long>(d); }
+    template <typename T> long long operator()(const T& e) const {
+        return e.key;
+    }
+};
+
+// Switching alternatives every time, so it's destroy + construct each step
+template <typename Var> static void BM_VariantEmplace(benchmark::State& state) {
+    const size_t n = state.range(0);
+    std::vector<Var> batch(n);
+    for (auto _ : state) {
+        for (size_t i = 0; i < n; i++) {
+            batch[i].template emplace<2>(static_cast<int>(i));
+        }
+        benchmark::DoNotOptimize(batch.data());
+        for (size_t i = 0; i < n; i++) {
+            batch[i].template emplace<0>(static_cast<int>(i));
+        }
+    }
+    report<Var>(state, n);
+}
+
+template <typename Var> static void BM_VariantCopy(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const auto src = make_batch<Var>(n);
+    for (auto _ : state) {
+        std::vector<Var> copy(src);
+        benchmark::DoNotOptimize(copy.data());
+    }
+    report<Var>(state, n);
+}
+
+template <typename Var> static void BM_VariantMove(benchmark::State& state) {
+    const size_t n = state.range(0);
+    auto a = make_batch<Var>(n);
+    std::vector<Var> b(n);
+    for (auto _ : state) {
+        for (size_t i = 0; i < n; i++) {
+            b[i] = std::move(a[i]);
+        }
+        std::swap(a, b);
+        benchmark::DoNotOptimize(a.data());
+    }
+    report<Var>(state, n);
+}
+
+template <typename Var> static void BM_VariantIterate(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const auto batch = make_batch<Var>(n);
+    for (auto _ : state) {
+        long long sum = 0;
+        for (const auto& v : batch) {
+            sum += visit_fn{}(key_of{}, v);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    report<Var>(state, n);
+}
+
+template <typename Var>
+static void BM_VariantRandomAccess(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const auto batch = make_batch<Var>(n);
+    const auto idx = random_indices(n, n);
+    for (auto _ : state) {
+        long long sum = 0;
+        for (uint32_t i : idx) {
+            sum += visit_fn{}(key_of{}, batch[i]);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    report<Var>(state, n);
+}
+
+#define VARIANT_BENCH(fn, T)                                                   \
+    BENCHMARK_TEMPLATE(fn, var_of<std::variant, T>)->Apply(bench_counts);      \
+    BENCHMARK_TEMPLATE(fn, var_of<fun::variant, T>)->Apply(bench_counts);
+
+#define VARIANT_BENCH_SIZES(fn)                                                \
+    VARIANT_BENCH(fn, elem<4>)                                                 \
+    VARIANT_BENCH(fn, elem<64>)                                                \
+    VARIANT_BENCH(fn, elem<256>)
+
+VARIANT_BENCH_SIZES(BM_VariantEmplace)
+VARIANT_BENCH_SIZES(BM_VariantCopy)
+VARIANT_BENCH_SIZES(BM_VariantMove)
+VARIANT_BENCH_SIZES(BM_VariantIterate)
+VARIANT_BENCH_SIZES(BM_VariantRandomAccess)
@@ -0,0 +1,102 @@
+#include "bench_common.hpp"
+#include "vector.hpp"
+#include <utility>
+#include <vector>
+
+/*
+    fun::vector against std::vector for the everyday operations, at 4, 64
+    and 256 byte elements. Items are elements, so items_per_second is
+    comparable across sizes and bytes_per_second across counts.
+*/
+template <typename Vec> static Vec make_filled(size_t n) {
+    Vec v;
+    v.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        v.push_back(static_cast<int>(i));
+    }
+    return v;
+}
+
+template <typename Vec> static void report(benchmark::State& state, size_t n) {
+    state.SetItemsProcessed(state.iterations() * n);
+    state.SetBytesProcessed(state.iterations() * n *
+                            sizeof(typename Vec::value_type));
+}
+
+// No reserve, so regrowth is part of it
+template <typename Vec> static void BM_VectorPushBack(benchmark::State& state) {
+    const size_t n = state.range(0);
+    for (auto _ : state) {
+        Vec v;
+        for (size_t i = 0; i < n; i++) {
+            v.push_back(static_cast<int>(i));
+        }
+        benchmark::DoNotOptimize(v.data());
+    }
+    report<Vec>(state, n);
+}
+
+template <typename Vec> static void BM_VectorCopy(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const Vec src = make_filled<Vec>(n);
+    for (auto _ : state) {
+        Vec copy(src);
+        benchmark::DoNotOptimize(copy.data());
+    }
+    report<Vec>(state, n);
+}
+
+// Should be O(1) regardless of n, pointer steal plus one free
+template <typename Vec> static void BM_VectorMove(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Vec a = make_filled<Vec>(n);
+    for (auto _ : state) {
+        Vec b(std::move(a));
+        benchmark::DoNotOptimize(b.data());
+        a = std::move(b);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename Vec> static void BM_VectorIterate(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const Vec v = make_filled<Vec>(n);
+    for (auto _ : state) {
+        long long sum = 0;
+        for (const auto& e : v) {
+            sum += e.key;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    report<Vec>(state, n);
+}
+
+template <typename Vec>
+static void BM_VectorRandomAccess(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const Vec v = make_filled<Vec>(n);
+    const auto idx = random_indices(n, n);
+    for (auto _ : state) {
+        long long sum = 0;
+        for (uint32_t i : idx) {
+            sum += v[i].key;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    report<Vec>(state, n);
+}
+
+#define VECTOR_BENCH(fn, T)                                                    \
+    BENCHMARK_TEMPLATE(fn, std::vector<T>)->Apply(bench_counts);               \
+    BENCHMARK_TEMPLATE(fn, fun::vector<T>)->Apply(bench_counts);
+
+#define VECTOR_BENCH_SIZES(fn)                                                 \
+    VECTOR_BENCH(fn, elem<4>)                                                  \
+    VECTOR_BENCH(fn, elem<64>)                                                 \
+    VECTOR_BENCH(fn, elem<256>)
+
+VECTOR_BENCH_SIZES(BM_VectorPushBack)
+VECTOR_BENCH_SIZES(BM_VectorCopy)
+VECTOR_BENCH_SIZES(BM_VectorMove)
+VECTOR_BENCH_SIZES(BM_VectorIterate)
+VECTOR_BENCH_SIZES(BM_VectorRandomAccess)
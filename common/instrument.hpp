@@ -0,0 +1,170 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+/*
+    Opt-in counters for what the containers do behind your back: allocations
+    (with a histogram of their sizes), bytes, and element copies, moves and
+    destroys. Build with FUN_INSTRUMENT defined (cmake -DFUN_INSTRUMENT=ON)
+    to turn them on.
+
+    The containers only call FUN_INSTRUMENT_HOOK(...) at their choke points
+    (raw_alloc_arr, copy_into_arr, move_into_arr, ...), which expands to
+    nothing without FUN_INSTRUMENT, so a normal build doesn't even evaluate
+    the arguments.
+
+    Counters are thread_local, so a test only ever sees its own thread's
+    work. For allocation budgets:
+
+    fun::instrument::scope s;
+    hot_path();
+    EXPECT_LE(s.delta().allocations, 1);
+
+    memcpy paths count every element they cover, so the numbers mean the
+    same thing whether or not T is trivially copyable.
+*/
+namespace fun {
+namespace instrument {
+
+// Bucket k counts allocations of [2^k, 2^(k+1)) bytes, bucket 0 also gets 0
+inline constexpr size_t histogram_buckets = 48;
+
+struct counters {
+    uint64_t allocations = 0;
+    uint64_t deallocations = 0;
+    uint64_t bytes_allocated = 0;
+    uint64_t bytes_freed = 0;
+    uint64_t copies = 0;
+    uint64_t moves = 0;
+    uint64_t destroys = 0;
+    uint64_t alloc_histogram[histogram_buckets] = {};
+
+    uint64_t live_bytes() const { return bytes_allocated - bytes_freed; }
+
+    counters operator-(const counters& before) const {
+        counters d = *this;
+        d.allocations -= before.allocations;
+        d.deallocations -= before.deallocations;
+        d.bytes_allocated -= before.bytes_allocated;
+        d.bytes_freed -= before.bytes_freed;
+        d.copies -= before.copies;
+        d.moves -= before.moves;
+        d.destroys -= before.destroys;
+        for (size_t k = 0; k < histogram_buckets; k++) {
+            d.alloc_histogram[k] -= before.alloc_histogram[k];
+        }
+        return d;
+    }
+};
+
+inline counters& stats() noexcept {
+    static thread_local counters tls;
+    return tls;
+}
+
+inline void reset() noexcept { stats() = counters{}; }
+
+constexpr size_t histogram_bucket(size_t bytes) noexcept {
+    size_t k = 0;
+    while (bytes > 1 && k + 1 < histogram_buckets) {
+        bytes >>= 1;
+        k++;
+    }
+    return k;
+}
+
+// Snapshot at construction, delta() is everything since
+class scope {
+public:
+    scope() : start_ { stats() } {}
+    counters delta() const { return stats() - start_; }
+
+private:
+    counters start_;
+};
+
+inline void report(std::ostream& out, const counters& c = stats()) {
+    out << "allocations: " << c.allocations << " (" << c.bytes_allocated
+        << " bytes), deallocations: " << c.deallocations << " ("
+        << c.bytes_freed << " bytes)\n"
+        << "copies: " << c.copies << ", moves: " << c.moves
+        << ", destroys: " << c.destroys << '\n';
+    for (size_t k = 0; k < histogram_buckets; k++) {
+        if (c.alloc_histogram[k] != 0) {
+            out << "  [" << (k == 0 ? 0 : uint64_t{1} << k) << ", "
+                << (uint64_t{1} << (k + 1)) << "): " << c.alloc_histogram[k]
+                << '\n';
+        }
+    }
+}
+
+namespace hooks {
+inline void on_allocate(size_t bytes) noexcept {
+    counters& c = stats();
+    c.allocations++;
+    c.bytes_allocated += bytes;
+    c.alloc_histogram[histogram_bucket(bytes)]++;
+}
+// An allocation that turned out bigger than asked (usable_capacity)
+inline void on_extend(size_t bytes) noexcept {
+    stats().bytes_allocated += bytes;
+}
+inline void on_deallocate(size_t bytes) noexcept {
+    counters& c = stats();
+    c.deallocations++;
+    c.bytes_freed += bytes;
+}
+inline void on_copy(size_t count) noexcept { stats().copies += count; }
+inline void on_move(size_t count) noexcept { stats().moves += count; }
+inline void on_destroy(size_t count) noexcept { stats().destroys += count; }
+}; // namespace hooks
+
+/*
+    An element that keeps its own score of special member calls, whether or
+    not FUN_INSTRUMENT is on. Handy to check a container against the hooks,
+    or on its own to test copy/move behavior.
+*/
+struct counting_element {
+    struct counts {
+        uint64_t constructs = 0;
+        uint64_t copies = 0;
+        uint64_t moves = 0;
+        uint64_t destroys = 0;
+
+        uint64_t alive() const {
+            return constructs + copies + moves - destroys;
+        }
+    };
+
+    static counts& tally() noexcept {
+        static thread_local counts tls;
+        return tls;
+    }
+
+    int value;
+
+    counting_element(int v = 0) : value { v } { tally().constructs++; }
+    counting_element(const counting_element& o) : value { o.value } {
+        tally().copies++;
+    }
+    counting_element(counting_element&& o) noexcept : value { o.value } {
+        tally().moves++;
+    }
+    counting_element& operator=(const counting_element&) = default;
+    counting_element& operator=(counting_element&&) noexcept = default;
+    ~counting_element() { tally().destroys++; }
+
+    bool operator==(const counting_element& o) const {
+        return value == o.value;
+    }
+};
+
+}; // namespace instrument
+}; // namespace fun
+
+#ifdef FUN_INSTRUMENT
+#define FUN_INSTRUMENT_HOOK(call) ::fun::instrument::hooks::call
+#else
+#define FUN_INSTRUMENT_HOOK(call) ((void)0)
+#endif
@@ -0,0 +1,279 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+/*
+    Memory resources for short-lived, batch-scoped containers.
+
+    Both plug into std::pmr, so anything taking a polymorphic_allocator
+    (fun::pmr::vector<T>, std::pmr::string, ...) can draw from them:
+
+    fun::monotonic_arena arena;
+    fun::pmr::vector<int> v{&arena};
+    ...
+    arena.release(); // every vector built on it is gone in one shot
+
+    Neither is thread-safe, they're meant to be owned by one request/thread.
+*/
+namespace fun {
+
+namespace detail {
+inline size_t align_up(size_t n, size_t alignment) {
+    return (n + alignment - 1) & ~(alignment - 1);
+}
+}; // namespace detail
+
+/*
+    Bump allocator. Allocation is a pointer increment, deallocation is a no-op,
+    and release() throws away everything at once. Chunks grow geometrically,
+    so even a cold release only walks O(log(total bytes)) chunks.
+*/
+class monotonic_arena : public std::pmr::memory_resource {
+public:
+    explicit monotonic_arena(
+        size_t initial_chunk_size = 4096,
+        std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : upstream_{upstream}, chunks_{}, cur_{}, end_{},
+          next_chunk_size_{initial_chunk_size},
+          initial_chunk_size_{initial_chunk_size}, bytes_allocated_{0} {}
+
+    // Use a caller-owned buffer (e.g. on the stack) first, spill upstream
+    monotonic_arena(
+        void* buffer, size_t buffer_size,
+        std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : upstream_{upstream}, chunks_{}, cur_{static_cast<char*>(buffer)},
+          end_{static_cast<char*>(buffer) + buffer_size},
+          next_chunk_size_{buffer_size > 0 ? buffer_size * 2 : 4096},
+          initial_chunk_size_{next_chunk_size_}, bytes_allocated_{0},
+          initial_buffer_{static_cast<char*>(buffer)},
+          initial_size_{buffer_size} {}
+
+    monotonic_arena(const monotonic_arena&) = delete;
+    monotonic_arena& operator=(const monotonic_arena&) = delete;
+    ~monotonic_arena() override {
+        free_chunks(chunks_);
+        chunks_ = nullptr;
+    }
+
+    /*
+        Everything allocated from the arena is now dangling. The newest (and
+        biggest) chunk is kept and rewound, so once an arena has seen its
+        largest request, the next ones never go upstream at all.
+    */
+    void release() noexcept {
+        if (chunks_ == nullptr) {
+            cur_ = initial_buffer_;
+            end_ = initial_buffer_ + initial_size_;
+            next_chunk_size_ = initial_chunk_size_;
+        }
+        else {
+            free_chunks(chunks_->next);
+            chunks_->next = nullptr;
+
+            char* mem = reinterpret_cast<char*>(chunks_);
+            cur_ = mem + sizeof(chunk_header);
+            end_ = mem + chunks_->size;
+            next_chunk_size_ = chunks_->size * 2;
+        }
+
+        bytes_allocated_ = 0;
+    }
+
+    // Bytes handed out (including alignment padding) since the last release
+    size_t bytes_allocated() const noexcept { return bytes_allocated_; }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        char* aligned = align_ptr(cur_, alignment);
+        if (aligned == nullptr || aligned + bytes > end_) {
+            grow(bytes, alignment);
+            aligned = align_ptr(cur_, alignment);
+        }
+
+        bytes_allocated_ += (aligned + bytes) - cur_;
+        cur_ = aligned + bytes;
+        return aligned;
+    }
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(
+        const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    // Lives at the front of every upstream chunk so release() can walk them
+    struct chunk_header {
+        chunk_header* next;
+        size_t size;
+        size_t alignment;
+    };
+
+    std::pmr::memory_resource* upstream_;
+    chunk_header* chunks_;
+    char* cur_;
+    char* end_;
+    size_t next_chunk_size_;
+    size_t initial_chunk_size_;
+    size_t bytes_allocated_;
+    char* initial_buffer_ = nullptr;
+    size_t initial_size_ = 0;
+
+    void free_chunks(chunk_header* chunk) noexcept {
+        while (chunk != nullptr) {
+            chunk_header* next = chunk->next;
+            upstream_->deallocate(chunk, chunk->size, chunk->alignment);
+            chunk = next;
+        }
+    }
+
+    static char* align_ptr(char* p, size_t alignment) {
+        if (p == nullptr) {
+            return nullptr;
+        }
+
+        auto addr = reinterpret_cast<uintptr_t>(p);
+        return p + (detail::align_up(addr, alignment) - addr);
+    }
+
+    void grow(size_t bytes, size_t alignment) {
+        const size_t chunk_alignment =
+            alignment > alignof(chunk_header) ? alignment
+                                              : alignof(chunk_header);
+        const size_t header = detail::align_up(sizeof(chunk_header), alignment);
+
+        size_t chunk_size = next_chunk_size_;
+        while (chunk_size < header + bytes) {
+            chunk_size *= 2;
+        }
+        next_chunk_size_ = chunk_size * 2;
+
+        void* mem = upstream_->allocate(chunk_size, chunk_alignment);
+        auto* chunk = static_cast<chunk_header*>(mem);
+        chunk->next = chunks_;
+        chunk->size = chunk_size;
+        chunk->alignment = chunk_alignment;
+        chunks_ = chunk;
+
+        cur_ = static_cast<char*>(mem) + header;
+        end_ = static_cast<char*>(mem) + chunk_size;
+    }
+};
+
+/*
+    Segregated free lists for power-of-two size classes up to max_block_size.
+    Unlike the arena, deallocated blocks are reused, so it suits long-lived
+    pools where vectors churn. Bigger requests go straight upstream.
+
+    Each slab of a size class is aligned to that class, so a block of class C
+    satisfies any alignment <= C.
+*/
+class pool_resource : public std::pmr::memory_resource {
+public:
+    static constexpr size_t min_block_size = 8;
+    static constexpr size_t max_block_size = 4096;
+    static constexpr size_t blocks_per_slab = 64;
+
+    explicit pool_resource(
+        std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : upstream_{upstream}, free_lists_{}, slabs_{} {}
+
+    pool_resource(const pool_resource&) = delete;
+    pool_resource& operator=(const pool_resource&) = delete;
+    ~pool_resource() override { release(); }
+
+    // Frees every slab. Large blocks are owned by the caller to deallocate
+    void release() noexcept {
+        for (size_t cls = 0; cls < num_classes; cls++) {
+            slab_header* slab = slabs_[cls];
+            const size_t block = class_size(cls);
+            while (slab != nullptr) {
+                slab_header* next = slab->next;
+                upstream_->deallocate(slab, block * (blocks_per_slab + 1),
+                                      block);
+                slab = next;
+            }
+
+            slabs_[cls] = nullptr;
+            free_lists_[cls] = nullptr;
+        }
+    }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        const size_t needed = bytes > alignment ? bytes : alignment;
+        if (needed > max_block_size) {
+            return upstream_->allocate(bytes, alignment);
+        }
+
+        const size_t cls = class_of(needed);
+        if (free_lists_[cls] == nullptr) {
+            refill(cls);
+        }
+
+        free_block* block = free_lists_[cls];
+        free_lists_[cls] = block->next;
+        return block;
+    }
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        const size_t needed = bytes > alignment ? bytes : alignment;
+        if (needed > max_block_size) {
+            upstream_->deallocate(p, bytes, alignment);
+            return;
+        }
+
+        const size_t cls = class_of(needed);
+        auto* block = static_cast<free_block*>(p);
+        block->next = free_lists_[cls];
+        free_lists_[cls] = block;
+    }
+    bool do_is_equal(
+        const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    struct free_block {
+        free_block* next;
+    };
+    struct slab_header {
+        slab_header* next;
+    };
+
+    // 8, 16, ..., 4096
+    static constexpr size_t num_classes = 10;
+
+    std::pmr::memory_resource* upstream_;
+    free_block* free_lists_[num_classes];
+    slab_header* slabs_[num_classes];
+
+    static constexpr size_t class_size(size_t cls) {
+        return min_block_size << cls;
+    }
+    static size_t class_of(size_t bytes) {
+        size_t cls = 0;
+        while (class_size(cls) < bytes) {
+            cls++;
+        }
+        return cls;
+    }
+
+    // Carve a new slab into blocks, the first block holds the slab header
+    void refill(size_t cls) {
+        const size_t block = class_size(cls);
+        char* mem = static_cast<char*>(
+            upstream_->allocate(block * (blocks_per_slab + 1), block));
+
+        auto* slab = reinterpret_cast<slab_header*>(mem);
+        slab->next = slabs_[cls];
+        slabs_[cls] = slab;
+
+        for (size_t i = blocks_per_slab; i >= 1; i--) {
+            auto* b = reinterpret_cast<free_block*>(mem + i * block);
+            b->next = free_lists_[cls];
+            free_lists_[cls] = b;
+        }
+    }
+};
+
+}; // namespace fun
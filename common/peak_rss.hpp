@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <cstdio>
+
+/*
+    Peak resident set size for benchmarks (Linux only, both are no-ops/0
+    elsewhere). Resetting lets every benchmark report its own high-water mark
+    instead of the process-wide one.
+*/
+namespace fun {
+
+inline void reset_peak_rss() {
+    if (FILE* f = std::fopen("/proc/self/clear_refs", "w")) {
+        std::fputs("5", f);
+        std::fclose(f);
+    }
+}
+
+inline size_t peak_rss_kb() {
+    size_t kb = 0;
+    if (FILE* f = std::fopen("/proc/self/status", "r")) {
+        char line[256];
+        while (std::fgets(line, sizeof(line), f)) {
+            if (std::sscanf(line, "VmHWM: %zu kB", &kb) == 1) {
+                break;
+            }
+        }
+        std::fclose(f);
+    }
+    return kb;
+}
+
+}; // namespace fun
@@ -0,0 +1,76 @@
+#pragma once
+#include "fun_macros.h"
+#include <cstddef>
+#include <cuda_runtime.h>
+
+/*
+    The real thing, plain CUDA runtime calls. Only usable when the build found
+    a CUDA compiler (FUN_WITH_CUDA).
+
+    Async copies go on one stream per direction so uploads and downloads can
+    use both copy engines, and an event recorded after each copy is the
+    completion handle. They only truly overlap from pinned host memory.
+*/
+namespace fun {
+
+struct cuda_backend {
+    static void* device_alloc(size_t bytes) {
+        void* p = nullptr;
+        cudaTry(cudaMalloc(&p, bytes));
+        return p;
+    }
+    static void device_free(void* p) noexcept { cudaFree(p); }
+
+    static void* pinned_alloc(size_t bytes) {
+        void* p = nullptr;
+        cudaTry(cudaMallocHost(&p, bytes));
+        return p;
+    }
+    static void pinned_free(void* p) noexcept { cudaFreeHost(p); }
+
+    using event = cudaEvent_t;
+
+    static event copy_to_device_async(void* dst, const void* src,
+                                      size_t bytes) {
+        static const cudaStream_t upload = make_stream();
+        cudaTry(cudaMemcpyAsync(dst, src, bytes, cudaMemcpyHostToDevice,
+                                upload));
+        return record(upload);
+    }
+    static event copy_to_host_async(void* dst, const void* src, size_t bytes) {
+        static const cudaStream_t download = make_stream();
+        cudaTry(cudaMemcpyAsync(dst, src, bytes, cudaMemcpyDeviceToHost,
+                                download));
+        return record(download);
+    }
+    static void wait(event& e) {
+        cudaTry(cudaEventSynchronize(e));
+        cudaEventDestroy(e);
+    }
+    static bool ready(const event& e) {
+        return cudaEventQuery(e) == cudaSuccess;
+    }
+
+    static void copy_to_device(void* dst, const void* src, size_t bytes) {
+        cudaTry(cudaMemcpy(dst, src, bytes, cudaMemcpyHostToDevice));
+    }
+    static void copy_to_host(void* dst, const void* src, size_t bytes) {
+        cudaTry(cudaMemcpy(dst, src, bytes, cudaMemcpyDeviceToHost));
+    }
+
+private:
+    // Non-blocking so they don't serialize against the legacy default stream
+    static cudaStream_t make_stream() {
+        cudaStream_t stream = nullptr;
+        cudaTry(cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking));
+        return stream;
+    }
+    static event record(cudaStream_t stream) {
+        event e = nullptr;
+        cudaTry(cudaEventCreateWithFlags(&e, cudaEventDisableTiming));
+        cudaTry(cudaEventRecord(e, stream));
+        return e;
+    }
+};
+
+}; // namespace fun
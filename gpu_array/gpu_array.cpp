@@ -0,0 +1,479 @@
+#include "gpu_array.hpp"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/*
+    The same gpu_array logic as gpu_array.cu, run against host_backend so it's
+    covered on machines without a GPU. "Kernels" are CPU loops over
+    device_ptr().
+*/
+template <typename T, bool Pinned = false>
+using host_array = fun::gpu_array<T, Pinned, fun::host_backend>;
+
+// host_backend that keeps score, to see what dirty tracking actually sends
+struct counting_backend : fun::host_backend {
+    static inline size_t copies = 0;
+    static inline size_t bytes = 0;
+    static inline size_t uploads_issued = 0;
+
+    static void copy_to_device(void* dst, const void* src, size_t n) {
+        copies++;
+        bytes += n;
+        host_backend::copy_to_device(dst, src, n);
+    }
+    static void copy_to_host(void* dst, const void* src, size_t n) {
+        copies++;
+        bytes += n;
+        host_backend::copy_to_host(dst, src, n);
+    }
+    static event copy_to_device_async(void* dst, const void* src, size_t n) {
+        copies++;
+        bytes += n;
+        uploads_issued++;
+        return host_backend::copy_to_device_async(dst, src, n);
+    }
+    static event copy_to_host_async(void* dst, const void* src, size_t n) {
+        copies++;
+        bytes += n;
+        return host_backend::copy_to_host_async(dst, src, n);
+    }
+    static void reset() {
+        copies = 0;
+        bytes = 0;
+        uploads_issued = 0;
+    }
+};
+
+// Pinned allocations always fail, and device buffers are counted
+struct failing_pinned_backend : fun::host_backend {
+    static inline size_t device_live = 0;
+
+    static void* device_alloc(size_t n) {
+        void* p = host_backend::device_alloc(n);
+        device_live++;
+        return p;
+    }
+    static void device_free(void* p) noexcept {
+        device_live--;
+        host_backend::device_free(p);
+    }
+    static void* pinned_alloc(size_t) { throw std::bad_alloc(); }
+};
+
+template <typename T>
+using counted_array = fun::gpu_array<T, false, counting_backend>;
+
+template <typename Array> static void double_on_device(Array& arr) {
+    auto* device = arr.device_ptr();
+    for (size_t i = 0; i < arr.size(); i++) {
+        device[i] *= 2;
+    }
+}
+
+TEST(GpuArrayHostPageable, Ctor) {
+    host_array<float> arr(10);
+    EXPECT_EQ(arr.size(), 10);
+    EXPECT_EQ(arr.capacity(), 10);
+}
+
+TEST(GpuArrayHostPageable, FromPointer) {
+    const int src[] = {1, 2, 3, 4};
+    host_array<int> arr(src, 4);
+    EXPECT_EQ(arr[3], 4);
+}
+
+TEST(GpuArrayHostPageable, BoundsCheck) {
+    host_array<int> arr(5);
+    EXPECT_NO_THROW(arr.at(4));
+    EXPECT_THROW(arr.at(5), std::out_of_range);
+}
+
+TEST(GpuArrayHostPageable, DeviceMemoryIsSeparate) {
+    host_array<int> arr(8);
+    for (size_t i = 0; i < arr.size(); i++) {
+        arr[i] = 1;
+    }
+    arr.to_device();
+
+    // Host writes without a to_device() never reach the device copy
+    arr[0] = 100;
+    const auto& view = arr;
+    EXPECT_NE(static_cast<const void*>(view.device_ptr()),
+              static_cast<const void*>(&view[0]));
+    EXPECT_EQ(view.device_ptr()[0], 1);
+
+    arr.to_device();
+    EXPECT_EQ(view.device_ptr()[0], 100);
+}
+
+TEST(GpuArrayHostPageable, DeviceIsAligned) {
+    host_array<char> arr(3);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(arr.device_ptr()) % 256, 0);
+}
+
+TEST(GpuArrayHostPageable, TransferRoundTrip) {
+    host_array<float> arr(100);
+    for (size_t i = 0; i < arr.size(); i++) {
+        arr[i] = static_cast<float>(i) * 1.5f;
+    }
+
+    arr.to_device();
+    arr.to_host();
+
+    for (size_t i = 0; i < arr.size(); i++) {
+        EXPECT_FLOAT_EQ(arr[i], static_cast<float>(i) * 1.5f);
+    }
+}
+
+TEST(GpuArrayHostPageable, KernelExecution) {
+    host_array<float> arr(1024);
+    for (size_t i = 0; i < arr.size(); i++) {
+        arr[i] = static_cast<float>(i);
+    }
+
+    arr.to_device();
+    double_on_device(arr);
+    arr.to_host();
+
+    for (size_t i = 0; i < arr.size(); i++) {
+        ASSERT_FLOAT_EQ(arr[i], static_cast<float>(i) * 2.0f);
+    }
+}
+
+TEST(GpuArrayHostPinned, TransferRoundTrip) {
+    host_array<float, true> arr(100);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(&arr[0]) % 4096, 0);
+    for (size_t i = 0; i < arr.size(); i++) {
+        arr[i] = static_cast<float>(i) * 2.5f;
+    }
+
+    arr.to_device();
+    double_on_device(arr);
+    arr.to_host();
+
+    for (size_t i = 0; i < arr.size(); i++) {
+        EXPECT_FLOAT_EQ(arr[i], static_cast<float>(i) * 5.0f);
+    }
+}
+
+TEST(GpuArrayHostTests, MoveSemantics) {
+    host_array<int> arr(10);
+    for (size_t i = 0; i < arr.size(); i++) {
+        arr[i] = static_cast<int>(i * 10);
+    }
+    arr.to_device();
+
+    host_array<int> arr2(std::move(arr));
+    EXPECT_EQ(arr.size(), 0);
+    EXPECT_EQ(std::as_const(arr).device_ptr(), nullptr);
+    EXPECT_EQ(arr2.size(), 10);
+    EXPECT_EQ(std::as_const(arr2).device_ptr()[9], 90);
+
+    host_array<int> arr3(2);
+    arr3 = std::move(arr2);
+    EXPECT_EQ(arr3.size(), 10);
+    EXPECT_EQ(arr3[5], 50);
+}
+
+TEST(GpuArrayHostTests, BatchedTransfers) {
+    host_array<int> a(4);
+    host_array<float, true> b(4);
+    for (size_t i = 0; i < 4; i++) {
+        a[i] = static_cast<int>(i);
+        b[i] = static_cast<float>(i);
+    }
+
+    fun::to_device_all(a, b);
+    double_on_device(a);
+    double_on_device(b);
+    fun::to_host_all(a, b);
+
+    EXPECT_EQ(a[3], 6);
+    EXPECT_FLOAT_EQ(b[3], 6.0f);
+}
+
+TEST(GpuArrayHostTests, FailedHostAllocFreesDevice) {
+    using array = fun::gpu_array<int, true, failing_pinned_backend>;
+    EXPECT_THROW(array arr(100), std::bad_alloc);
+    EXPECT_EQ(failing_pinned_backend::device_live, 0);
+}
+
+TEST(GpuArrayHostTests, DefaultBackendWithoutCuda) {
+#ifndef FUN_WITH_CUDA
+    static_assert(std::is_same_v<fun::gpu_array<int>::backend_type,
+                                 fun::host_backend>);
+#endif
+    SUCCEED();
+}
+
+TEST(GpuArrayDirtyTests, CleanSyncIsFree) {
+    counted_array<int> arr(4096);
+    counting_backend::reset();
+
+    // Nothing was written on either side
+    arr.to_device();
+    arr.to_host();
+    EXPECT_EQ(counting_backend::copies, 0);
+
+    arr[7] = 1;
+    arr.to_device();
+    arr.to_device();
+    EXPECT_EQ(counting_backend::copies, 1);
+}
+
+TEST(GpuArrayDirtyTests, SparseUpdateSendsTouchedBlocks) {
+    using array = counted_array<float>;
+    array arr(array::block_size * 64);
+    counting_backend::reset();
+
+    arr[3] = 1.0f;
+    arr[array::block_size * 10] = 2.0f;
+    arr[array::block_size * 40 + 5] = 3.0f;
+    arr.to_device();
+
+    EXPECT_EQ(counting_backend::copies, 3);
+    EXPECT_EQ(counting_backend::bytes, 3 * array::block_bytes);
+    EXPECT_EQ(std::as_const(arr).device_ptr()[array::block_size * 40 + 5],
+              3.0f);
+    EXPECT_EQ(arr.state(3), fun::sync_state::synced);
+}
+
+TEST(GpuArrayDirtyTests, AdjacentBlocksCoalesce) {
+    using array = counted_array<int>;
+    array arr(array::block_size * 8 + 3);
+    counting_backend::reset();
+
+    // Blocks 1..3 and the ragged last one
+    arr.host_ptr(array::block_size, array::block_size * 3)[0] = 1;
+    arr[arr.size() - 1] = 2;
+    arr.to_device();
+
+    EXPECT_EQ(counting_backend::copies, 2);
+    EXPECT_EQ(counting_backend::bytes,
+              3 * array::block_bytes + 3 * sizeof(int));
+}
+
+TEST(GpuArrayDirtyTests, RangeTransfers) {
+    using array = counted_array<int>;
+    array arr(array::block_size * 4);
+    arr[0] = 1;
+    arr[array::block_size * 3] = 2;
+    counting_backend::reset();
+
+    // Only the part asked for goes, rounded out to its block
+    arr.to_device(array::block_size * 3 + 1, 1);
+    EXPECT_EQ(counting_backend::bytes, array::block_bytes);
+    EXPECT_EQ(arr.state(0), fun::sync_state::host_newer);
+    EXPECT_EQ(arr.state(array::block_size * 3), fun::sync_state::synced);
+
+    arr.to_device();
+    int* out = arr.device_ptr(array::block_size, 2);
+    out[1] = 42;
+    counting_backend::reset();
+    arr.to_host(0, arr.size());
+    EXPECT_EQ(counting_backend::bytes, array::block_bytes);
+    EXPECT_EQ(arr[array::block_size + 1], 42);
+}
+
+TEST(GpuArrayDirtyTests, RangeChecks) {
+    counted_array<int> arr(10);
+    EXPECT_NO_THROW(arr.to_device(10, 0));
+    EXPECT_THROW(arr.to_device(5, 6), std::out_of_range);
+    EXPECT_THROW(arr.to_host(11, 0), std::out_of_range);
+    EXPECT_THROW(arr.device_ptr(0, 11), std::out_of_range);
+    EXPECT_THROW(arr.host_ptr(static_cast<size_t>(-1), 2), std::out_of_range);
+}
+
+TEST(GpuArrayDirtyTests, FromPointerIsHostNewer) {
+    const std::vector<int> src(5000, 7);
+    counted_array<int> arr(src.data(), src.size());
+    counting_backend::reset();
+
+    arr.to_device();
+    EXPECT_EQ(counting_backend::bytes, src.size() * sizeof(int));
+}
+
+TEST(GpuArrayDirtyTests, CachedDevicePointer) {
+    counted_array<int> arr(16);
+    int* cached = arr.device_ptr();
+    arr.to_host();
+
+    // A later "launch" through the old pointer is invisible to tracking...
+    cached[2] = 9;
+    arr.to_host();
+    EXPECT_NE(arr[2], 9);
+    arr.to_device();
+
+    // ...until it's told
+    cached[2] = 9;
+    arr.mark_device_dirty(2, 1);
+    arr.to_host();
+    EXPECT_EQ(arr[2], 9);
+}
+
+TEST(GpuArrayAsyncTests, RoundTrip) {
+    host_array<int> arr(5000);
+    for (size_t i = 0; i < arr.size(); i++) {
+        arr[i] = static_cast<int>(i);
+    }
+
+    auto up = arr.to_device_async();
+    up.wait();
+    EXPECT_TRUE(up.ready());
+    EXPECT_EQ(std::as_const(arr).device_ptr()[4999], 4999);
+
+    double_on_device(arr);
+    arr.to_host_async().wait();
+    EXPECT_EQ(arr[4999], 2 * 4999);
+}
+
+TEST(GpuArrayAsyncTests, HandleWaitsWhenDestroyed) {
+    host_array<float> arr(1 << 16);
+    float* host = arr.host_ptr(0, arr.size());
+    std::fill(host, host + arr.size(), 3.0f);
+    {
+        auto up = arr.to_device_async();
+        auto moved = std::move(up);
+    }
+    EXPECT_EQ(std::as_const(arr).device_ptr()[(1 << 16) - 1], 3.0f);
+}
+
+TEST(GpuArrayAsyncTests, BlocksInFlightUntilWaited) {
+    using array = host_array<int>;
+    array arr(array::block_size * 3);
+    arr[0] = 1;
+    arr[array::block_size * 2] = 2;
+
+    auto up = arr.to_device_async();
+    EXPECT_EQ(arr.state(0), fun::sync_state::in_flight);
+    EXPECT_EQ(arr.state(array::block_size * 2), fun::sync_state::in_flight);
+    // Blocks the transfer didn't pick up are fair game in the meantime
+    EXPECT_EQ(arr.state(array::block_size), fun::sync_state::synced);
+    arr[array::block_size] = 3;
+
+    // Still in flight even once the copy is done, until it's waited on
+    while (!up.ready()) {
+    }
+    EXPECT_EQ(arr.state(0), fun::sync_state::in_flight);
+    up.wait();
+    EXPECT_EQ(arr.state(0), fun::sync_state::synced);
+    EXPECT_EQ(arr.state(array::block_size * 2), fun::sync_state::synced);
+    EXPECT_EQ(arr.state(array::block_size), fun::sync_state::host_newer);
+
+    arr.to_device();
+    EXPECT_EQ(std::as_const(arr).device_ptr()[array::block_size], 3);
+}
+
+TEST(GpuArrayAsyncTests, TransferOutlivesMovedArray) {
+    host_array<int> arr(8);
+    arr[0] = 1;
+    auto down = arr.to_device_async();
+    host_array<int> moved(std::move(arr));
+    EXPECT_EQ(moved.state(0), fun::sync_state::in_flight);
+    down.wait();
+    EXPECT_EQ(moved.state(0), fun::sync_state::synced);
+    EXPECT_EQ(std::as_const(moved).device_ptr()[0], 1);
+}
+
+TEST(GpuArrayAsyncTests, NothingDirtyIsReady) {
+    counted_array<int> arr(10);
+    counting_backend::reset();
+    auto down = arr.to_host_async();
+    EXPECT_TRUE(down.ready());
+    EXPECT_EQ(counting_backend::copies, 0);
+}
+
+TEST(GpuArrayAsyncTests, BatchedIssuesBeforeWaiting) {
+    counted_array<int> a(3);
+    counted_array<int> b(5);
+    a[0] = 1;
+    b[4] = 2;
+    counting_backend::reset();
+
+    fun::to_device_all(a, b);
+    EXPECT_EQ(counting_backend::uploads_issued, 2);
+    EXPECT_EQ(std::as_const(b).device_ptr()[4], 2);
+}
+
+template <typename Array> static void check_stream(Array& arr, size_t chunk) {
+    for (size_t i = 0; i < arr.size(); i++) {
+        arr[i] = static_cast<float>(i);
+    }
+
+    size_t next = 0;
+    arr.stream_to_device(chunk, [&](float* device, size_t first, size_t count) {
+        // In order, back to back, and already on the device
+        EXPECT_EQ(first, next);
+        next = first + count;
+        for (size_t i = 0; i < count; i++) {
+            ASSERT_EQ(device[i], static_cast<float>(first + i));
+            device[i] *= 2;
+        }
+    });
+    EXPECT_EQ(next, arr.size());
+
+    arr.to_host();
+    for (size_t i = 0; i < arr.size(); i++) {
+        ASSERT_EQ(arr[i], static_cast<float>(i) * 2);
+    }
+}
+
+TEST(GpuArrayStreamTests, PageableThroughStaging) {
+    using array = host_array<float>;
+    array arr(array::block_size * 10 + 7);
+    check_stream(arr, array::block_size * 3);
+}
+
+TEST(GpuArrayStreamTests, PinnedDirect) {
+    using array = host_array<float, true>;
+    array arr(array::block_size * 10 + 7);
+    check_stream(arr, 1);
+}
+
+TEST(GpuArrayStreamTests, NextChunkInFlightDuringKernel) {
+    using array = counted_array<int>;
+    array arr(array::block_size * 4);
+    counting_backend::reset();
+
+    std::vector<size_t> issued_at_kernel;
+    arr.stream_to_device(array::block_size, [&](int*, size_t, size_t) {
+        issued_at_kernel.push_back(counting_backend::uploads_issued);
+    });
+
+    // Chunk c + 1 is always issued before chunk c is processed
+    EXPECT_EQ(issued_at_kernel, (std::vector<size_t>{2, 3, 4, 4}));
+    EXPECT_EQ(arr.state(0), fun::sync_state::device_newer);
+    EXPECT_THROW(arr.stream_to_device(0, [](int*, size_t, size_t) {}),
+                 std::invalid_argument);
+}
+
+#ifndef NDEBUG
+TEST(GpuArrayDirtyDeathTests, StaleHostReadAsserts) {
+    GTEST_FLAG_SET(death_test_style, "threadsafe");
+    host_array<int> arr(8);
+    arr.to_device();
+    double_on_device(arr);
+
+    const auto& view = arr;
+    EXPECT_DEATH((void)view[0], "stale");
+    EXPECT_DEATH(arr[0] = 1, "stale");
+}
+
+TEST(GpuArrayDirtyDeathTests, InFlightBlockAsserts) {
+    GTEST_FLAG_SET(death_test_style, "threadsafe");
+    host_array<int> arr(8);
+    arr[0] = 1;
+
+    auto up = arr.to_device_async();
+    EXPECT_DEATH(arr[0] = 2, "in flight");
+    EXPECT_DEATH((void)std::as_const(arr)[0], "in flight");
+    EXPECT_DEATH((void)arr.device_ptr(), "without a sync");
+    up.wait();
+    arr[0] = 2;
+    EXPECT_EQ(arr.state(0), fun::sync_state::host_newer);
+}
+#endif
@@ -1,8 +1,18 @@
-#include "fun_macros.h"
+#pragma once
+#include "host_backend.hpp"
+#include <algorithm>
+#include <cassert>
 #include <cstddef>
-#include <cuda_runtime.h>
+#include <cstring>
+#include <memory>
 #include <stdexcept>
+#include <tuple>
 #include <type_traits>
+#include <utility>
+#include <vector>
+#ifdef FUN_WITH_CUDA
+#include "cuda_backend.hpp"
+#endif
 
 /*
     A fixed-size GPU buffer that manages both host and device memory.
@@ -14,90 +24,341 @@
 
     Also, this (can) support pinned host memory for faster DMA transfer:
     https://developer.nvidia.com/blog/how-optimize-data-transfers-cuda-cc/
+
+    Every allocation and copy goes through the Backend policy, a type with
+
+    static void* device_alloc(size_t bytes);
+    static void device_free(void* p) noexcept;
+    static void* pinned_alloc(size_t bytes);
+    static void pinned_free(void* p) noexcept;
+    static void copy_to_device(void* dst, const void* src, size_t bytes);
+    static void copy_to_host(void* dst, const void* src, size_t bytes);
+
+    using event = ...; // movable completion handle for one async copy
+    static event copy_to_device_async(void* dst, const void* src, size_t);
+    static event copy_to_host_async(void* dst, const void* src, size_t);
+    static void wait(event& e);
+    static bool ready(const event& e);
+
+    cuda_backend is the default when the build has CUDA, host_backend (see
+    host_backend.hpp) otherwise, so the same code runs on CPU-only machines.
+
+    Sync is tracked per block of block_bytes. Non-const host access marks its
+    block host-newer, handing out a mutable device pointer marks its range
+    device-newer (a kernel may write it), and to_device()/to_host() only copy
+    the blocks that are actually newer on the other side, coalesced into as
+    few copies as possible. Range overloads round out to whole blocks.
+
+    The catch is that tracking only sees what goes through this class. Write
+    in bulk through host_ptr(first, count) rather than &arr[0], grab
+    device_ptr() right before each launch instead of caching it, or call
+    mark_device_dirty() yourself. In debug builds touching a block on the
+    host while the device has newer data asserts.
+
+    Async transfers leave their blocks in_flight until the gpu_transfer is
+    waited on (or destroyed). Touching an in_flight block from either side
+    asserts too, the copy may still be reading or writing it.
 */
 namespace fun {
+#ifdef FUN_WITH_CUDA
+using default_gpu_backend = cuda_backend;
+#else
+using default_gpu_backend = host_backend;
+#endif
+
+// Which side of a block has the latest data, in_flight while an async copy
+// of it hasn't been waited on yet
+enum class sync_state : unsigned char {
+    synced,
+    host_newer,
+    device_newer,
+    in_flight
+};
+
+template <typename T, bool DoPinnedTransfer, typename Backend>
+class gpu_array;
+
+/*
+    The copies behind one async transfer, waits for them on destruction.
+    Waiting is also what flips the array's in_flight blocks back to synced,
+    the block states are shared so that still works after the array moved.
+*/
+template <typename Backend> class gpu_transfer {
+public:
+    gpu_transfer() = default;
+    ~gpu_transfer() { wait(); }
+
+    gpu_transfer(const gpu_transfer&) = delete;
+    gpu_transfer& operator=(const gpu_transfer&) = delete;
+    gpu_transfer(gpu_transfer&& other) noexcept
+        : events_ { std::move(other.events_) },
+          blocks_ { std::move(other.blocks_) },
+          runs_ { std::move(other.runs_) } {
+        other.events_.clear();
+        other.runs_.clear();
+    }
+    gpu_transfer& operator=(gpu_transfer&& other) noexcept {
+        if (this != &other) {
+            wait();
+            events_ = std::move(other.events_);
+            blocks_ = std::move(other.blocks_);
+            runs_ = std::move(other.runs_);
+            other.events_.clear();
+            other.runs_.clear();
+        }
+
+        return *this;
+    }
+
+    void add(typename Backend::event e) { events_.push_back(std::move(e)); }
+
+    void wait() {
+        for (auto& e : events_) {
+            Backend::wait(e);
+        }
+        events_.clear();
+
+        for (const auto& [first, last] : runs_) {
+            for (size_t b = first; b < last; b++) {
+                blocks_[b] = sync_state::synced;
+            }
+        }
+        runs_.clear();
+        blocks_.reset();
+    }
+    bool ready() const {
+        for (const auto& e : events_) {
+            if (!Backend::ready(e)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+private:
+    template <typename, bool, typename> friend class gpu_array;
+
+    std::vector<typename Backend::event> events_;
+    // Blocks [first, last) of blocks_ this transfer has in flight
+    std::shared_ptr<sync_state[]> blocks_;
+    std::vector<std::pair<size_t, size_t>> runs_;
+
+    void track(std::shared_ptr<sync_state[]> blocks, size_t first,
+               size_t last) {
+        blocks_ = std::move(blocks);
+        runs_.emplace_back(first, last);
+    }
+};
+
 // TODO(A): should we use pinnedmemory true by default?
 // TODO(A): should i make replusplus choose the next multiple of 2 i.e. 2^(ceil(log2(n)))
-template <typename T, bool DoPinnedTransfer = false> class gpu_array {
+template <typename T, bool DoPinnedTransfer = false,
+          typename Backend = default_gpu_backend>
+class gpu_array {
 public:
+    using backend_type = Backend;
+
+    static constexpr size_t block_bytes = 4096;
+    static constexpr size_t block_size =
+        sizeof(T) < block_bytes ? block_bytes / sizeof(T) : 1;
+
     gpu_array(size_t capacity)
-        : capacity_ { capacity }, host_data_ {}, device_data_ {} {
+        : capacity_ { capacity }, host_data_ {}, device_data_ {},
+          num_blocks_ { (capacity + block_size - 1) / block_size },
+          blocks_ { new sync_state[num_blocks_] },
+          host_newer_ { 0 }, device_newer_ { 0 } {
         static_assert(std::is_trivially_copyable_v<T>,
                       "gpu_array only supports copying trivial types!");
-        cudaTry(cudaMalloc(&device_data_, capacity_ * sizeof(T)));
+        device_data_ =
+            static_cast<T*>(Backend::device_alloc(capacity_ * sizeof(T)));
 
-        if constexpr (DoPinnedTransfer) {
-            cudaTry(cudaMallocHost(&host_data_, capacity_ * sizeof(T)));
+        // The destructor won't run if this throws, give the device back
+        try {
+            if constexpr (DoPinnedTransfer) {
+                host_data_ = static_cast<T*>(
+                    Backend::pinned_alloc(capacity_ * sizeof(T)));
+            }
+            else {
+                host_data_ = raw_alloc_arr(capacity_);
+            }
         }
-        else {
-            host_data_ = raw_alloc_arr(capacity_);
+        catch (...) {
+            Backend::device_free(device_data_);
+            throw;
         }
-    }
-    gpu_array(const T* src, size_t n) : gpu_array(n) {
-        memcpy(host_data_, src, n * sizeof(T));
-    }
-    ~gpu_array() {
-        cudaFree(device_data_);
 
-        if constexpr (DoPinnedTransfer) {
-            cudaFreeHost(host_data_);
-        }
-        else {
-            delete_arr(host_data_);
+        // Both sides start out as equally meaningless garbage, so an output
+        // only array can go straight to a kernel
+        for (size_t b = 0; b < num_blocks_; b++) {
+            blocks_[b] = sync_state::synced;
         }
     }
+    gpu_array(const T* src, size_t n) : gpu_array(n) {
+        std::memcpy(host_ptr(0, n), src, n * sizeof(T));
+    }
+    ~gpu_array() { free_buffers(); }
 
     gpu_array(const gpu_array&) = delete;
     gpu_array& operator=(const gpu_array&) = delete;
     gpu_array(gpu_array&& other) noexcept
         : capacity_ { other.capacity_ }, host_data_ { other.host_data_ },
-          device_data_ { other.device_data_ } {
+          device_data_ { other.device_data_ },
+          num_blocks_ { other.num_blocks_ },
+          blocks_ { std::move(other.blocks_) },
+          host_newer_ { other.host_newer_ },
+          device_newer_ { other.device_newer_ } {
 
         other.capacity_ = 0;
         other.host_data_ = nullptr;
         other.device_data_ = nullptr;
+        other.num_blocks_ = 0;
+        other.host_newer_ = 0;
+        other.device_newer_ = 0;
     }
     gpu_array& operator=(gpu_array&& other) noexcept {
         if (this != &other) {
-            cudaTry(cudaFree(device_data_));
-            if constexpr (DoPinnedTransfer) {
-                cudaTry(cudaFreeHost(host_data_));
-            }
-            else {
-                delete_arr(host_data_);
-            }
+            free_buffers();
 
             capacity_ = other.capacity_;
             host_data_ = other.host_data_;
             device_data_ = other.device_data_;
+            num_blocks_ = other.num_blocks_;
+            blocks_ = std::move(other.blocks_);
+            host_newer_ = other.host_newer_;
+            device_newer_ = other.device_newer_;
 
             other.capacity_ = 0;
             other.host_data_ = nullptr;
             other.device_data_ = nullptr;
+            other.num_blocks_ = 0;
+            other.host_newer_ = 0;
+            other.device_newer_ = 0;
         }
 
         return *this;
     }
 
+    // Sends only the host-newer blocks, a no-op when nothing changed
     void to_device() {
-        cudaTry(cudaMemcpy(device_data_, host_data_, capacity_ * sizeof(T),
-                           cudaMemcpyHostToDevice));
+        if (host_newer_ != 0) {
+            sync_blocks(0, num_blocks_, sync_state::host_newer);
+        }
     }
     void to_host() {
-        cudaTry(cudaMemcpy(host_data_, device_data_, capacity_ * sizeof(T),
-                           cudaMemcpyDeviceToHost));
+        if (device_newer_ != 0) {
+            sync_blocks(0, num_blocks_, sync_state::device_newer);
+        }
+    }
+    void to_device(size_t first, size_t count) {
+        check_range(first, count);
+        if (host_newer_ != 0 && count != 0) {
+            sync_blocks(first / block_size, last_block(first, count) + 1,
+                        sync_state::host_newer);
+        }
+    }
+    void to_host(size_t first, size_t count) {
+        check_range(first, count);
+        if (device_newer_ != 0 && count != 0) {
+            sync_blocks(first / block_size, last_block(first, count) + 1,
+                        sync_state::device_newer);
+        }
+    }
+
+    // Issued now, copied whenever the copy engine gets to it
+    gpu_transfer<Backend> to_device_async() {
+        gpu_transfer<Backend> pending;
+        if (host_newer_ != 0) {
+            sync_blocks(0, num_blocks_, sync_state::host_newer, &pending);
+        }
+
+        return pending;
+    }
+    gpu_transfer<Backend> to_host_async() {
+        gpu_transfer<Backend> pending;
+        if (device_newer_ != 0) {
+            sync_blocks(0, num_blocks_, sync_state::device_newer, &pending);
+        }
+
+        return pending;
+    }
+
+    /*
+        Uploads the whole array in chunks of (at least) chunk_elems, rounded
+        up to whole blocks, calling kernel(T* device_chunk, first, count) as
+        each one lands while the next is already on its way. Pageable arrays
+        go through two pinned staging chunks, pinned ones copy directly.
+
+        The kernel gets a mutable pointer, so chunks end up device-newer.
+    */
+    template <typename Kernel>
+    void stream_to_device(size_t chunk_elems, Kernel&& kernel) {
+        if (chunk_elems == 0) {
+            throw std::invalid_argument("stream_to_device needs chunk > 0!");
+        }
+
+        const size_t chunk =
+            (chunk_elems + block_size - 1) / block_size * block_size;
+        const size_t num_chunks = (capacity_ + chunk - 1) / chunk;
+        if (num_chunks == 0) {
+            return;
+        }
+
+        // Declared first so it outlives the copies still reading from it
+        staging_buffer staging(DoPinnedTransfer ? 0 : 2 * chunk);
+        gpu_transfer<Backend> pending[2];
+
+        auto upload = [&](size_t c) {
+            const size_t first = c * chunk;
+            const size_t count = std::min(chunk, capacity_ - first);
+            const T* src = host_data_ + first;
+            if constexpr (!DoPinnedTransfer) {
+                T* stage = staging.data + (c % 2) * chunk;
+                std::memcpy(stage, src, count * sizeof(T));
+                src = stage;
+            }
+
+            pending[c % 2].add(Backend::copy_to_device_async(
+                device_data_ + first, src, count * sizeof(T)));
+        };
+
+        upload(0);
+        for (size_t c = 0; c < num_chunks; c++) {
+            // Chunk c - 1 was waited on last time round, its slot is free
+            if (c + 1 < num_chunks) {
+                upload(c + 1);
+            }
+            pending[c % 2].wait();
+
+            const size_t first = c * chunk;
+            const size_t count = std::min(chunk, capacity_ - first);
+            for (size_t b = first / block_size; b <= last_block(first, count);
+                 b++) {
+                set_block(b, sync_state::device_newer);
+            }
+            kernel(device_data_ + first, first, count);
+        }
     }
 
     size_t size() const { return capacity_; }
     size_t capacity() const { return capacity_; }
 
-    T& operator[](size_t idx) { return host_data_[idx]; }
-    const T& operator[](size_t idx) const { return host_data_[idx]; }
+    T& operator[](size_t idx) {
+        touch_host(idx);
+        return host_data_[idx];
+    }
+    const T& operator[](size_t idx) const {
+        assert(!in_flight(idx) && "host read of a block in flight, wait()");
+        assert(!stale_on_host(idx) &&
+               "host read of stale data, to_host() first");
+        return host_data_[idx];
+    }
     T& at(size_t idx) {
         if (idx >= capacity_) {
             throw std::out_of_range(".at(...) access out of range!");
         }
 
+        touch_host(idx);
         return host_data_[idx];
     }
     const T& at(size_t idx) const {
@@ -105,31 +366,202 @@ public:
             throw std::out_of_range(".at(...) access out of range!");
         }
 
+        assert(!in_flight(idx) && "host read of a block in flight, wait()");
+        assert(!stale_on_host(idx) &&
+               "host read of stale data, to_host() first");
         return host_data_[idx];
     }
-    T* device_ptr() const { return device_data_; }
+
+    // Bulk host writes (memcpy, fill) without paying per element tracking
+    T* host_ptr(size_t first, size_t count) {
+        check_range(first, count);
+        mark(first, count, sync_state::host_newer);
+        return host_data_ + first;
+    }
+
+    // Mutable device pointers assume the kernel writes everything they cover
+    T* device_ptr() {
+        mark(0, capacity_, sync_state::device_newer);
+        return device_data_;
+    }
+    T* device_ptr(size_t first, size_t count) {
+        check_range(first, count);
+        mark(first, count, sync_state::device_newer);
+        return device_data_ + first;
+    }
+    // Read-only kernel inputs
+    const T* device_ptr() const { return device_data_; }
+
+    // For kernels that write through a pointer grabbed earlier
+    void mark_device_dirty(size_t first, size_t count) {
+        check_range(first, count);
+        mark(first, count, sync_state::device_newer);
+    }
+
+    sync_state state(size_t idx) const { return blocks_[idx / block_size]; }
 
 private:
-    // TODO(A): We could add a compile-time debug tracker for last
-    // update location to avoid sync issues
     size_t capacity_;
     T* host_data_;
     T* device_data_;
 
+    size_t num_blocks_;
+    // Shared with the gpu_transfers that have some of them in flight
+    std::shared_ptr<sync_state[]> blocks_;
+    // How many blocks are in each dirty state, so a clean sync is free
+    size_t host_newer_;
+    size_t device_newer_;
+
     static T* raw_alloc_arr(size_t desired_capacity) {
         T* arr =
             static_cast<T*>(::operator new[](desired_capacity * sizeof(T)));
         return arr;
     }
     static void delete_arr(T* arr) { ::operator delete[](arr); }
+
+    struct staging_buffer {
+        T* data;
+
+        explicit staging_buffer(size_t n)
+            : data { n == 0 ? nullptr
+                            : static_cast<T*>(
+                                  Backend::pinned_alloc(n * sizeof(T))) } {}
+        ~staging_buffer() {
+            if (data != nullptr) {
+                Backend::pinned_free(data);
+            }
+        }
+        staging_buffer(const staging_buffer&) = delete;
+        staging_buffer& operator=(const staging_buffer&) = delete;
+    };
+
+    void free_buffers() noexcept {
+        if (device_data_ != nullptr) {
+            Backend::device_free(device_data_);
+        }
+
+        if constexpr (DoPinnedTransfer) {
+            if (host_data_ != nullptr) {
+                Backend::pinned_free(host_data_);
+            }
+        }
+        else {
+            delete_arr(host_data_);
+        }
+    }
+
+    void check_range(size_t first, size_t count) const {
+        if (first > capacity_ || count > capacity_ - first) {
+            throw std::out_of_range("gpu_array range out of bounds!");
+        }
+    }
+    static size_t last_block(size_t first, size_t count) {
+        return (first + count - 1) / block_size;
+    }
+
+    bool in_flight(size_t idx) const {
+        return blocks_[idx / block_size] == sync_state::in_flight;
+    }
+
+    bool stale_on_host(size_t idx) const {
+        return blocks_[idx / block_size] == sync_state::device_newer;
+    }
+
+    void touch_host(size_t idx) {
+        const size_t b = idx / block_size;
+        if (blocks_[b] != sync_state::host_newer) {
+            assert(blocks_[b] != sync_state::in_flight &&
+                   "host access to a block in flight, wait() first");
+            assert(blocks_[b] != sync_state::device_newer &&
+                   "host access to stale data, to_host() first");
+            set_block(b, sync_state::host_newer);
+        }
+    }
+
+    void mark(size_t first, size_t count, sync_state to) {
+        if (count == 0) {
+            return;
+        }
+
+        const size_t last = last_block(first, count);
+        for (size_t b = first / block_size; b <= last; b++) {
+            assert((blocks_[b] == to || blocks_[b] == sync_state::synced) &&
+                   "block written on both host and device without a sync");
+            set_block(b, to);
+        }
+    }
+
+    void set_block(size_t b, sync_state to) {
+        host_newer_ -= blocks_[b] == sync_state::host_newer;
+        device_newer_ -= blocks_[b] == sync_state::device_newer;
+        host_newer_ += to == sync_state::host_newer;
+        device_newer_ += to == sync_state::device_newer;
+        blocks_[b] = to;
+    }
+
+    /*
+        Copies each run of `newer` blocks in [first, last) as one transfer.
+        With `pending` the copies are only issued, the blocks stay in_flight
+        until pending is waited on.
+    */
+    void sync_blocks(size_t first, size_t last, sync_state newer,
+                     gpu_transfer<Backend>* pending = nullptr) {
+        size_t b = first;
+        while (b < last) {
+            if (blocks_[b] != newer) {
+                b++;
+                continue;
+            }
+
+            const size_t run = b;
+            while (b < last && blocks_[b] == newer) {
+                b++;
+            }
+
+            const size_t begin = run * block_size;
+            const size_t end = b * block_size < capacity_ ? b * block_size
+                                                          : capacity_;
+            const size_t bytes = (end - begin) * sizeof(T);
+            if (pending != nullptr) {
+                pending->add(newer == sync_state::host_newer
+                                 ? Backend::copy_to_device_async(
+                                       device_data_ + begin,
+                                       host_data_ + begin, bytes)
+                                 : Backend::copy_to_host_async(
+                                       host_data_ + begin,
+                                       device_data_ + begin, bytes));
+            }
+            else if (newer == sync_state::host_newer) {
+                Backend::copy_to_device(device_data_ + begin,
+                                        host_data_ + begin, bytes);
+            }
+            else {
+                Backend::copy_to_host(host_data_ + begin,
+                                      device_data_ + begin, bytes);
+            }
+
+            const sync_state to =
+                pending != nullptr ? sync_state::in_flight : sync_state::synced;
+            for (size_t done = run; done < b; done++) {
+                set_block(done, to);
+            }
+            if (pending != nullptr) {
+                pending->track(blocks_, run, b);
+            }
+        }
+    }
 };
 
+// Everything is issued before anything is waited on, so the copies queue
+// back to back instead of round tripping through the host one at a time
 template <typename... Arrays> void to_device_all(Arrays&... arrays) {
-    (arrays.to_device(), ...);
+    auto pending = std::make_tuple(arrays.to_device_async()...);
+    std::apply([](auto&... transfers) { (transfers.wait(), ...); }, pending);
 }
 
 template <typename... Arrays> void to_host_all(Arrays&... arrays) {
-    (arrays.to_host(), ...);
+    auto pending = std::make_tuple(arrays.to_host_async()...);
+    std::apply([](auto&... transfers) { (transfers.wait(), ...); }, pending);
 }
 
 }; // namespace fun
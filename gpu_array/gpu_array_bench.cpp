@@ -0,0 +1,107 @@
+#include "gpu_array.hpp"
+#include <benchmark/benchmark.h>
+#include <random>
+
+/*
+    Round trip throughput of whole-array transfers through the default
+    backend (host_backend without CUDA, so this measures the staging logic
+    and the copy thread, not PCIe). Wall time, the copies run on another
+    thread.
+*/
+template <bool Pinned> static void BM_RoundTrip(benchmark::State& state) {
+    fun::gpu_array<float, Pinned> arr(state.range(0));
+    for (size_t i = 0; i < arr.size(); i++) {
+        arr[i] = static_cast<float>(i);
+    }
+
+    for (auto _ : state) {
+        // Dirty both sides so every sync really copies everything
+        benchmark::DoNotOptimize(arr.host_ptr(0, arr.size()));
+        arr.to_device();
+        benchmark::DoNotOptimize(arr.device_ptr());
+        arr.to_host();
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * 2 * arr.size() *
+                            sizeof(float));
+}
+
+BENCHMARK_TEMPLATE(BM_RoundTrip, false)->Range(1 << 10, 1 << 24)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_RoundTrip, true)->Range(1 << 10, 1 << 24)->UseRealTime();
+
+struct counting_backend : fun::host_backend {
+    static inline size_t bytes = 0;
+
+    static void copy_to_device(void* dst, const void* src, size_t n) {
+        bytes += n;
+        host_backend::copy_to_device(dst, src, n);
+    }
+};
+
+/*
+    Sparse updates: touch range(0) random elements of a 64 MiB array, then
+    sync. Before dirty tracking every to_device() moved the whole 64 MiB, now
+    it's one 4 KiB block per touched element at most. sent_per_sync is the
+    transfer volume per iteration.
+*/
+static void BM_SparseUpdate(benchmark::State& state) {
+    constexpr size_t n = size_t{1} << 24;
+    fun::gpu_array<float, false, counting_backend> arr(n);
+    arr.host_ptr(0, n);
+    arr.to_device();
+
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<size_t> pick(0, n - 1);
+    const size_t updates = state.range(0);
+
+    counting_backend::bytes = 0;
+    for (auto _ : state) {
+        for (size_t i = 0; i < updates; i++) {
+            arr[pick(rng)] += 1.0f;
+        }
+        arr.to_device();
+    }
+    state.counters["sent_per_sync"] = benchmark::Counter(
+        static_cast<double>(counting_backend::bytes),
+        benchmark::Counter::kAvgIterations, benchmark::Counter::kIs1024);
+}
+
+BENCHMARK(BM_SparseUpdate)
+    ->RangeMultiplier(16)
+    ->Range(1, 1 << 16)
+    ->UseRealTime();
+
+/*
+    Chunked streaming of a 64 MiB array with a light "kernel" (scale by 2)
+    per chunk, effective GB/s end to end. range(0) is the chunk size in
+    bytes; the 64 MiB case is one chunk, so nothing overlaps and it's the
+    serial baseline. Pageable arrays pay the extra staging memcpy.
+*/
+template <bool Pinned> static void BM_Stream(benchmark::State& state) {
+    constexpr size_t n = size_t{1} << 24;
+    fun::gpu_array<float, Pinned> arr(n);
+    float* host = arr.host_ptr(0, n);
+    for (size_t i = 0; i < n; i++) {
+        host[i] = static_cast<float>(i);
+    }
+
+    const size_t chunk = state.range(0) / sizeof(float);
+    for (auto _ : state) {
+        arr.stream_to_device(chunk, [](float* device, size_t, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                device[i] *= 2.0f;
+            }
+        });
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * n * sizeof(float));
+}
+
+BENCHMARK_TEMPLATE(BM_Stream, false)
+    ->RangeMultiplier(8)
+    ->Range(1 << 16, 1 << 26)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Stream, true)
+    ->RangeMultiplier(8)
+    ->Range(1 << 16, 1 << 26)
+    ->UseRealTime();
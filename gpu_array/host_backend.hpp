@@ -0,0 +1,120 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+
+/*
+    A stand-in GPU for machines without one (CI, laptops, CPU-only nodes).
+
+    "Device" memory is a separate host allocation, so forgetting a
+    to_device()/to_host() still shows up as stale data exactly like it would
+    on a real card, and transfers are memcpys run by copy threads, one per
+    direction like the two copy engines on most cards, so uploads, downloads
+    and whatever the caller computes meanwhile all overlap.
+
+    Kernels are whatever CPU loop you run over device_ptr().
+*/
+namespace fun {
+namespace detail {
+
+// One thread, FIFO, like a single CUDA copy engine
+class copy_worker {
+public:
+    copy_worker() : thread_{[this] { run(); }} {}
+
+    template <typename F> std::future<void> submit(F&& job) {
+        std::packaged_task<void()> task(std::forward<F>(job));
+        std::future<void> done = task.get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            jobs_.push_back(std::move(task));
+        }
+        wake_.notify_one();
+        return done;
+    }
+
+    ~copy_worker() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<std::packaged_task<void()>> jobs_;
+    bool stop_ = false;
+    std::thread thread_;
+
+    void run() {
+        for (;;) {
+            std::packaged_task<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+                if (jobs_.empty()) {
+                    return;
+                }
+                job = std::move(jobs_.front());
+                jobs_.pop_front();
+            }
+            job();
+        }
+    }
+};
+}; // namespace detail
+
+struct host_backend {
+    // cudaMalloc hands out 256 byte aligned blocks, so do we
+    static constexpr std::align_val_t device_alignment{256};
+
+    static void* device_alloc(size_t bytes) {
+        return ::operator new(bytes, device_alignment);
+    }
+    static void device_free(void* p) noexcept {
+        ::operator delete(p, device_alignment);
+    }
+
+    // Nothing to pin, page aligned like cudaMallocHost
+    static void* pinned_alloc(size_t bytes) {
+        return ::operator new(bytes, std::align_val_t{4096});
+    }
+    static void pinned_free(void* p) noexcept {
+        ::operator delete(p, std::align_val_t{4096});
+    }
+
+    using event = std::future<void>;
+
+    static event copy_to_device_async(void* dst, const void* src,
+                                      size_t bytes) {
+        static detail::copy_worker upload;
+        return upload.submit([=] { std::memcpy(dst, src, bytes); });
+    }
+    static event copy_to_host_async(void* dst, const void* src, size_t bytes) {
+        static detail::copy_worker download;
+        return download.submit([=] { std::memcpy(dst, src, bytes); });
+    }
+    static void wait(event& e) { e.get(); }
+    static bool ready(const event& e) {
+        return e.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    static void copy_to_device(void* dst, const void* src, size_t bytes) {
+        copy_to_device_async(dst, src, bytes).get();
+    }
+    static void copy_to_host(void* dst, const void* src, size_t bytes) {
+        copy_to_host_async(dst, src, bytes).get();
+    }
+};
+
+}; // namespace fun
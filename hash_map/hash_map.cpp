@@ -0,0 +1,396 @@
+#include "hash_map.hpp"
+#include "memory_resource.hpp"
+#include <gtest/gtest.h>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using fun::instrument::counting_element;
+
+// Lets std::string keys be looked up by string_view or const char*
+struct string_hash {
+    using is_transparent = void;
+    size_t operator()(std::string_view s) const {
+        return std::hash<std::string_view>{}(s);
+    }
+};
+
+// Every key lands on the same H1 and H2, so everything is one long probe
+struct constant_hash {
+    size_t operator()(int) const { return 0; }
+};
+
+// Hashes counting_element by value, so it can be a key
+struct counting_hash {
+    size_t operator()(const counting_element& e) const {
+        return std::hash<int>{}(e.value);
+    }
+};
+
+// Copies throw once copies_left runs out, and the move isn't noexcept so
+// rehashing has to copy
+struct throwing_key {
+    static inline int copies_left = -1;
+    int value;
+
+    throwing_key(int v) : value{v} {}
+    throwing_key(const throwing_key& o) : value{o.value} {
+        if (copies_left == 0) {
+            throw std::runtime_error("copy");
+        }
+        copies_left--;
+    }
+    throwing_key(throwing_key&& o) : value{o.value} {}
+
+    bool operator==(const throwing_key& o) const { return value == o.value; }
+};
+
+struct throwing_key_hash {
+    size_t operator()(const throwing_key& k) const {
+        return std::hash<int>{}(k.value);
+    }
+};
+
+// Counts buffer allocations to catch rehashes
+template <typename T> struct counting_allocator {
+    using value_type = T;
+    static inline size_t allocations = 0;
+
+    counting_allocator() = default;
+    template <typename U> counting_allocator(const counting_allocator<U>&) {}
+
+    T* allocate(size_t n) {
+        allocations++;
+        return std::allocator<T>{}.allocate(n);
+    }
+    void deallocate(T* p, size_t n) { std::allocator<T>{}.deallocate(p, n); }
+
+    template <typename U> bool operator==(const counting_allocator<U>&) const {
+        return true;
+    }
+    template <typename U> bool operator!=(const counting_allocator<U>&) const {
+        return false;
+    }
+};
+
+TEST(HashMapTests, EmptyDoesNotAllocate) {
+    fun::flat_hash_map<int, int> map;
+    EXPECT_EQ(map.size(), 0);
+    EXPECT_EQ(map.capacity(), 0);
+    EXPECT_EQ(map.find(3), map.end());
+    EXPECT_FALSE(map.contains(3));
+    EXPECT_EQ(map.begin(), map.end());
+}
+
+TEST(HashMapTests, InsertFind) {
+    fun::flat_hash_map<int, std::string> map;
+    EXPECT_TRUE(map.insert({1, "one"}).second);
+    EXPECT_TRUE(map.try_emplace(2, "two").second);
+    // Already there, nothing changes
+    EXPECT_FALSE(map.insert({1, "uno"}).second);
+    EXPECT_FALSE(map.try_emplace(2, "dos").second);
+
+    EXPECT_EQ(map.size(), 2);
+    EXPECT_EQ(map.find(1)->second, "one");
+    EXPECT_EQ(map.at(2), "two");
+    EXPECT_EQ(map.count(3), 0);
+    EXPECT_THROW(map.at(3), std::out_of_range);
+}
+
+TEST(HashMapTests, SubscriptAndInsertOrAssign) {
+    fun::flat_hash_map<std::string, int> map;
+    map["a"] = 1;
+    map["a"]++;
+    EXPECT_EQ(map["a"], 2);
+    // Default constructs on a miss, like std::unordered_map
+    EXPECT_EQ(map["b"], 0);
+
+    EXPECT_FALSE(map.insert_or_assign("a", 10).second);
+    EXPECT_TRUE(map.insert_or_assign("c", 3).second);
+    EXPECT_EQ(map.at("a"), 10);
+    EXPECT_EQ(map.size(), 3);
+}
+
+TEST(HashMapTests, Erase) {
+    fun::flat_hash_map<int, int> map{{1, 10}, {2, 20}, {3, 30}};
+    EXPECT_EQ(map.erase(2), 1);
+    EXPECT_EQ(map.erase(2), 0);
+    EXPECT_FALSE(map.contains(2));
+    EXPECT_EQ(map.size(), 2);
+
+    auto it = map.find(1);
+    auto next = map.erase(it);
+    EXPECT_TRUE(next == map.end() || next->first == 3);
+    EXPECT_EQ(map.size(), 1);
+    EXPECT_EQ(map.at(3), 30);
+}
+
+TEST(HashMapTests, GrowsAndKeepsEverything) {
+    fun::flat_hash_map<int, int> map;
+    for (int i = 0; i < 10000; i++) {
+        map[i] = i * 2;
+    }
+
+    EXPECT_EQ(map.size(), 10000);
+    EXPECT_LE(map.load_factor(), map.max_load_factor());
+    for (int i = 0; i < 10000; i++) {
+        ASSERT_EQ(map.at(i), i * 2);
+    }
+    EXPECT_FALSE(map.contains(10000));
+}
+
+TEST(HashMapTests, Iteration) {
+    fun::flat_hash_map<int, int> map;
+    for (int i = 0; i < 100; i++) {
+        map[i] = 1;
+    }
+    map.erase(50);
+
+    size_t seen = 0;
+    int sum = 0;
+    for (const auto& [k, v] : map) {
+        seen++;
+        sum += k * v;
+    }
+    EXPECT_EQ(seen, 99);
+    EXPECT_EQ(sum, 99 * 100 / 2 - 50);
+
+    for (auto& kv : map) {
+        kv.second = 7;
+    }
+    EXPECT_EQ(map.at(3), 7);
+
+    const auto& cmap = map;
+    fun::flat_hash_map<int, int>::const_iterator cit = map.begin();
+    EXPECT_EQ(cit, cmap.begin());
+}
+
+TEST(HashMapTests, HeterogeneousLookup) {
+    fun::flat_hash_map<std::string, int, string_hash, std::equal_to<>> map;
+    map["apple"] = 1;
+    map["banana"] = 2;
+
+    const std::string_view key = "banana";
+    EXPECT_EQ(map.find(key)->second, 2);
+    EXPECT_TRUE(map.contains("apple"));
+    EXPECT_EQ(map.at(std::string_view("apple")), 1);
+    EXPECT_EQ(map.erase(key), 1);
+    EXPECT_FALSE(map.contains("banana"));
+}
+
+TEST(HashMapTests, CollisionsStillWork) {
+    // Every key collides, probes have to go past whole groups
+    fun::flat_hash_map<int, int, constant_hash> map;
+    for (int i = 0; i < 100; i++) {
+        map[i] = i;
+    }
+    for (int i = 0; i < 100; i += 2) {
+        map.erase(i);
+    }
+    for (int i = 1; i < 100; i += 2) {
+        ASSERT_EQ(map.at(i), i);
+    }
+    EXPECT_FALSE(map.contains(0));
+    EXPECT_EQ(map.size(), 50);
+}
+
+TEST(HashMapTests, ChurnWithoutTombstonesDoesNotRehash) {
+    using alloc = counting_allocator<std::pair<const int, int>>;
+    fun::flat_hash_map<int, int, std::hash<int>, std::equal_to<int>, alloc>
+        map(1000);
+    const size_t capacity = map.capacity();
+    const size_t allocations = alloc::allocations;
+
+    // A sparse table never has 16 full slots in a row, so every erase
+    // empties its slot for real and the load budget never runs out
+    for (int i = 0; i < 100000; i++) {
+        map[i] = i;
+        map.erase(i);
+    }
+    EXPECT_EQ(map.capacity(), capacity);
+    EXPECT_EQ(alloc::allocations, allocations);
+}
+
+TEST(HashMapTests, TombstonesGetCleanedUp) {
+    fun::flat_hash_map<int, int, constant_hash> map;
+    for (int round = 0; round < 50; round++) {
+        for (int i = 0; i < 20; i++) {
+            map[round * 100 + i] = i;
+        }
+        for (int i = 0; i < 20; i++) {
+            map.erase(round * 100 + i);
+        }
+    }
+
+    // A full cluster of tombstones rehashes in place instead of growing
+    EXPECT_TRUE(map.empty());
+    EXPECT_LE(map.capacity(), 64);
+}
+
+TEST(HashMapTests, CopyMoveSwap) {
+    fun::flat_hash_map<std::string, int> a{{"x", 1}, {"y", 2}};
+    fun::flat_hash_map<std::string, int> b(a);
+    EXPECT_EQ(b.at("y"), 2);
+    b["z"] = 3;
+    EXPECT_FALSE(a.contains("z"));
+
+    fun::flat_hash_map<std::string, int> c(std::move(b));
+    EXPECT_EQ(b.size(), 0);
+    EXPECT_EQ(c.size(), 3);
+
+    a = c;
+    EXPECT_EQ(a.size(), 3);
+    a = std::move(c);
+    EXPECT_EQ(a.at("z"), 3);
+
+    fun::flat_hash_map<std::string, int> d;
+    swap(a, d);
+    EXPECT_TRUE(a.empty());
+    EXPECT_EQ(d.size(), 3);
+}
+
+TEST(HashMapArenaTests, ArenaBackedMap) {
+    fun::monotonic_arena arena;
+    fun::pmr::flat_hash_map<int, int> map{&arena};
+    for (int i = 0; i < 1000; i++) {
+        map[i] = i * 2;
+    }
+    EXPECT_EQ(map.at(999), 1998);
+    EXPECT_EQ(map.get_allocator().resource(), &arena);
+    EXPECT_GE(arena.bytes_allocated(), 1000 * sizeof(std::pair<int, int>));
+}
+
+TEST(HashMapArenaTests, AssignAndSwapAcrossArenas) {
+    fun::monotonic_arena a, b;
+    fun::pmr::flat_hash_map<std::string, int> ma{&a};
+    ma["x"] = 1;
+    ma["y"] = 2;
+    fun::pmr::flat_hash_map<std::string, int> mb{&b};
+
+    // b can't free a's memory, so the elements move instead of the table
+    mb = std::move(ma);
+    EXPECT_EQ(mb.size(), 2);
+    EXPECT_EQ(mb.at("y"), 2);
+    EXPECT_TRUE(ma.empty());
+    EXPECT_EQ(mb.get_allocator().resource(), &b);
+
+    // Copies land in the target's arena too, pmr allocators don't propagate
+    fun::pmr::flat_hash_map<std::string, int> mc{&a};
+    mc = mb;
+    EXPECT_EQ(mc.at("x"), 1);
+    EXPECT_EQ(mc.get_allocator().resource(), &a);
+
+    // Same arena, the table itself is handed over
+    fun::pmr::flat_hash_map<std::string, int> md{&a};
+    md = std::move(mc);
+    EXPECT_EQ(md.size(), 2);
+    EXPECT_EQ(md.get_allocator().resource(), &a);
+
+    fun::pmr::flat_hash_map<std::string, int> me{&a};
+    swap(md, me);
+    EXPECT_TRUE(md.empty());
+    EXPECT_EQ(me.at("y"), 2);
+
+    // Moving across arenas may allocate
+    static_assert(!std::is_nothrow_move_assignable_v<
+                  fun::pmr::flat_hash_map<int, int>>);
+    static_assert(std::is_nothrow_move_assignable_v<
+                  fun::flat_hash_map<int, int>>);
+}
+
+TEST(HashMapTests, ElementLifetimes) {
+    counting_element::tally() = {};
+    {
+        fun::flat_hash_map<int, counting_element> map;
+        for (int i = 0; i < 1000; i++) {
+            map.try_emplace(i, i);
+        }
+        for (int i = 0; i < 1000; i += 3) {
+            map.erase(i);
+        }
+        map.clear();
+        map[1] = counting_element(5);
+    }
+    // Everything constructed, moved around by rehashes, or erased is
+    // destroyed exactly once
+    EXPECT_EQ(counting_element::tally().alive(), 0);
+}
+
+TEST(HashMapTests, RehashMovesKeys) {
+    counting_element::tally() = {};
+    fun::flat_hash_map<counting_element, int, counting_hash> map;
+    for (int i = 0; i < 1000; i++) {
+        map.try_emplace(counting_element(i), i);
+    }
+    EXPECT_EQ(map.size(), 1000);
+    // Keys get moved in and moved on every rehash, never copied
+    EXPECT_EQ(counting_element::tally().copies, 0);
+}
+
+TEST(HashMapTests, ThrowingCopyDuringRehash) {
+    fun::flat_hash_map<throwing_key, int, throwing_key_hash> map;
+    for (int i = 0; i < 14; i++) {
+        map.try_emplace(throwing_key(i), i);
+    }
+    const size_t capacity = map.capacity();
+
+    // The 15th insert grows, the 6th key copied over throws
+    throwing_key::copies_left = 5;
+    EXPECT_THROW(map.try_emplace(throwing_key(14), 14), std::runtime_error);
+    throwing_key::copies_left = -1;
+
+    EXPECT_EQ(map.size(), 14);
+    EXPECT_EQ(map.capacity(), capacity);
+    EXPECT_FALSE(map.contains(throwing_key(14)));
+    for (int i = 0; i < 14; i++) {
+        EXPECT_EQ(map.at(throwing_key(i)), i);
+    }
+    EXPECT_TRUE(map.try_emplace(throwing_key(14), 14).second);
+    EXPECT_EQ(map.at(throwing_key(14)), 14);
+}
+
+TEST(HashMapTests, InsertOwnElementWhileGrowing) {
+    fun::flat_hash_map<int, std::string> map;
+    for (int i = 0; i < 14; i++) {
+        map.try_emplace(i, "a string long enough to allocate " +
+                               std::to_string(i));
+    }
+    const size_t capacity = map.capacity();
+
+    // Grows, the argument is read before the old table goes away
+    map.try_emplace(100, map.at(3));
+    EXPECT_GT(map.capacity(), capacity);
+    EXPECT_EQ(map.at(100), "a string long enough to allocate 3");
+    EXPECT_EQ(map.at(3), map.at(100));
+}
+
+TEST(HashMapTests, MatchesUnorderedMap) {
+    std::mt19937 rng(7);
+    fun::flat_hash_map<uint32_t, uint32_t> map;
+    std::unordered_map<uint32_t, uint32_t> ref;
+
+    for (int op = 0; op < 200000; op++) {
+        const uint32_t key = rng() % 5000;
+        switch (rng() % 3) {
+        case 0:
+            map[key] = static_cast<uint32_t>(op);
+            ref[key] = static_cast<uint32_t>(op);
+            break;
+        case 1:
+            ASSERT_EQ(map.erase(key), ref.erase(key));
+            break;
+        default:
+            ASSERT_EQ(map.contains(key), ref.count(key) == 1);
+            break;
+        }
+    }
+
+    ASSERT_EQ(map.size(), ref.size());
+    for (const auto& [k, v] : ref) {
+        ASSERT_EQ(map.at(k), v);
+    }
+}
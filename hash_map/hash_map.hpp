@@ -0,0 +1,765 @@
+#pragma once
+#include "instrument.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/*
+    Open addressing hash map in the style of abseil's Swiss tables.
+
+    All slots live in one flat array next to an array of control bytes, one
+    per slot: empty, deleted (tombstone), or full with the low 7 bits of the
+    key's hash (H2). A lookup hashes once, jumps to H1 = the rest of the hash,
+    and checks 16 control bytes at a time (one SSE2 compare + movemask) for
+    H2 matches, so it only touches a slot when 7 bits of hash already agree.
+    It stops at the first group with an empty byte.
+
+    Compared to std::unordered_map: no node per element, no pointer chasing,
+    and usually one cache miss per lookup. The cost is that rehashing moves
+    elements, so references and iterators don't survive an insert that grows.
+    Slots are stored as pair<K, V> and handed out as pair<const K, V>& (the
+    same trick abseil and libc++ use), so a rehash moves keys instead of
+    copying them.
+
+    Erase only leaves a tombstone when the slot sits in a run of 16+ non-empty
+    slots (a probe could have passed through it); otherwise the slot is just
+    emptied again. With transparent Hash and KeyEqual (both with
+    is_transparent) find/contains/count/erase take anything comparable to K,
+    e.g. a std::string_view against std::string keys.
+*/
+namespace fun {
+namespace detail {
+
+using ctrl_t = int8_t;
+
+// Full slots hold H2 in [0, 127], so the sign bit is "not full"
+inline constexpr ctrl_t ctrl_empty = -128;
+inline constexpr ctrl_t ctrl_deleted = -2;
+
+inline constexpr size_t group_width = 16;
+
+// 16 control bytes, each query is a bitmask with bit i for ctrl[i]
+struct ctrl_group {
+#ifdef __SSE2__
+    __m128i ctrl;
+
+    explicit ctrl_group(const ctrl_t* p)
+        : ctrl{_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))} {}
+
+    uint32_t match(ctrl_t h2) const {
+        return static_cast<uint32_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl)));
+    }
+    uint32_t match_empty() const { return match(ctrl_empty); }
+    uint32_t match_empty_or_deleted() const {
+        return static_cast<uint32_t>(_mm_movemask_epi8(ctrl));
+    }
+#else
+    ctrl_t ctrl[group_width];
+
+    explicit ctrl_group(const ctrl_t* p) { std::memcpy(ctrl, p, group_width); }
+
+    uint32_t match(ctrl_t h2) const {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < group_width; i++) {
+            mask |= uint32_t{ctrl[i] == h2} << i;
+        }
+        return mask;
+    }
+    uint32_t match_empty() const { return match(ctrl_empty); }
+    uint32_t match_empty_or_deleted() const {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < group_width; i++) {
+            mask |= uint32_t{ctrl[i] < 0} << i;
+        }
+        return mask;
+    }
+#endif
+};
+
+inline uint32_t lowest_bit(uint32_t mask) {
+    return static_cast<uint32_t>(__builtin_ctz(mask));
+}
+
+/*
+    std::hash is the identity for integers, whose low bits are then useless
+    for H2. One multiply folds the high bits back down.
+*/
+inline size_t mix_hash(size_t h) {
+    __extension__ using u128 = unsigned __int128;
+    const u128 m = static_cast<u128>(h) * 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>(m) ^ static_cast<size_t>(m >> 64);
+}
+
+template <typename T, typename = void>
+struct is_transparent : std::false_type {};
+template <typename T>
+struct is_transparent<T, std::void_t<typename T::is_transparent>>
+    : std::true_type {};
+
+// A plain alias (not conditional_t) so Key stays deducible when transparent
+template <bool Transparent> struct key_arg_impl {
+    template <typename Key, typename> using type = Key;
+};
+template <> struct key_arg_impl<false> {
+    template <typename, typename K> using type = K;
+};
+}; // namespace detail
+
+template <typename K, typename V, typename Hash = std::hash<K>,
+          typename KeyEqual = std::equal_to<K>,
+          typename Allocator = std::allocator<std::pair<const K, V>>>
+class flat_hash_map {
+    using ctrl_t = detail::ctrl_t;
+    // Mutable key inside, so rehashing can really move it
+    using slot_type = std::pair<K, V>;
+    using slot_alloc = typename std::allocator_traits<
+        Allocator>::template rebind_alloc<slot_type>;
+    using alloc_traits = std::allocator_traits<slot_alloc>;
+    using ctrl_alloc = typename alloc_traits::template rebind_alloc<ctrl_t>;
+    using ctrl_traits = std::allocator_traits<ctrl_alloc>;
+
+    static constexpr bool transparent =
+        detail::is_transparent<Hash>::value &&
+        detail::is_transparent<KeyEqual>::value;
+
+    // Lookups take any Key with transparent functors, only K otherwise
+    template <typename Key>
+    using key_arg =
+        typename detail::key_arg_impl<transparent>::template type<Key, K>;
+
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<const K, V>;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using allocator_type = Allocator;
+
+    static_assert(sizeof(slot_type) == sizeof(value_type) &&
+                      alignof(slot_type) == alignof(value_type),
+                  "pair<K, V> has to look like pair<const K, V>");
+
+    template <bool Const> class basic_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = flat_hash_map::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference =
+            std::conditional_t<Const, const value_type&, value_type&>;
+        using pointer =
+            std::conditional_t<Const, const value_type*, value_type*>;
+
+        basic_iterator() = default;
+        // iterator -> const_iterator
+        template <bool C = Const, typename = std::enable_if_t<C>>
+        basic_iterator(const basic_iterator<false>& other)
+            : ctrl_{other.ctrl_}, slot_{other.slot_}, end_{other.end_} {}
+
+        reference operator*() const { return *operator->(); }
+        pointer operator->() const {
+            return reinterpret_cast<pointer>(slot_);
+        }
+
+        basic_iterator& operator++() {
+            ++ctrl_;
+            ++slot_;
+            skip_empty();
+            return *this;
+        }
+        basic_iterator operator++(int) {
+            basic_iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const basic_iterator& other) const {
+            return ctrl_ == other.ctrl_;
+        }
+        bool operator!=(const basic_iterator& other) const {
+            return ctrl_ != other.ctrl_;
+        }
+
+    private:
+        friend class flat_hash_map;
+        template <bool> friend class basic_iterator;
+
+        using slot_pointer =
+            std::conditional_t<Const, const slot_type*, slot_type*>;
+
+        const ctrl_t* ctrl_ = nullptr;
+        slot_pointer slot_ = nullptr;
+        const ctrl_t* end_ = nullptr;
+
+        basic_iterator(const ctrl_t* ctrl, slot_pointer slot,
+                       const ctrl_t* end)
+            : ctrl_{ctrl}, slot_{slot}, end_{end} {}
+
+        void skip_empty() {
+            while (ctrl_ != end_ && *ctrl_ < 0) {
+                ++ctrl_;
+                ++slot_;
+            }
+        }
+    };
+
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    // Empty maps don't allocate, the first insert does
+    flat_hash_map() : flat_hash_map(0) {}
+    explicit flat_hash_map(size_t bucket_count, const Hash& hash = Hash(),
+                           const KeyEqual& eq = KeyEqual(),
+                           const Allocator& alloc = Allocator())
+        : ctrl_{nullptr}, slots_{nullptr}, size_{0}, capacity_{0},
+          growth_left_{0}, hash_{hash}, eq_{eq}, alloc_{alloc} {
+        if (bucket_count > 0) {
+            reserve(bucket_count);
+        }
+    }
+    explicit flat_hash_map(const Allocator& alloc)
+        : flat_hash_map(0, Hash(), KeyEqual(), alloc) {}
+    flat_hash_map(std::initializer_list<value_type> list)
+        : flat_hash_map(list.size()) {
+        for (const auto& kv : list) {
+            insert(kv);
+        }
+    }
+    ~flat_hash_map() { destroy_and_free(); }
+
+    flat_hash_map(const flat_hash_map& other)
+        : flat_hash_map(other.size_, other.hash_, other.eq_,
+                        alloc_traits::select_on_container_copy_construction(
+                            other.alloc_)) {
+        for (const auto& kv : other) {
+            insert_unique(kv.first, kv);
+        }
+    }
+    // Copies land in our own buffers unless the allocator propagates
+    flat_hash_map& operator=(const flat_hash_map& other) {
+        if (this != &other) {
+            constexpr bool propagate =
+                alloc_traits::propagate_on_container_copy_assignment::value;
+            flat_hash_map copy(other.size_, other.hash_, other.eq_,
+                               Allocator(propagate ? other.alloc_ : alloc_));
+            for (const auto& kv : other) {
+                copy.insert_unique(kv.first, kv);
+            }
+            take_buffers(copy);
+            if constexpr (propagate) {
+                using std::swap;
+                swap(alloc_, copy.alloc_);
+            }
+        }
+
+        return *this;
+    }
+    flat_hash_map(flat_hash_map&& other) noexcept
+        : ctrl_{other.ctrl_}, slots_{other.slots_}, size_{other.size_},
+          capacity_{other.capacity_}, growth_left_{other.growth_left_},
+          hash_{std::move(other.hash_)}, eq_{std::move(other.eq_)},
+          alloc_{std::move(other.alloc_)} {
+        other.forget();
+    }
+    // Like fun::vector, only noexcept when the buffers can always be stolen
+    flat_hash_map& operator=(flat_hash_map&& other) noexcept(
+        alloc_traits::propagate_on_container_move_assignment::value ||
+        alloc_traits::is_always_equal::value) {
+        if (this == &other) {
+            return *this;
+        }
+
+        hash_ = std::move(other.hash_);
+        eq_ = std::move(other.eq_);
+        // We can only steal the buffers if our allocator can free them
+        if (alloc_traits::propagate_on_container_move_assignment::value ||
+            alloc_ == other.alloc_) {
+            destroy_and_free();
+            ctrl_ = other.ctrl_;
+            slots_ = other.slots_;
+            size_ = other.size_;
+            capacity_ = other.capacity_;
+            growth_left_ = other.growth_left_;
+            if constexpr (alloc_traits::
+                              propagate_on_container_move_assignment::value) {
+                alloc_ = std::move(other.alloc_);
+            }
+            other.forget();
+        }
+        else {
+            // Different arenas, so fall back to moving element-wise
+            clear();
+            reserve(other.size_);
+            for (size_t i = 0; i < other.capacity_; i++) {
+                if (other.ctrl_[i] >= 0) {
+                    insert_unique(other.slots_[i].first,
+                                  std::move(other.slots_[i]));
+                }
+            }
+            other.clear();
+        }
+
+        return *this;
+    }
+
+    // Allocators only trade places if they propagate on swap, otherwise
+    // they have to be equal (same as the standard containers)
+    void swap(flat_hash_map& other) noexcept {
+        using std::swap;
+        swap(hash_, other.hash_);
+        swap(eq_, other.eq_);
+        take_buffers(other);
+        if constexpr (alloc_traits::propagate_on_container_swap::value) {
+            swap(alloc_, other.alloc_);
+        }
+    }
+
+    allocator_type get_allocator() const { return allocator_type(alloc_); }
+
+    iterator begin() {
+        iterator it{ctrl_, slots_, ctrl_ + capacity_};
+        it.skip_empty();
+        return it;
+    }
+    iterator end() {
+        return {ctrl_ + capacity_, slots_ + capacity_, ctrl_ + capacity_};
+    }
+    const_iterator begin() const {
+        const_iterator it{ctrl_, slots_, ctrl_ + capacity_};
+        it.skip_empty();
+        return it;
+    }
+    const_iterator end() const {
+        return {ctrl_ + capacity_, slots_ + capacity_, ctrl_ + capacity_};
+    }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+    [[nodiscard]] size_t capacity() const noexcept { return capacity_; }
+    float load_factor() const noexcept {
+        return capacity_ == 0 ? 0.0f
+                              : static_cast<float>(size_) / capacity_;
+    }
+    static constexpr float max_load_factor() noexcept { return 7.0f / 8.0f; }
+
+    // Keeps the buffers, like std::vector::clear
+    void clear() noexcept {
+        destroy_slots(ctrl_, slots_, capacity_);
+        if (capacity_ > 0) {
+            reset_ctrl();
+        }
+        size_ = 0;
+    }
+
+    // Room for n elements without rehashing
+    void reserve(size_t n) {
+        const size_t needed = capacity_for(n);
+        if (needed > capacity_) {
+            rehash_to(needed);
+        }
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const K& key, Args&&... args) {
+        return emplace_key(key, std::piecewise_construct,
+                           std::forward_as_tuple(key),
+                           std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+        return emplace_key(key, std::piecewise_construct,
+                           std::forward_as_tuple(std::move(key)),
+                           std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+    std::pair<iterator, bool> insert(const value_type& kv) {
+        return emplace_key(kv.first, kv);
+    }
+    std::pair<iterator, bool> insert(value_type&& kv) {
+        return emplace_key(kv.first, std::move(kv));
+    }
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(const K& key, M&& obj) {
+        auto [it, inserted] = try_emplace(key, std::forward<M>(obj));
+        if (!inserted) {
+            it->second = std::forward<M>(obj);
+        }
+        return {it, inserted};
+    }
+
+    V& operator[](const K& key) { return try_emplace(key).first->second; }
+    V& operator[](K&& key) {
+        return try_emplace(std::move(key)).first->second;
+    }
+
+    template <typename Key = K> V& at(const key_arg<Key>& key) {
+        const size_t idx = find_index(key);
+        if (idx == npos) {
+            throw std::out_of_range("flat_hash_map::at key not found!");
+        }
+
+        return slots_[idx].second;
+    }
+    template <typename Key = K> const V& at(const key_arg<Key>& key) const {
+        const size_t idx = find_index(key);
+        if (idx == npos) {
+            throw std::out_of_range("flat_hash_map::at key not found!");
+        }
+
+        return slots_[idx].second;
+    }
+
+    template <typename Key = K> iterator find(const key_arg<Key>& key) {
+        return iterator_at(find_index(key));
+    }
+    template <typename Key = K>
+    const_iterator find(const key_arg<Key>& key) const {
+        const size_t idx = find_index(key);
+        return idx == npos ? end()
+                           : const_iterator{ctrl_ + idx, slots_ + idx,
+                                            ctrl_ + capacity_};
+    }
+    template <typename Key = K> bool contains(const key_arg<Key>& key) const {
+        return find_index(key) != npos;
+    }
+    template <typename Key = K> size_t count(const key_arg<Key>& key) const {
+        return contains<Key>(key) ? 1 : 0;
+    }
+
+    template <typename Key = K> size_t erase(const key_arg<Key>& key) {
+        const size_t idx = find_index(key);
+        if (idx == npos) {
+            return 0;
+        }
+
+        erase_at(idx);
+        return 1;
+    }
+    // Returns the next element, erasing never moves the others
+    iterator erase(const_iterator pos) {
+        const size_t idx = static_cast<size_t>(pos.ctrl_ - ctrl_);
+        erase_at(idx);
+        iterator next{ctrl_ + idx, slots_ + idx, ctrl_ + capacity_};
+        next.skip_empty();
+        return next;
+    }
+    iterator erase(iterator pos) { return erase(const_iterator{pos}); }
+
+private:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    // capacity_ + group_width bytes, the tail mirrors the first group so a
+    // 16 byte load starting anywhere in [0, capacity_) never wraps
+    ctrl_t* ctrl_;
+    slot_type* slots_;
+    size_t size_;
+    // A power of two, 0 or at least group_width
+    size_t capacity_;
+    // Inserts into empty slots left before we're over max_load_factor
+    size_t growth_left_;
+    Hash hash_;
+    KeyEqual eq_;
+    slot_alloc alloc_;
+
+    static size_t max_size_for(size_t capacity) {
+        return capacity - capacity / 8;
+    }
+    static size_t capacity_for(size_t n) {
+        size_t capacity = detail::group_width;
+        while (max_size_for(capacity) < n) {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    // H1 picks the starting slot, H2 goes in the control byte
+    template <typename Key> size_t hash_of(const Key& key) const {
+        return detail::mix_hash(hash_(key));
+    }
+    static size_t h1(size_t hash) { return hash >> 7; }
+    static ctrl_t h2(size_t hash) { return static_cast<ctrl_t>(hash & 0x7F); }
+
+    void set_ctrl(size_t idx, ctrl_t c) {
+        ctrl_[idx] = c;
+        if (idx < detail::group_width) {
+            ctrl_[capacity_ + idx] = c;
+        }
+    }
+
+    void reset_ctrl() {
+        std::memset(ctrl_, static_cast<unsigned char>(detail::ctrl_empty),
+                    capacity_ + detail::group_width);
+        growth_left_ = max_size_for(capacity_);
+    }
+
+    /*
+        Probes whole groups: start at H1, then jump 1, 2, 3, ... groups
+        further (triangular steps), which visits every group of a power of
+        two table exactly once before repeating.
+    */
+    template <typename Key> size_t find_index(const Key& key) const {
+        if (size_ == 0) {
+            return npos;
+        }
+
+        const size_t hash = hash_of(key);
+        const size_t mask = capacity_ - 1;
+        size_t pos = h1(hash) & mask;
+        for (size_t step = detail::group_width;; step += detail::group_width) {
+            const detail::ctrl_group g{ctrl_ + pos};
+            for (uint32_t m = g.match(h2(hash)); m != 0; m &= m - 1) {
+                const size_t idx = (pos + detail::lowest_bit(m)) & mask;
+                if (eq_(slots_[idx].first, key)) {
+                    return idx;
+                }
+            }
+            if (g.match_empty() != 0) {
+                return npos;
+            }
+            pos = (pos + step) & mask;
+        }
+    }
+
+    // First empty or deleted slot on hash's probe sequence
+    size_t find_insert_slot(size_t hash) const {
+        const size_t mask = capacity_ - 1;
+        size_t pos = h1(hash) & mask;
+        for (size_t step = detail::group_width;; step += detail::group_width) {
+            const detail::ctrl_group g{ctrl_ + pos};
+            if (const uint32_t m = g.match_empty_or_deleted()) {
+                return (pos + detail::lowest_bit(m)) & mask;
+            }
+            pos = (pos + step) & mask;
+        }
+    }
+
+    iterator iterator_at(size_t idx) {
+        return idx == npos ? end()
+                           : iterator{ctrl_ + idx, slots_ + idx,
+                                      ctrl_ + capacity_};
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace_key(const K& key, Args&&... args) {
+        const size_t found = find_index(key);
+        if (found != npos) {
+            return {iterator_at(found), false};
+        }
+
+        return {iterator_at(insert_unique(key, std::forward<Args>(args)...)),
+                true};
+    }
+
+    // key is known to be absent
+    template <typename... Args>
+    size_t insert_unique(const K& key, Args&&... args) {
+        const size_t hash = hash_of(key);
+        size_t idx = capacity_ == 0 ? npos : find_insert_slot(hash);
+        // Reusing a tombstone doesn't eat into the load budget
+        if (idx == npos ||
+            (growth_left_ == 0 && ctrl_[idx] != detail::ctrl_deleted)) {
+            // args can point into the table grow() tears down, e.g.
+            // m.try_emplace(k, m.at(other)), so build the element first
+            slot_type kv(std::forward<Args>(args)...);
+            grow();
+            idx = find_insert_slot(hash);
+            alloc_traits::construct(alloc_, slots_ + idx, std::move(kv));
+        }
+        else {
+            alloc_traits::construct(alloc_, slots_ + idx,
+                                    std::forward<Args>(args)...);
+        }
+        growth_left_ -= ctrl_[idx] == detail::ctrl_empty;
+        set_ctrl(idx, h2(hash));
+        size_++;
+        return idx;
+    }
+
+    void erase_at(size_t idx) {
+        alloc_traits::destroy(alloc_, slots_ + idx);
+        size_--;
+
+        /*
+            A probe only ever passed this slot if its group had no empty
+            byte. Count the non-empty run around idx: shorter than a group
+            means every 16 byte window over idx has an empty, so nothing
+            probed through it and it can go straight back to empty.
+        */
+        const size_t mask = capacity_ - 1;
+        const size_t before = (idx - detail::group_width) & mask;
+        const uint32_t empty_after =
+            detail::ctrl_group{ctrl_ + idx}.match_empty();
+        const uint32_t empty_before =
+            detail::ctrl_group{ctrl_ + before}.match_empty();
+        const bool never_full =
+            empty_after != 0 && empty_before != 0 &&
+            static_cast<size_t>(__builtin_ctz(empty_after) +
+                                __builtin_clz(empty_before << 16)) <
+                detail::group_width;
+
+        if (never_full) {
+            set_ctrl(idx, detail::ctrl_empty);
+            growth_left_++;
+        }
+        else {
+            set_ctrl(idx, detail::ctrl_deleted);
+        }
+    }
+
+    // Doubles, unless most of what's in the way is tombstones
+    void grow() {
+        if (capacity_ > 0 && size_ <= max_size_for(capacity_) / 2) {
+            rehash_to(capacity_);
+        }
+        else {
+            rehash_to(capacity_ == 0 ? detail::group_width : capacity_ * 2);
+        }
+    }
+
+    /*
+        Moves everything over when that can't throw. Otherwise copies (like
+        std::vector, via move_if_noexcept) and the old table stays untouched
+        until the last copy made it, so a throwing copy leaves the map as it
+        was. hash_ already hashed every key once on the way in, it isn't
+        expected to throw here.
+    */
+    void rehash_to(size_t new_capacity) {
+        ctrl_t* old_ctrl = ctrl_;
+        slot_type* old_slots = slots_;
+        const size_t old_capacity = capacity_;
+        const size_t old_growth_left = growth_left_;
+
+        ctrl_alloc calloc(alloc_);
+        ctrl_ = ctrl_traits::allocate(calloc,
+                                      new_capacity + detail::group_width);
+        try {
+            slots_ = alloc_traits::allocate(alloc_, new_capacity);
+        }
+        catch (...) {
+            ctrl_traits::deallocate(calloc, ctrl_,
+                                    new_capacity + detail::group_width);
+            ctrl_ = old_ctrl;
+            throw;
+        }
+        FUN_INSTRUMENT_HOOK(on_allocate(
+            new_capacity * (sizeof(slot_type) + 1) + detail::group_width));
+        capacity_ = new_capacity;
+        reset_ctrl();
+        growth_left_ -= size_;
+
+        // Copies the element at old slot i into the new table (or moves it)
+        const auto place = [&](size_t i, auto&& kv) {
+            const size_t hash = hash_of(old_slots[i].first);
+            const size_t idx = find_insert_slot(hash);
+            alloc_traits::construct(alloc_, slots_ + idx,
+                                    std::forward<decltype(kv)>(kv));
+            set_ctrl(idx, h2(hash));
+        };
+
+        if constexpr (std::is_nothrow_move_constructible_v<slot_type>) {
+            for (size_t i = 0; i < old_capacity; i++) {
+                if (old_ctrl[i] >= 0) {
+                    place(i, std::move(old_slots[i]));
+                    alloc_traits::destroy(alloc_, old_slots + i);
+                }
+            }
+        }
+        else {
+            try {
+                for (size_t i = 0; i < old_capacity; i++) {
+                    if (old_ctrl[i] >= 0) {
+                        place(i, std::move_if_noexcept(old_slots[i]));
+                    }
+                }
+            }
+            catch (...) {
+                destroy_slots(ctrl_, slots_, capacity_);
+                free_buffers(ctrl_, slots_, capacity_);
+                ctrl_ = old_ctrl;
+                slots_ = old_slots;
+                capacity_ = old_capacity;
+                growth_left_ = old_growth_left;
+                throw;
+            }
+            destroy_slots(old_ctrl, old_slots, old_capacity);
+        }
+        free_buffers(old_ctrl, old_slots, old_capacity);
+    }
+
+    void destroy_slots(const ctrl_t* ctrl, slot_type* slots,
+                       size_t capacity) noexcept {
+        if constexpr (!std::is_trivially_destructible_v<slot_type>) {
+            for (size_t i = 0; i < capacity; i++) {
+                if (ctrl[i] >= 0) {
+                    alloc_traits::destroy(alloc_, slots + i);
+                }
+            }
+        }
+    }
+
+    void free_buffers(ctrl_t* ctrl, slot_type* slots,
+                      size_t capacity) noexcept {
+        if (capacity == 0) {
+            return;
+        }
+
+        FUN_INSTRUMENT_HOOK(on_deallocate(
+            capacity * (sizeof(slot_type) + 1) + detail::group_width));
+        ctrl_alloc calloc(alloc_);
+        ctrl_traits::deallocate(calloc, ctrl, capacity + detail::group_width);
+        alloc_traits::deallocate(alloc_, slots, capacity);
+    }
+
+    void destroy_and_free() noexcept {
+        destroy_slots(ctrl_, slots_, capacity_);
+        free_buffers(ctrl_, slots_, capacity_);
+        forget();
+    }
+
+    void forget() noexcept {
+        ctrl_ = nullptr;
+        slots_ = nullptr;
+        size_ = 0;
+        capacity_ = 0;
+        growth_left_ = 0;
+    }
+
+    // Swaps the tables only, the allocators stay where they are
+    void take_buffers(flat_hash_map& other) noexcept {
+        using std::swap;
+        swap(ctrl_, other.ctrl_);
+        swap(slots_, other.slots_);
+        swap(size_, other.size_);
+        swap(capacity_, other.capacity_);
+        swap(growth_left_, other.growth_left_);
+    }
+};
+
+template <typename K, typename V, typename H, typename E, typename A>
+void swap(flat_hash_map<K, V, H, E, A>& a,
+          flat_hash_map<K, V, H, E, A>& b) noexcept {
+    a.swap(b);
+}
+
+namespace pmr {
+// Maps that draw from a std::pmr::memory_resource, e.g. fun::monotonic_arena
+template <typename K, typename V, typename Hash = std::hash<K>,
+          typename KeyEqual = std::equal_to<K>>
+using flat_hash_map =
+    fun::flat_hash_map<K, V, Hash, KeyEqual,
+                       std::pmr::polymorphic_allocator<std::pair<const K, V>>>;
+}; // namespace pmr
+
+}; // namespace fun
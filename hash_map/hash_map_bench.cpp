@@ -0,0 +1,107 @@
+#include "hash_map.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+/*
+    fun::flat_hash_map against std::unordered_map with random uint64 keys, at
+    sizes that fit in L1/L2, in L3, and in neither.
+
+    Hit looks up keys that are present, Miss keys that aren't (the probe has
+    to find an empty byte), Insert builds the whole map from empty, and
+    EraseMix erases and reinserts a quarter of the keys per iteration.
+*/
+static std::vector<uint64_t> random_keys(size_t n, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<uint64_t> keys(n);
+    for (auto& k : keys) {
+        k = rng();
+    }
+    return keys;
+}
+
+template <typename Map> static Map build(const std::vector<uint64_t>& keys) {
+    Map map;
+    for (uint64_t k : keys) {
+        map[k] = k;
+    }
+    return map;
+}
+
+template <typename Map> static void BM_Hit(benchmark::State& state) {
+    const auto keys = random_keys(state.range(0), 1);
+    const Map map = build<Map>(keys);
+    // Different order than insertion
+    const auto probes = random_keys(state.range(0), 1);
+    std::vector<uint64_t> order(probes.rbegin(), probes.rend());
+
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        for (uint64_t k : order) {
+            sum += map.find(k)->second;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * order.size());
+}
+
+template <typename Map> static void BM_Miss(benchmark::State& state) {
+    const Map map = build<Map>(random_keys(state.range(0), 1));
+    const auto probes = random_keys(state.range(0), 2);
+
+    for (auto _ : state) {
+        size_t found = 0;
+        for (uint64_t k : probes) {
+            found += map.count(k);
+        }
+        benchmark::DoNotOptimize(found);
+    }
+    state.SetItemsProcessed(state.iterations() * probes.size());
+}
+
+template <typename Map> static void BM_Insert(benchmark::State& state) {
+    const auto keys = random_keys(state.range(0), 1);
+
+    for (auto _ : state) {
+        Map map = build<Map>(keys);
+        benchmark::DoNotOptimize(map.size());
+    }
+    state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+template <typename Map> static void BM_EraseMix(benchmark::State& state) {
+    const auto keys = random_keys(state.range(0), 1);
+    Map map = build<Map>(keys);
+    const size_t quarter = keys.size() / 4;
+
+    size_t start = 0;
+    for (auto _ : state) {
+        for (size_t i = 0; i < quarter; i++) {
+            map.erase(keys[(start + i) % keys.size()]);
+        }
+        for (size_t i = 0; i < quarter; i++) {
+            const uint64_t k = keys[(start + i) % keys.size()];
+            map[k] = k;
+        }
+        start += quarter;
+    }
+    state.SetItemsProcessed(state.iterations() * 2 * quarter);
+}
+
+using fun_map = fun::flat_hash_map<uint64_t, uint64_t>;
+using std_map = std::unordered_map<uint64_t, uint64_t>;
+
+static void sizes(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(32)->Range(1 << 10, 1 << 20);
+}
+
+#define HASH_MAP_BENCH(fn)                                                     \
+    BENCHMARK_TEMPLATE(fn, std_map)->Apply(sizes);                             \
+    BENCHMARK_TEMPLATE(fn, fun_map)->Apply(sizes);
+
+HASH_MAP_BENCH(BM_Hit)
+HASH_MAP_BENCH(BM_Miss)
+HASH_MAP_BENCH(BM_Insert)
+HASH_MAP_BENCH(BM_EraseMix)
@@ -0,0 +1,308 @@
+#include "mapped_vector.hpp"
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <string>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+
+struct Record {
+    int id;
+    double value;
+};
+
+struct Wide {
+    int id;
+    double value;
+    double extra;
+};
+
+struct Tagged {
+    int id;
+    double value;
+};
+template <>
+struct fun::mapped_layout_tag<Tagged> : std::integral_constant<uint64_t, 7> {};
+
+// A fresh path per test, removed again on scope exit
+struct TempFile {
+    std::string path;
+
+    TempFile()
+        : path{::testing::TempDir() + "mapped_vector_" +
+               std::to_string(::getpid()) + "_" +
+               ::testing::UnitTest::GetInstance()->current_test_info()->name()} {}
+    ~TempFile() { std::remove(path.c_str()); }
+};
+
+static fun::vector<Record> make_records(int n) {
+    fun::vector<Record> v;
+    for (int i = 0; i < n; i++) {
+        v.push_back(Record{i, i * 0.5});
+    }
+    return v;
+}
+
+TEST(MappedVectorTests, Ctor) {
+    fun::mapped_vector<int> v;
+    EXPECT_FALSE(v.is_open());
+    EXPECT_EQ(v.size(), 0);
+    EXPECT_TRUE(v.empty());
+    EXPECT_EQ(v.begin(), v.end());
+}
+
+TEST(MappedVectorTests, PersistAndOpen) {
+    TempFile file;
+    const fun::vector<Record> records = make_records(10000);
+    fun::mapped_vector<Record>::persist(file.path, records);
+
+    fun::mapped_vector<Record> v;
+    v.open(file.path);
+    ASSERT_TRUE(v.is_open());
+    EXPECT_EQ(v.mode(), fun::map_mode::read_only);
+    ASSERT_EQ(v.size(), 10000);
+    for (int i = 0; i < 10000; i++) {
+        EXPECT_EQ(v[i].id, i);
+        EXPECT_EQ(v[i].value, i * 0.5);
+    }
+}
+
+TEST(MappedVectorTests, PayloadIsAligned) {
+    TempFile file;
+    fun::mapped_vector<Record>::persist(file.path, make_records(3));
+
+    const fun::mapped_vector<Record> v(file.path);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(v.data()) % alignof(Record), 0);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(v.data()) %
+                  fun::mapped_file_header::payload_alignment,
+              0);
+}
+
+TEST(MappedVectorTests, Empty) {
+    TempFile file;
+    fun::mapped_vector<int>::persist(file.path, fun::vector<int>());
+
+    fun::mapped_vector<int> v(file.path);
+    EXPECT_TRUE(v.is_open());
+    EXPECT_TRUE(v.empty());
+    EXPECT_EQ(v.begin(), v.end());
+}
+
+TEST(MappedVectorTests, Iterate) {
+    TempFile file;
+    fun::mapped_vector<int>::persist(file.path, fun::vector<int>{1, 2, 3, 4});
+
+    fun::mapped_vector<int> v(file.path);
+    int sum = 0;
+    for (int x : v) {
+        sum += x;
+    }
+    EXPECT_EQ(sum, 10);
+}
+
+TEST(MappedVectorTests, At) {
+    TempFile file;
+    fun::mapped_vector<int>::persist(file.path, fun::vector<int>{1, 2, 3});
+
+    fun::mapped_vector<int> v(file.path);
+    const auto& cv = v;
+    EXPECT_EQ(cv.at(2), 3);
+    EXPECT_THROW(cv.at(3), std::out_of_range);
+    const int first = v.at(0);
+    EXPECT_EQ(first, 1);
+    EXPECT_THROW(v.at(3), std::out_of_range);
+}
+
+TEST(MappedVectorTests, ReadOnlyIsConstOnly) {
+    // The read-only map is PROT_READ, so a write mustn't even compile
+    using ReadOnly = fun::mapped_vector<int>;
+    using Cow = fun::mapped_vector<int, fun::map_mode::copy_on_write>;
+    static_assert(std::is_same_v<decltype(std::declval<ReadOnly&>()[0]),
+                                 const int&>);
+    static_assert(std::is_same_v<decltype(std::declval<ReadOnly&>().at(0)),
+                                 const int&>);
+    static_assert(std::is_same_v<decltype(std::declval<ReadOnly&>().data()),
+                                 const int*>);
+    static_assert(std::is_same_v<decltype(std::declval<ReadOnly&>().begin()),
+                                 const int*>);
+    static_assert(std::is_same_v<decltype(std::declval<Cow&>()[0]), int&>);
+    static_assert(ReadOnly::mode() == fun::map_mode::read_only);
+    static_assert(Cow::mode() == fun::map_mode::copy_on_write);
+    SUCCEED();
+}
+
+TEST(MappedVectorTests, CopyOnWriteLeavesFileAlone) {
+    TempFile file;
+    fun::mapped_vector<int>::persist(file.path, fun::vector<int>{1, 2, 3});
+
+    {
+        fun::mapped_vector<int, fun::map_mode::copy_on_write> v(file.path);
+        v[0] = 100;
+        v.at(1) = 200;
+        EXPECT_EQ(v[0], 100);
+        EXPECT_EQ(v[1], 200);
+    }
+
+    fun::mapped_vector<int> v(file.path);
+    EXPECT_EQ(v[0], 1);
+    EXPECT_EQ(v[1], 2);
+}
+
+TEST(MappedVectorTests, PersistModifiedCopy) {
+    TempFile file;
+    TempFile out;
+    out.path += "_out";
+    fun::mapped_vector<int>::persist(file.path, fun::vector<int>{1, 2, 3});
+
+    fun::mapped_vector<int, fun::map_mode::copy_on_write> v(file.path);
+    v[2] = 30;
+    v.persist(out.path);
+
+    fun::mapped_vector<int> reloaded(out.path);
+    ASSERT_EQ(reloaded.size(), 3);
+    EXPECT_EQ(reloaded[2], 30);
+}
+
+TEST(MappedVectorTests, OverwriteWhileMapped) {
+    TempFile file;
+    fun::mapped_vector<int>::persist(file.path, fun::vector<int>{1, 2, 3});
+    fun::mapped_vector<int> old(file.path);
+
+    // persist renames a new file into place, the old mapping keeps the old
+    // contents instead of seeing a torn write
+    fun::mapped_vector<int>::persist(file.path, fun::vector<int>{4, 5});
+    EXPECT_EQ(old.size(), 3);
+    EXPECT_EQ(old[0], 1);
+
+    fun::mapped_vector<int> fresh(file.path);
+    EXPECT_EQ(fresh.size(), 2);
+    EXPECT_EQ(fresh[0], 4);
+}
+
+TEST(MappedVectorTests, ToVector) {
+    TempFile file;
+    fun::mapped_vector<int>::persist(file.path, fun::vector<int>{1, 2, 3});
+
+    fun::mapped_vector<int> v(file.path);
+    fun::vector<int> copy = v.to_vector();
+    copy.push_back(4);
+    EXPECT_EQ(copy.size(), 4);
+    EXPECT_EQ(copy[2], 3);
+}
+
+TEST(MappedVectorTests, MoveCtor) {
+    TempFile file;
+    fun::mapped_vector<int>::persist(file.path, fun::vector<int>{1, 2, 3});
+
+    fun::mapped_vector<int> v1(file.path);
+    const int* data = v1.data();
+    fun::mapped_vector<int> v2(std::move(v1));
+    EXPECT_FALSE(v1.is_open());
+    EXPECT_EQ(v1.size(), 0);
+    EXPECT_EQ(v2.data(), data);
+    EXPECT_EQ(v2[2], 3);
+}
+
+TEST(MappedVectorTests, MoveAssign) {
+    TempFile a;
+    TempFile b;
+    b.path += "_b";
+    fun::mapped_vector<int>::persist(a.path, fun::vector<int>{1, 2, 3});
+    fun::mapped_vector<int>::persist(b.path, fun::vector<int>{4});
+
+    fun::mapped_vector<int> v1(a.path);
+    fun::mapped_vector<int> v2(b.path);
+    v2 = std::move(v1);
+    EXPECT_FALSE(v1.is_open());
+    EXPECT_EQ(v2.size(), 3);
+    EXPECT_EQ(v2[0], 1);
+}
+
+TEST(MappedVectorTests, Reopen) {
+    TempFile a;
+    TempFile b;
+    b.path += "_b";
+    fun::mapped_vector<int>::persist(a.path, fun::vector<int>{1, 2, 3});
+    fun::mapped_vector<int>::persist(b.path, fun::vector<int>{4});
+
+    fun::mapped_vector<int> v(a.path);
+    v.open(b.path);
+    EXPECT_EQ(v.size(), 1);
+    EXPECT_EQ(v[0], 4);
+
+    v.close();
+    EXPECT_FALSE(v.is_open());
+    EXPECT_EQ(v.size(), 0);
+}
+
+TEST(MappedVectorValidationTests, MissingFile) {
+    fun::mapped_vector<int> v;
+    EXPECT_THROW(v.open(::testing::TempDir() + "does_not_exist"),
+                 fun::mapped_file_error);
+    EXPECT_FALSE(v.is_open());
+}
+
+TEST(MappedVectorValidationTests, NotOurFile) {
+    TempFile file;
+    std::ofstream(file.path) << "definitely not a mapped_vector, but long "
+                                "enough to hold a header's worth of bytes";
+
+    fun::mapped_vector<int> v;
+    EXPECT_THROW(v.open(file.path), fun::mapped_file_error);
+}
+
+TEST(MappedVectorValidationTests, TooShortForHeader) {
+    TempFile file;
+    std::ofstream(file.path) << "FUNVEC";
+
+    EXPECT_THROW(fun::mapped_vector<int>{file.path}, fun::mapped_file_error);
+}
+
+TEST(MappedVectorValidationTests, WrongElementSize) {
+    TempFile file;
+    fun::mapped_vector<Record>::persist(file.path, make_records(4));
+
+    EXPECT_THROW(fun::mapped_vector<Wide>{file.path}, fun::mapped_file_error);
+    EXPECT_THROW(fun::mapped_vector<int>{file.path}, fun::mapped_file_error);
+}
+
+TEST(MappedVectorValidationTests, WrongLayoutTag) {
+    TempFile file;
+    fun::mapped_vector<Record>::persist(file.path, make_records(4));
+
+    // Same size and alignment as Record, but declared incompatible
+    EXPECT_THROW(fun::mapped_vector<Tagged>{file.path},
+                 fun::mapped_file_error);
+}
+
+TEST(MappedVectorValidationTests, Truncated) {
+    TempFile file;
+    fun::mapped_vector<Record>::persist(file.path, make_records(100));
+    ASSERT_EQ(::truncate(file.path.c_str(),
+                         fun::mapped_file_header::payload_alignment +
+                             50 * sizeof(Record)),
+              0);
+
+    EXPECT_THROW(fun::mapped_vector<Record>{file.path},
+                 fun::mapped_file_error);
+}
+
+TEST(MappedVectorValidationTests, WrongVersion) {
+    TempFile file;
+    fun::mapped_vector<int>::persist(file.path, fun::vector<int>{1, 2, 3});
+
+    fun::mapped_file_header header;
+    {
+        std::ifstream in(file.path, std::ios::binary);
+        in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    }
+    header.version++;
+    {
+        std::fstream io(file.path,
+                        std::ios::binary | std::ios::in | std::ios::out);
+        io.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    EXPECT_THROW(fun::mapped_vector<int>{file.path}, fun::mapped_file_error);
+}
@@ -0,0 +1,325 @@
+#pragma once
+#include "vector.hpp"
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+
+/*
+    A read-mostly vector whose elements live in a file.
+
+    fun::mapped_vector<Record>::persist("table.bin", records);
+    ...
+    fun::mapped_vector<Record> table;
+    table.open("table.bin");
+        -> mmap()s the file, no parsing and no per-element work, pages come in
+           from the page cache as they're touched
+
+    The mode is part of the type. mapped_vector<T> (read_only) only ever
+    hands out const access, so writing into the PROT_READ mapping doesn't
+    compile. mapped_vector<T, map_mode::copy_on_write> is writable, the
+    writes stay in this process.
+
+    File format (version 1), all native-endian:
+
+    [mapped_file_header][padding up to payload_offset][count * sizeof(T)]
+
+    open() refuses files whose header doesn't match T's size, alignment and
+    layout tag, or whose length doesn't match the header. The payload offset
+    is a multiple of 64, so the mapped elements are correctly aligned.
+*/
+namespace fun {
+
+/*
+    Customization point: bump the tag whenever T's fields change meaning so
+    old files are rejected instead of misread, e.g.
+
+    template <> struct fun::mapped_layout_tag<Record>
+        : std::integral_constant<uint64_t, 2> {};
+*/
+template <typename T>
+struct mapped_layout_tag : std::integral_constant<uint64_t, 0> {};
+
+enum class map_mode {
+    // Shared read-only mapping, writing through it is a segfault
+    read_only,
+    // Private writable mapping, writes never reach the file
+    copy_on_write,
+};
+
+class mapped_file_error : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+struct mapped_file_header {
+    static constexpr char expected_magic[8] = {'F', 'U', 'N', 'V',
+                                               'E', 'C', '\0', '\0'};
+    static constexpr uint32_t current_version = 1;
+    static constexpr uint32_t endian_marker = 0x01020304;
+    static constexpr uint64_t payload_alignment = 64;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t endian;
+    uint64_t elem_size;
+    uint64_t elem_align;
+    uint64_t layout_tag;
+    uint64_t count;
+    uint64_t payload_offset;
+};
+
+template <typename T, map_mode Mode = map_mode::read_only>
+class mapped_vector {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "mapped_vector can only store plain bytes");
+    static_assert(alignof(T) <= mapped_file_header::payload_alignment,
+                  "mapped_vector payload isn't aligned enough for T");
+
+    static constexpr bool writable = Mode == map_mode::copy_on_write;
+
+public:
+    using value_type = T;
+    // Read-only maps only give out const access, even when non-const
+    using pointer = std::conditional_t<writable, T*, const T*>;
+    using reference = std::conditional_t<writable, T&, const T&>;
+    using iterator = pointer;
+    using const_iterator = const T*;
+
+    mapped_vector()
+        : data_{nullptr}, size_{0}, map_base_{nullptr}, map_bytes_{0} {}
+    mapped_vector(const std::string& path) : mapped_vector() { open(path); }
+    ~mapped_vector() { close(); }
+
+    mapped_vector(const mapped_vector&) = delete;
+    mapped_vector& operator=(const mapped_vector&) = delete;
+    mapped_vector(mapped_vector&& other) noexcept
+        : data_{other.data_}, size_{other.size_}, map_base_{other.map_base_},
+          map_bytes_{other.map_bytes_} {
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.map_base_ = nullptr;
+        other.map_bytes_ = 0;
+    }
+    mapped_vector& operator=(mapped_vector&& other) noexcept {
+        if (this != &other) {
+            close();
+
+            data_ = other.data_;
+            size_ = other.size_;
+            map_base_ = other.map_base_;
+            map_bytes_ = other.map_bytes_;
+
+            other.data_ = nullptr;
+            other.size_ = 0;
+            other.map_base_ = nullptr;
+            other.map_bytes_ = 0;
+        }
+
+        return *this;
+    }
+
+    void open(const std::string& path) {
+        close();
+
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw_errno("open", path);
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw_errno("fstat", path);
+        }
+
+        const size_t file_bytes = static_cast<size_t>(st.st_size);
+        if (file_bytes < sizeof(mapped_file_header)) {
+            ::close(fd);
+            throw mapped_file_error(path + ": too small for a header");
+        }
+
+        const int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+        const int flags = writable ? MAP_PRIVATE : MAP_SHARED;
+        void* p = ::mmap(nullptr, file_bytes, prot, flags, fd, 0);
+        // The mapping keeps the file alive on its own
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            throw_errno("mmap", path);
+        }
+
+        mapped_file_header header;
+        std::memcpy(&header, p, sizeof(header));
+        try {
+            validate(header, file_bytes, path);
+        }
+        catch (...) {
+            ::munmap(p, file_bytes);
+            throw;
+        }
+
+        map_base_ = p;
+        map_bytes_ = file_bytes;
+        data_ = reinterpret_cast<T*>(static_cast<char*>(p) +
+                                     header.payload_offset);
+        size_ = header.count;
+    }
+    void close() noexcept {
+        if (map_base_ != nullptr) {
+            ::munmap(map_base_, map_bytes_);
+        }
+
+        data_ = nullptr;
+        size_ = 0;
+        map_base_ = nullptr;
+        map_bytes_ = 0;
+    }
+    bool is_open() const noexcept { return map_base_ != nullptr; }
+    static constexpr map_mode mode() noexcept { return Mode; }
+
+    /*
+        Writes header + payload to path.tmp, fsyncs it and renames it over
+        path, so a reader never maps a half-written file and a crash leaves
+        either the old file or the complete new one.
+    */
+    static void persist(const std::string& path, const T* src, size_t count) {
+        mapped_file_header header{};
+        std::memcpy(header.magic, mapped_file_header::expected_magic,
+                    sizeof(header.magic));
+        header.version = mapped_file_header::current_version;
+        header.endian = mapped_file_header::endian_marker;
+        header.elem_size = sizeof(T);
+        header.elem_align = alignof(T);
+        header.layout_tag = mapped_layout_tag<T>::value;
+        header.count = count;
+        header.payload_offset = mapped_file_header::payload_alignment;
+
+        const std::string tmp = path + ".tmp";
+        FILE* f = std::fopen(tmp.c_str(), "wb");
+        if (f == nullptr) {
+            throw_errno("fopen", tmp);
+        }
+
+        char padding[mapped_file_header::payload_alignment] = {};
+        const size_t pad = header.payload_offset - sizeof(header);
+        const bool ok =
+            std::fwrite(&header, sizeof(header), 1, f) == 1 &&
+            std::fwrite(padding, 1, pad, f) == pad &&
+            (count == 0 || std::fwrite(src, sizeof(T), count, f) == count);
+        // The data has to be on disk before the rename makes it visible
+        const bool synced =
+            ok && std::fflush(f) == 0 && ::fsync(::fileno(f)) == 0;
+        if (std::fclose(f) != 0 || !ok || !synced) {
+            std::remove(tmp.c_str());
+            throw mapped_file_error(tmp +
+                                    (ok ? ": fsync failed" : ": short write"));
+        }
+
+        if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+            std::remove(tmp.c_str());
+            throw_errno("rename", path);
+        }
+    }
+    template <typename Allocator, typename Growth>
+    static void persist(const std::string& path,
+                        const vector<T, Allocator, Growth>& src) {
+        persist(path, src.data(), src.size());
+    }
+    // Writes the current contents, including copy-on-write modifications
+    void persist(const std::string& path) const {
+        persist(path, data_, size_);
+    }
+
+    // Copy into an ordinary, growable vector
+    vector<T> to_vector() const {
+        vector<T> out;
+        out.append(begin(), end());
+        return out;
+    }
+
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    pointer data() noexcept { return data_; }
+    const T* data() const noexcept { return data_; }
+    pointer begin() noexcept { return data_; }
+    const T* begin() const noexcept { return data_; }
+    pointer end() noexcept { return data_ + size_; }
+    const T* end() const noexcept { return data_ + size_; }
+
+    reference operator[](size_t idx) { return data_[idx]; }
+    const T& operator[](size_t idx) const { return data_[idx]; }
+
+    reference at(size_t idx) {
+        if (idx >= size_) {
+            throw std::out_of_range("Value accessed out of range!");
+        }
+
+        return data_[idx];
+    }
+    const T& at(size_t idx) const {
+        if (idx >= size_) {
+            throw std::out_of_range("Value accessed out of range!");
+        }
+
+        return data_[idx];
+    }
+
+private:
+    T* data_;
+    size_t size_;
+    void* map_base_;
+    size_t map_bytes_;
+
+    [[noreturn]] static void throw_errno(const char* what,
+                                         const std::string& path) {
+        throw mapped_file_error(path + ": " + what + " failed: " +
+                                std::strerror(errno));
+    }
+
+    static void validate(const mapped_file_header& header, size_t file_bytes,
+                         const std::string& path) {
+        if (std::memcmp(header.magic, mapped_file_header::expected_magic,
+                        sizeof(header.magic)) != 0) {
+            throw mapped_file_error(path + ": not a mapped_vector file");
+        }
+        if (header.version != mapped_file_header::current_version) {
+            throw mapped_file_error(path + ": unsupported version " +
+                                    std::to_string(header.version));
+        }
+        if (header.endian != mapped_file_header::endian_marker) {
+            throw mapped_file_error(path + ": written with other endianness");
+        }
+        if (header.elem_size != sizeof(T) || header.elem_align != alignof(T)) {
+            throw mapped_file_error(
+                path + ": element is " + std::to_string(header.elem_size) +
+                " bytes/align " + std::to_string(header.elem_align) +
+                ", expected " + std::to_string(sizeof(T)) + "/" +
+                std::to_string(alignof(T)));
+        }
+        if (header.layout_tag != mapped_layout_tag<T>::value) {
+            throw mapped_file_error(path + ": layout tag mismatch");
+        }
+        if (header.payload_offset < sizeof(mapped_file_header) ||
+            header.payload_offset % alignof(T) != 0) {
+            throw mapped_file_error(path + ": misaligned payload");
+        }
+
+        // offset + count * size == file_bytes, without overflowing on junk
+        if (header.payload_offset > file_bytes ||
+            (file_bytes - header.payload_offset) % sizeof(T) != 0 ||
+            (file_bytes - header.payload_offset) / sizeof(T) != header.count) {
+            throw mapped_file_error(path + ": size doesn't match header");
+        }
+    }
+};
+
+}; // namespace fun
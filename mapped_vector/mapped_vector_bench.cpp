@@ -0,0 +1,102 @@
+#include "mapped_vector.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+
+/*
+    Startup cost of getting a big table back into memory:
+
+    Rebuild:   read the raw records back and push_back them one by one, what a
+               loader that parses its input file ends up doing
+    Open:      mapped_vector::open, i.e. validating a header and one mmap
+    OpenScan:  open plus touching every element, so the page-in cost is paid
+               too (from the page cache, the file was just written)
+*/
+struct Record {
+    long id;
+    double a, b, c;
+};
+
+static std::string table_path(size_t n) {
+    return "/tmp/mapped_vector_bench_" + std::to_string(::getpid()) + "_" +
+           std::to_string(n);
+}
+
+// One table on disk at a time, removed when the process exits
+struct Table {
+    std::string path;
+    size_t written = 0;
+
+    ~Table() {
+        if (!path.empty()) {
+            std::remove(path.c_str());
+        }
+    }
+};
+
+static const std::string& ensure_table(size_t n) {
+    static Table table;
+    std::string& path = table.path;
+    if (table.written != n) {
+        if (!path.empty()) {
+            std::remove(path.c_str());
+        }
+        path = table_path(n);
+
+        fun::vector<Record> records;
+        records.reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            records.push_back(Record{static_cast<long>(i), 1.0, 2.0, 3.0});
+        }
+        fun::mapped_vector<Record>::persist(path, records);
+        table.written = n;
+    }
+    return path;
+}
+
+static void BM_Rebuild(benchmark::State& state) {
+    const std::string& path = ensure_table(state.range(0));
+
+    for (auto _ : state) {
+        FILE* f = std::fopen(path.c_str(), "rb");
+        std::fseek(f, fun::mapped_file_header::payload_alignment, SEEK_SET);
+
+        fun::vector<Record> v;
+        Record r;
+        while (std::fread(&r, sizeof(r), 1, f) == 1) {
+            v.push_back(r);
+        }
+        std::fclose(f);
+        benchmark::DoNotOptimize(v.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_Open(benchmark::State& state) {
+    const std::string& path = ensure_table(state.range(0));
+
+    for (auto _ : state) {
+        fun::mapped_vector<Record> v(path);
+        benchmark::DoNotOptimize(v.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_OpenScan(benchmark::State& state) {
+    const std::string& path = ensure_table(state.range(0));
+
+    for (auto _ : state) {
+        fun::mapped_vector<Record> v(path);
+        long sum = 0;
+        for (const Record& r : v) {
+            sum += r.id;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_Rebuild)->Range(1 << 12, 1 << 22)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Open)->Range(1 << 12, 1 << 22)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_OpenScan)->Range(1 << 12, 1 << 22)->Unit(benchmark::kMicrosecond);
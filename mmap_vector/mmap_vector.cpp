@@ -0,0 +1,159 @@
+#include "mmap_vector.hpp"
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+struct Record {
+    int id;
+    double value;
+};
+
+TEST(MmapVectorTests, Ctor) {
+    fun::mmap_vector<int> v;
+    EXPECT_EQ(v.size(), 0);
+    EXPECT_EQ(v.capacity(), 0);
+    EXPECT_EQ(v.mapped_bytes(), 0);
+}
+
+TEST(MmapVectorTests, PushBackGrows) {
+    fun::mmap_vector<int> v;
+    for (int i = 0; i < 1000000; i++) {
+        v.push_back(i);
+    }
+
+    EXPECT_EQ(v.size(), 1000000);
+    EXPECT_GE(v.capacity(), 1000000);
+    EXPECT_EQ(v.mapped_bytes() % sysconf(_SC_PAGESIZE), 0);
+    for (int i = 0; i < 1000000; i += 997) {
+        EXPECT_EQ(v[i], i);
+    }
+}
+
+TEST(MmapVectorTests, FirstPageHoldsManyElements) {
+    fun::mmap_vector<int> v;
+    v.push_back(1);
+
+    // The smallest mapping is one page, all of it usable
+    EXPECT_EQ(v.capacity(), sysconf(_SC_PAGESIZE) / sizeof(int));
+}
+
+TEST(MmapVectorTests, EmplaceBack) {
+    fun::mmap_vector<Record> v;
+    Record& r = v.emplace_back(Record{7, 1.5});
+    EXPECT_EQ(r.id, 7);
+    EXPECT_EQ(v[0].value, 1.5);
+}
+
+TEST(MmapVectorTests, PushBackSelfReference) {
+    fun::mmap_vector<int> v;
+    v.resize(v.capacity() + 1);
+    v.resize(v.capacity());
+    v[0] = 42;
+
+    // Full, so this push_back remaps while holding a reference into the map
+    v.push_back(v[0]);
+    EXPECT_EQ(v[v.size() - 1], 42);
+}
+
+TEST(MmapVectorTests, ReservedAddressSpaceIsStable) {
+    fun::mmap_vector<int> v{fun::reserve_address_space, 1 << 24};
+    EXPECT_EQ(v.capacity(), 0);
+    EXPECT_GE(v.reserved_bytes(), (1u << 24) * sizeof(int));
+
+    v.push_back(0);
+    const int* first = v.data();
+    for (int i = 1; i < (1 << 20); i++) {
+        v.push_back(i);
+    }
+
+    // Growth only committed more of the reservation, nothing moved
+    EXPECT_EQ(v.data(), first);
+    EXPECT_EQ(v[(1 << 20) - 1], (1 << 20) - 1);
+}
+
+TEST(MmapVectorTests, ReservedAddressSpaceExhausted) {
+    const size_t page_ints = sysconf(_SC_PAGESIZE) / sizeof(int);
+    fun::mmap_vector<int> v{fun::reserve_address_space, page_ints};
+
+    for (size_t i = 0; i < page_ints; i++) {
+        v.push_back(static_cast<int>(i));
+    }
+    EXPECT_THROW(v.push_back(0), std::length_error);
+    EXPECT_EQ(v.size(), page_ints);
+}
+
+TEST(MmapVectorTests, Resize) {
+    fun::mmap_vector<Record> v;
+    v.resize(10000);
+    EXPECT_EQ(v.size(), 10000);
+    EXPECT_EQ(v[9999].id, 0);
+
+    v.resize(3);
+    EXPECT_EQ(v.size(), 3);
+}
+
+TEST(MmapVectorTests, ShrinkToFit) {
+    fun::mmap_vector<int> v;
+    v.resize(1 << 20);
+    v.resize(10);
+
+    v.shrink_to_fit();
+    EXPECT_EQ(v.mapped_bytes(), sysconf(_SC_PAGESIZE));
+    EXPECT_EQ(v.size(), 10);
+
+    v.clear();
+    v.shrink_to_fit();
+    EXPECT_EQ(v.capacity(), 0);
+    v.push_back(5);
+    EXPECT_EQ(v[0], 5);
+}
+
+TEST(MmapVectorTests, ShrinkReserved) {
+    fun::mmap_vector<int> v{fun::reserve_address_space, 1 << 20};
+    v.resize(1 << 20);
+    v.resize(1);
+    v.shrink_to_fit();
+
+    // Still inside the same reservation, and able to grow back
+    EXPECT_EQ(v.mapped_bytes(), sysconf(_SC_PAGESIZE));
+    v.resize(1 << 20);
+    EXPECT_EQ(v[(1 << 20) - 1], 0);
+}
+
+TEST(MmapVectorTests, HugePages) {
+    fun::mmap_vector<int> v{true};
+    for (int i = 0; i < (1 << 20); i++) {
+        v.push_back(i);
+    }
+    EXPECT_EQ(v[12345], 12345);
+}
+
+TEST(MmapVectorTests, MoveCtor) {
+    fun::mmap_vector<int> v;
+    v.push_back(1);
+    v.push_back(2);
+
+    fun::mmap_vector<int> v2(std::move(v));
+    EXPECT_EQ(v2.size(), 2);
+    EXPECT_EQ(v2[1], 2);
+    EXPECT_EQ(v.size(), 0);
+    EXPECT_EQ(v.data(), nullptr);
+}
+
+TEST(MmapVectorTests, MoveAssign) {
+    fun::mmap_vector<int> v{fun::reserve_address_space, 1024};
+    v.push_back(3);
+    fun::mmap_vector<int> v2;
+    v2.push_back(4);
+
+    v2 = std::move(v);
+    EXPECT_EQ(v2[0], 3);
+    EXPECT_GT(v2.reserved_bytes(), 0);
+    EXPECT_EQ(v.reserved_bytes(), 0);
+}
+
+TEST(MmapVectorTests, ElementAccessAt) {
+    fun::mmap_vector<int> v;
+    v.push_back(1);
+    EXPECT_EQ(v.at(0), 1);
+    EXPECT_THROW(v.at(1), std::out_of_range);
+}
@@ -0,0 +1,275 @@
+#pragma once
+#include "vector.hpp"
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <utility>
+
+/*
+    fun::mmap_vector<Record> v;
+        -> the buffer is an anonymous mapping, pages are only committed once
+           they're touched
+        -> growing mremap()s the mapping, the kernel moves page table entries
+           instead of us copying elements, so growing a multi-GB vector is
+           O(pages) bookkeeping and peak memory stays ~1x, not 3x
+
+    fun::mmap_vector<Record> v{fun::reserve_address_space, 1ull << 34};
+        -> reserves the whole address range up front (PROT_NONE, no memory
+           behind it) and commits it with mprotect as it grows, so data()
+           never moves and pointers into it stay valid
+
+    Only for trivially relocatable T, the kernel moves bytes around without
+    asking. Linux only (mremap, MAP_NORESERVE, MADV_HUGEPAGE).
+*/
+namespace fun {
+
+struct reserve_address_space_t {
+    explicit reserve_address_space_t() = default;
+};
+inline constexpr reserve_address_space_t reserve_address_space{};
+
+template <typename T> class mmap_vector {
+    static_assert(is_trivially_relocatable_v<T>,
+                  "mmap_vector moves pages around, T must be relocatable");
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    // huge_pages asks for transparent huge pages on everything we map
+    explicit mmap_vector(bool huge_pages = false)
+        : data_{nullptr}, size_{0}, capacity_{0}, mapped_bytes_{0},
+          reserved_bytes_{0}, huge_pages_{huge_pages} {}
+    mmap_vector(reserve_address_space_t, size_t max_capacity,
+                bool huge_pages = false)
+        : mmap_vector(huge_pages) {
+        reserved_bytes_ = page_round(max_capacity * sizeof(T));
+        void* p = ::mmap(nullptr, reserved_bytes_, PROT_NONE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        data_ = static_cast<T*>(p);
+    }
+    ~mmap_vector() {
+        clear();
+        unmap();
+    }
+
+    // Deep copies of multi-GB buffers should be explicit, not accidental
+    mmap_vector(const mmap_vector&) = delete;
+    mmap_vector& operator=(const mmap_vector&) = delete;
+    mmap_vector(mmap_vector&& other) noexcept
+        : data_{other.data_}, size_{other.size_}, capacity_{other.capacity_},
+          mapped_bytes_{other.mapped_bytes_},
+          reserved_bytes_{other.reserved_bytes_},
+          huge_pages_{other.huge_pages_} {
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.capacity_ = 0;
+        other.mapped_bytes_ = 0;
+        other.reserved_bytes_ = 0;
+    }
+    mmap_vector& operator=(mmap_vector&& other) noexcept {
+        if (this != &other) {
+            clear();
+            unmap();
+
+            data_ = other.data_;
+            size_ = other.size_;
+            capacity_ = other.capacity_;
+            mapped_bytes_ = other.mapped_bytes_;
+            reserved_bytes_ = other.reserved_bytes_;
+            huge_pages_ = other.huge_pages_;
+
+            other.data_ = nullptr;
+            other.size_ = 0;
+            other.capacity_ = 0;
+            other.mapped_bytes_ = 0;
+            other.reserved_bytes_ = 0;
+        }
+
+        return *this;
+    }
+
+    void push_back(const T& val) { emplace_back(val); }
+    template <typename... Args> T& emplace_back(Args&&... args) {
+        if (size_ == capacity_) {
+            // val may live in our mapping, which mremap can move
+            T copy(std::forward<Args>(args)...);
+            grow_for(size_ + 1);
+            return *new (data_ + size_++) T(std::move(copy));
+        }
+
+        return *new (data_ + size_++) T(std::forward<Args>(args)...);
+    }
+    void clear() {
+        detail::destroy_arr_elements(data_, size_);
+        size_ = 0;
+    }
+    void reserve(size_t new_capacity) {
+        if (new_capacity > capacity_) {
+            map_bytes(page_round(new_capacity * sizeof(T)));
+        }
+    }
+    // New elements are value-initialized, same as fun::vector::resize
+    void resize(size_t count) {
+        if (count <= size_) {
+            detail::destroy_arr_elements(data_ + count, size_ - count);
+            size_ = count;
+            return;
+        }
+
+        if (count > capacity_) {
+            grow_for(count);
+        }
+        for (size_t i = size_; i < count; i++) {
+            new (data_ + i) T();
+        }
+        size_ = count;
+    }
+    // Hands the unused pages back to the kernel
+    void shrink_to_fit() {
+        const size_t needed = page_round(size_ * sizeof(T));
+        if (needed >= mapped_bytes_) {
+            return;
+        }
+
+        char* base = reinterpret_cast<char*>(data_);
+        if (reserved_bytes_ > 0) {
+            // Keep the reservation, just decommit the tail
+            ::madvise(base + needed, mapped_bytes_ - needed, MADV_DONTNEED);
+            ::mprotect(base + needed, mapped_bytes_ - needed, PROT_NONE);
+        }
+        else if (needed == 0) {
+            unmap();
+        }
+        else {
+            void* p = ::mremap(base, mapped_bytes_, needed, 0);
+            if (p == MAP_FAILED) {
+                return;
+            }
+        }
+
+        mapped_bytes_ = needed;
+        capacity_ = needed / sizeof(T);
+    }
+
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+    [[nodiscard]] size_t capacity() const noexcept { return capacity_; }
+    bool empty() const noexcept { return size_ == 0; }
+    // Bytes of address space currently readable/writable (committed lazily)
+    size_t mapped_bytes() const noexcept { return mapped_bytes_; }
+    // 0 unless constructed with reserve_address_space
+    size_t reserved_bytes() const noexcept { return reserved_bytes_; }
+
+    T* data() noexcept { return data_; }
+    const T* data() const noexcept { return data_; }
+    T* begin() noexcept { return data_; }
+    const T* begin() const noexcept { return data_; }
+    T* end() noexcept { return data_ + size_; }
+    const T* end() const noexcept { return data_ + size_; }
+
+    T& operator[](size_t idx) { return data_[idx]; }
+    const T& operator[](size_t idx) const { return data_[idx]; }
+
+    T& at(size_t idx) {
+        if (idx >= size_) {
+            throw std::out_of_range("Value accessed out of range!");
+        }
+
+        return data_[idx];
+    }
+    const T& at(size_t idx) const {
+        if (idx >= size_) {
+            throw std::out_of_range("Value accessed out of range!");
+        }
+
+        return data_[idx];
+    }
+
+private:
+    T* data_;
+    size_t size_;
+    size_t capacity_;
+    size_t mapped_bytes_;
+    size_t reserved_bytes_;
+    bool huge_pages_;
+
+    static size_t page_size() {
+        static const size_t size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        return size;
+    }
+    static size_t page_round(size_t bytes) {
+        const size_t page = page_size();
+        return (bytes + page - 1) & ~(page - 1);
+    }
+
+    // Doubling like fun::vector, except a regrow costs no element copies
+    void grow_for(size_t required) {
+        const size_t doubled = mapped_bytes_ * 2;
+        const size_t needed = page_round(required * sizeof(T));
+        size_t bytes = doubled > needed ? doubled : needed;
+
+        // Don't double past the reservation if what we need still fits
+        if (reserved_bytes_ > 0 && bytes > reserved_bytes_ &&
+            needed <= reserved_bytes_) {
+            bytes = reserved_bytes_;
+        }
+        map_bytes(bytes);
+    }
+
+    void map_bytes(size_t bytes) {
+        char* base = reinterpret_cast<char*>(data_);
+        if (reserved_bytes_ > 0) {
+            if (bytes > reserved_bytes_) {
+                throw std::length_error(
+                    "mmap_vector grew past its reserved address space!");
+            }
+            if (::mprotect(base + mapped_bytes_, bytes - mapped_bytes_,
+                           PROT_READ | PROT_WRITE) != 0) {
+                throw std::bad_alloc();
+            }
+            advise(base + mapped_bytes_, bytes - mapped_bytes_);
+        }
+        else {
+            void* p = data_ == nullptr
+                          ? ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)
+                          : ::mremap(base, mapped_bytes_, bytes, MREMAP_MAYMOVE);
+            if (p == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            data_ = static_cast<T*>(p);
+            advise(reinterpret_cast<char*>(p), bytes);
+        }
+
+        mapped_bytes_ = bytes;
+        capacity_ = bytes / sizeof(T);
+    }
+
+    void advise(char* p, size_t bytes) {
+        if (huge_pages_ && bytes > 0) {
+            // Only a hint, the kernel is free to ignore it
+            ::madvise(p, bytes, MADV_HUGEPAGE);
+        }
+    }
+
+    void unmap() {
+        const size_t bytes = reserved_bytes_ > 0 ? reserved_bytes_
+                                                 : mapped_bytes_;
+        if (data_ != nullptr && bytes > 0) {
+            ::munmap(data_, bytes);
+        }
+
+        data_ = nullptr;
+        capacity_ = 0;
+        mapped_bytes_ = 0;
+        reserved_bytes_ = 0;
+    }
+};
+
+}; // namespace fun
@@ -0,0 +1,71 @@
+#include "mmap_vector.hpp"
+#include "peak_rss.hpp"
+#include <benchmark/benchmark.h>
+#include <chrono>
+
+/*
+    Growing a big vector of records from empty, reporting
+
+    worst_regrow_ms: the slowest single push_back, i.e. the last regrow
+    peak_rss_kb:     high-water mark of the run (fun::vector briefly holds the
+                     old and the new buffer, ~3x the final payload)
+*/
+struct Record {
+    long id;
+    double a, b, c;
+};
+
+template <typename Vec> static void BM_BigGrowth(benchmark::State& state) {
+    const size_t n = state.range(0);
+    double worst_ms = 0;
+    size_t peak_kb = 0;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        fun::reset_peak_rss();
+        worst_ms = 0;
+        state.ResumeTiming();
+
+        Vec v;
+        for (size_t i = 0; i < n; i++) {
+            const bool regrows = v.size() == v.capacity();
+            if (regrows) {
+                const auto start = std::chrono::steady_clock::now();
+                v.push_back(Record{static_cast<long>(i), 0, 0, 0});
+                const std::chrono::duration<double, std::milli> took =
+                    std::chrono::steady_clock::now() - start;
+                worst_ms = took.count() > worst_ms ? took.count() : worst_ms;
+            }
+            else {
+                v.push_back(Record{static_cast<long>(i), 0, 0, 0});
+            }
+        }
+        benchmark::DoNotOptimize(v.data());
+
+        state.PauseTiming();
+        peak_kb = fun::peak_rss_kb();
+        state.ResumeTiming();
+    }
+
+    state.counters["worst_regrow_ms"] = worst_ms;
+    state.counters["peak_rss_kb"] = peak_kb;
+    state.SetBytesProcessed(state.iterations() * n * sizeof(Record));
+}
+BENCHMARK_TEMPLATE(BM_BigGrowth, fun::vector<Record>)
+    ->RangeMultiplier(4)
+    ->Range(1 << 16, 1 << 24)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_BigGrowth, fun::mmap_vector<Record>)
+    ->RangeMultiplier(4)
+    ->Range(1 << 16, 1 << 24)
+    ->Unit(benchmark::kMillisecond);
+
+// Reserved mode: no remaps at all, just mprotect on the committed tail
+struct ReservedRecords : fun::mmap_vector<Record> {
+    ReservedRecords()
+        : fun::mmap_vector<Record>(fun::reserve_address_space, 1 << 26) {}
+};
+BENCHMARK_TEMPLATE(BM_BigGrowth, ReservedRecords)
+    ->RangeMultiplier(4)
+    ->Range(1 << 16, 1 << 24)
+    ->Unit(benchmark::kMillisecond);
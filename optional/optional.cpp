@@ -2,6 +2,8 @@
 #include <gtest/gtest.h>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <utility>
 
 TEST(OptionalTests, DefaultCtor) {
     fun::optional<float> maybe_float;
@@ -93,3 +95,188 @@ TEST(OptionalTests, BoolConversion) {
         FAIL() << "Full optional evaluated to false";
     }
 }
+
+// Deliberately no default ctor, and counts how many are alive
+struct Tracked {
+    static inline int alive = 0;
+    static inline int constructed = 0;
+
+    int id;
+
+    explicit Tracked(int id) : id{id} {
+        alive++;
+        constructed++;
+    }
+    Tracked(const Tracked& other) : id{other.id} {
+        alive++;
+        constructed++;
+    }
+    Tracked(Tracked&& other) noexcept : id{other.id} {
+        alive++;
+        constructed++;
+    }
+    Tracked& operator=(const Tracked&) = default;
+    Tracked& operator=(Tracked&&) = default;
+    ~Tracked() { alive--; }
+
+    static void reset_counts() {
+        alive = 0;
+        constructed = 0;
+    }
+};
+
+struct Pinned {
+    int value;
+
+    explicit Pinned(int value) : value{value} {}
+    Pinned(const Pinned&) = delete;
+    Pinned& operator=(const Pinned&) = delete;
+};
+
+enum class Slot : int {};
+
+template <> struct fun::optional_traits<double> : fun::nan_niche<double> {};
+template <>
+struct fun::optional_traits<Slot> : fun::sentinel_niche<Slot, Slot{-1}> {};
+
+TEST(OptionalStorageTests, EmptyConstructsNothing) {
+    Tracked::reset_counts();
+    {
+        fun::optional<Tracked> maybe;
+        EXPECT_FALSE(maybe.has_value());
+        EXPECT_EQ(Tracked::constructed, 0);
+    }
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(OptionalStorageTests, DestroysEngagedValue) {
+    Tracked::reset_counts();
+    {
+        fun::optional<Tracked> maybe{Tracked{1}};
+        EXPECT_EQ(Tracked::alive, 1);
+        EXPECT_EQ(maybe->id, 1);
+    }
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(OptionalStorageTests, CopyAndAssignKeepCountsBalanced) {
+    Tracked::reset_counts();
+    {
+        fun::optional<Tracked> a{Tracked{1}};
+        fun::optional<Tracked> b{a};
+        fun::optional<Tracked> c;
+        EXPECT_EQ(Tracked::alive, 2);
+
+        c = a;
+        EXPECT_EQ(Tracked::alive, 3);
+        a = fun::optional<Tracked>{};
+        EXPECT_FALSE(a.has_value());
+        EXPECT_EQ(Tracked::alive, 2);
+        b = std::move(c);
+        EXPECT_EQ(b->id, 1);
+    }
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(OptionalStorageTests, EmplaceAndReset) {
+    Tracked::reset_counts();
+    fun::optional<Tracked> maybe;
+
+    maybe.emplace(5);
+    EXPECT_EQ(maybe->id, 5);
+    EXPECT_EQ(Tracked::constructed, 1);
+
+    maybe.emplace(6);
+    EXPECT_EQ(maybe->id, 6);
+    EXPECT_EQ(Tracked::alive, 1);
+
+    maybe.reset();
+    EXPECT_FALSE(maybe.has_value());
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(OptionalStorageTests, InPlaceForPinnedTypes) {
+    fun::optional<Pinned> maybe{std::in_place, 7};
+    EXPECT_EQ(maybe->value, 7);
+    EXPECT_FALSE(std::is_copy_constructible_v<fun::optional<Pinned>>);
+}
+
+TEST(OptionalStorageTests, ValueOr) {
+    const fun::optional<int> empty;
+    const fun::optional<int> full{3};
+    EXPECT_EQ(empty.value_or(9), 9);
+    EXPECT_EQ(full.value_or(9), 3);
+    EXPECT_EQ(full.value(), 3);
+}
+
+TEST(OptionalStorageTests, TrivialityFollowsT) {
+    static_assert(std::is_trivially_copyable_v<fun::optional<int>>);
+    static_assert(std::is_trivially_destructible_v<fun::optional<int>>);
+    static_assert(std::is_trivially_copyable_v<fun::optional<float>>);
+
+    static_assert(!std::is_trivially_copyable_v<fun::optional<std::string>>);
+    static_assert(!std::is_trivially_destructible_v<fun::optional<Tracked>>);
+    static_assert(std::is_nothrow_move_constructible_v<fun::optional<Tracked>>);
+    SUCCEED();
+}
+
+TEST(OptionalNicheTests, PointerIsPacked) {
+    static_assert(sizeof(fun::optional<int*>) == sizeof(int*));
+    static_assert(sizeof(fun::optional<const char*>) == sizeof(const char*));
+    static_assert(std::is_trivially_copyable_v<fun::optional<int*>>);
+
+    int x = 3;
+    fun::optional<int*> empty;
+    fun::optional<int*> full{&x};
+    EXPECT_FALSE(empty.has_value());
+    EXPECT_TRUE(full.has_value());
+    EXPECT_EQ(**full, 3);
+
+    full.reset();
+    EXPECT_FALSE(full.has_value());
+}
+
+TEST(OptionalNicheTests, NullptrIsStillAValue) {
+    fun::optional<int*> null_ptr{nullptr};
+    EXPECT_TRUE(null_ptr.has_value());
+    EXPECT_EQ(*null_ptr, nullptr);
+}
+
+TEST(OptionalNicheTests, NanSentinel) {
+    static_assert(sizeof(fun::optional<double>) == sizeof(double));
+
+    fun::optional<double> empty;
+    fun::optional<double> full{2.5};
+    EXPECT_FALSE(empty.has_value());
+    EXPECT_EQ(*full, 2.5);
+
+    empty = full;
+    EXPECT_TRUE(empty.has_value());
+    full = fun::optional<double>{};
+    EXPECT_FALSE(full.has_value());
+}
+
+TEST(OptionalNicheTests, ValueSentinel) {
+    static_assert(sizeof(fun::optional<Slot>) == sizeof(Slot));
+
+    fun::optional<Slot> empty;
+    fun::optional<Slot> zero{Slot{0}};
+    EXPECT_FALSE(empty.has_value());
+    EXPECT_TRUE(zero.has_value());
+    EXPECT_EQ(static_cast<int>(*zero), 0);
+    EXPECT_THROW(empty.value(), std::logic_error);
+}
+
+TEST(OptionalNicheTests, DenseArrays) {
+    // No bool + padding per element
+    fun::optional<int*> arr[16];
+    static_assert(sizeof(arr) == 16 * sizeof(int*));
+
+    int x = 1;
+    arr[3] = &x;
+    int engaged = 0;
+    for (const auto& maybe : arr) {
+        engaged += maybe.has_value();
+    }
+    EXPECT_EQ(engaged, 1);
+}
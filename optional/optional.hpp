@@ -1,57 +1,345 @@
+#pragma once
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <new>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
 
 /*
     fun::optional<Dog> dog;
-        -> has_value_ should be false
-        -> the obj_ technically will be initialized, which is bad but 
-           room for improvement
+        -> has_value() is false, and no Dog was constructed, the storage is a
+           union that only gets a Dog once something is assigned/emplaced
+        -> Dog doesn't even need a default constructor
+
+    Copy/move/destroy are trivial whenever T's are, so optional<int> and
+    friends are trivially copyable and fun::vector relocates them with memcpy.
+
+    fun::optional<Dog*> ptr;
+        -> sizeof(ptr) == sizeof(Dog*), "empty" is a sentinel pointer value
+           instead of a separate bool (see fun::optional_traits below)
 */
 namespace fun {
-template <typename T> class optional {
-public:
-    optional() : obj_{}, has_value_{false} {}
-    optional(T obj) : obj_{obj}, has_value_{true} {}
-    optional(const optional& other)
-        : obj_{other.obj_}, has_value_{other.has_value_} {}
-    optional& operator=(const optional& other) {
-        if (this != &other) {
-            obj_ = other.obj_;
-            has_value_ = other.has_value_;
+
+/*
+    Niche hook. A specialization with has_niche = true says some value of T
+    is never used, so optional<T> can store that value to mean "empty" and
+    drop its bool:
+
+    static T empty_value() noexcept;    // the sentinel
+    static bool is_empty(const T&);     // true for the sentinel
+
+    Only for trivially copyable T, and an engaged optional must never hold the
+    sentinel itself (it would read back as empty). Pointers have one built in,
+    nan_niche/sentinel_niche cover the usual "NaN/-1 means nothing" cases:
+
+    template <> struct fun::optional_traits<double> : fun::nan_niche<double> {};
+    template <> struct fun::optional_traits<Slot>
+        : fun::sentinel_niche<Slot, Slot{-1}> {};
+*/
+template <typename T> struct optional_traits {
+    static constexpr bool has_niche = false;
+};
+
+// All-ones is never the address of a real object (and is misaligned for
+// anything wider than a byte), so nullptr stays a valid engaged value
+template <typename T> struct optional_traits<T*> {
+    static constexpr bool has_niche = true;
+
+    static T* empty_value() noexcept {
+        return reinterpret_cast<T*>(~uintptr_t{0});
+    }
+    static bool is_empty(T* p) noexcept {
+        return reinterpret_cast<uintptr_t>(p) == ~uintptr_t{0};
+    }
+};
+
+// Any NaN means empty, so an engaged optional can't hold a NaN
+template <typename T> struct nan_niche {
+    static_assert(std::is_floating_point_v<T>, "nan_niche needs a float type");
+    static constexpr bool has_niche = true;
+
+    static T empty_value() noexcept {
+        return std::numeric_limits<T>::quiet_NaN();
+    }
+    static bool is_empty(T v) noexcept { return std::isnan(v); }
+};
+
+template <typename T, T Sentinel> struct sentinel_niche {
+    static constexpr bool has_niche = true;
+
+    static constexpr T empty_value() noexcept { return Sentinel; }
+    static constexpr bool is_empty(T v) noexcept { return v == Sentinel; }
+};
+
+namespace detail {
+/*
+    optional<T> is built from layers so every special member stays trivial
+    when T's is (C++17 can't conditionally default them directly):
+
+    storage -> copy ctor -> move ctor -> copy assign -> move assign
+
+    Each layer only writes its member out by hand when T's isn't trivial.
+*/
+
+// A union so nothing is constructed until engaged, plus the flag
+template <typename T, bool = std::is_trivially_destructible_v<T>>
+struct optional_flag_storage {
+    union {
+        char empty_;
+        T obj_;
+    };
+    bool has_value_;
+
+    optional_flag_storage() noexcept : empty_{}, has_value_{false} {}
+    template <typename... Args>
+    explicit optional_flag_storage(std::in_place_t, Args&&... args)
+        : obj_(std::forward<Args>(args)...), has_value_{true} {}
+
+    bool engaged() const noexcept { return has_value_; }
+    template <typename... Args> void construct(Args&&... args) {
+        new (&obj_) T(std::forward<Args>(args)...);
+        has_value_ = true;
+    }
+    void reset() noexcept { has_value_ = false; }
+};
+template <typename T> struct optional_flag_storage<T, false> {
+    union {
+        char empty_;
+        T obj_;
+    };
+    bool has_value_;
+
+    optional_flag_storage() noexcept : empty_{}, has_value_{false} {}
+    template <typename... Args>
+    explicit optional_flag_storage(std::in_place_t, Args&&... args)
+        : obj_(std::forward<Args>(args)...), has_value_{true} {}
+    ~optional_flag_storage() { reset(); }
+
+    bool engaged() const noexcept { return has_value_; }
+    template <typename... Args> void construct(Args&&... args) {
+        new (&obj_) T(std::forward<Args>(args)...);
+        has_value_ = true;
+    }
+    void reset() noexcept {
+        if (has_value_) {
+            obj_.~T();
+            has_value_ = false;
         }
+    }
+};
 
-        return *this;
+// No flag, obj_ always holds either a value or the sentinel
+template <typename T> struct optional_niche_storage {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "optional_traits niches are only for trivially copyable T");
+    using traits = optional_traits<T>;
+
+    T obj_;
+
+    optional_niche_storage() noexcept : obj_(traits::empty_value()) {}
+    template <typename... Args>
+    explicit optional_niche_storage(std::in_place_t, Args&&... args)
+        : obj_(std::forward<Args>(args)...) {
+        assert(!traits::is_empty(obj_) && "engaged with the niche sentinel!");
+    }
+
+    bool engaged() const noexcept { return !traits::is_empty(obj_); }
+    template <typename... Args> void construct(Args&&... args) {
+        obj_ = T(std::forward<Args>(args)...);
+        assert(!traits::is_empty(obj_) && "engaged with the niche sentinel!");
     }
-    optional(optional&& other)
-        : obj_{std::move(other.obj_)}, has_value_{other.has_value_} {
-        other.has_value_ = false;
+    void reset() noexcept { obj_ = traits::empty_value(); }
+};
+
+template <typename T>
+using optional_storage =
+    std::conditional_t<optional_traits<T>::has_niche,
+                       optional_niche_storage<T>, optional_flag_storage<T>>;
+
+template <typename T, typename Base,
+          bool = std::is_trivially_copy_constructible_v<T>>
+struct optional_copy_ctor : Base {
+    using Base::Base;
+};
+template <typename T, typename Base>
+struct optional_copy_ctor<T, Base, false> : Base {
+    using Base::Base;
+
+    optional_copy_ctor() = default;
+    optional_copy_ctor(const optional_copy_ctor& other) : Base() {
+        if (other.engaged()) {
+            this->construct(other.obj_);
+        }
     }
-    optional& operator=(optional&& other) {
-        if (this != &other) {
-            obj_ = std::move(other.obj_);
-            has_value_ = other.has_value_;
+    optional_copy_ctor(optional_copy_ctor&&) = default;
+    optional_copy_ctor& operator=(const optional_copy_ctor&) = default;
+    optional_copy_ctor& operator=(optional_copy_ctor&&) = default;
+};
+
+template <typename T, typename Base,
+          bool = std::is_trivially_move_constructible_v<T>>
+struct optional_move_ctor : Base {
+    using Base::Base;
+};
+template <typename T, typename Base>
+struct optional_move_ctor<T, Base, false> : Base {
+    using Base::Base;
 
-            other.has_value_ = false;
+    optional_move_ctor() = default;
+    optional_move_ctor(const optional_move_ctor&) = default;
+    // Like std::optional, other stays engaged with a moved-from T
+    optional_move_ctor(optional_move_ctor&& other) noexcept(
+        std::is_nothrow_move_constructible_v<T>)
+        : Base() {
+        if (other.engaged()) {
+            this->construct(std::move(other.obj_));
+        }
+    }
+    optional_move_ctor& operator=(const optional_move_ctor&) = default;
+    optional_move_ctor& operator=(optional_move_ctor&&) = default;
+};
+
+template <typename T, typename Base,
+          bool = std::is_trivially_copy_constructible_v<T> &&
+                 std::is_trivially_copy_assignable_v<T> &&
+                 std::is_trivially_destructible_v<T>>
+struct optional_copy_assign : Base {
+    using Base::Base;
+};
+template <typename T, typename Base>
+struct optional_copy_assign<T, Base, false> : Base {
+    using Base::Base;
+
+    optional_copy_assign() = default;
+    optional_copy_assign(const optional_copy_assign&) = default;
+    optional_copy_assign(optional_copy_assign&&) = default;
+    optional_copy_assign& operator=(const optional_copy_assign& other) {
+        if (!other.engaged()) {
+            this->reset();
+        }
+        else if (this->engaged()) {
+            this->obj_ = other.obj_;
+        }
+        else {
+            this->construct(other.obj_);
         }
 
         return *this;
     }
-    ~optional() {}
+    optional_copy_assign& operator=(optional_copy_assign&&) = default;
+};
+
+template <typename T, typename Base,
+          bool = std::is_trivially_move_constructible_v<T> &&
+                 std::is_trivially_move_assignable_v<T> &&
+                 std::is_trivially_destructible_v<T>>
+struct optional_move_assign : Base {
+    using Base::Base;
+};
+template <typename T, typename Base>
+struct optional_move_assign<T, Base, false> : Base {
+    using Base::Base;
+
+    optional_move_assign() = default;
+    optional_move_assign(const optional_move_assign&) = default;
+    optional_move_assign(optional_move_assign&&) = default;
+    optional_move_assign& operator=(const optional_move_assign&) = default;
+    optional_move_assign& operator=(optional_move_assign&& other) noexcept(
+        std::is_nothrow_move_constructible_v<T> &&
+        std::is_nothrow_move_assignable_v<T>) {
+        if (!other.engaged()) {
+            this->reset();
+        }
+        else if (this->engaged()) {
+            this->obj_ = std::move(other.obj_);
+        }
+        else {
+            this->construct(std::move(other.obj_));
+        }
+
+        return *this;
+    }
+};
+
+// Deletes what T can't do, the layers above would otherwise claim to copy
+// anything and only fail once instantiated
+template <bool Copy, bool Move> struct optional_enable_copy_move {};
+template <> struct optional_enable_copy_move<false, true> {
+    optional_enable_copy_move() = default;
+    optional_enable_copy_move(const optional_enable_copy_move&) = delete;
+    optional_enable_copy_move(optional_enable_copy_move&&) = default;
+    optional_enable_copy_move&
+    operator=(const optional_enable_copy_move&) = delete;
+    optional_enable_copy_move& operator=(optional_enable_copy_move&&) = default;
+};
+template <> struct optional_enable_copy_move<false, false> {
+    optional_enable_copy_move() = default;
+    optional_enable_copy_move(const optional_enable_copy_move&) = delete;
+    optional_enable_copy_move(optional_enable_copy_move&&) = delete;
+    optional_enable_copy_move&
+    operator=(const optional_enable_copy_move&) = delete;
+    optional_enable_copy_move& operator=(optional_enable_copy_move&&) = delete;
+};
+
+template <typename T>
+using optional_base = optional_move_assign<
+    T, optional_copy_assign<
+           T, optional_move_ctor<
+                  T, optional_copy_ctor<T, optional_storage<T>>>>>;
+}; // namespace detail
+
+template <typename T>
+class optional : private detail::optional_base<T>,
+                 private detail::optional_enable_copy_move<
+                     std::is_copy_constructible_v<T> &&
+                         std::is_copy_assignable_v<T>,
+                     std::is_move_constructible_v<T> &&
+                         std::is_move_assignable_v<T>> {
+    using base = detail::optional_base<T>;
+
+public:
+    using value_type = T;
+
+    optional() = default;
+    optional(const T& obj) : base(std::in_place, obj) {}
+    optional(T&& obj) : base(std::in_place, std::move(obj)) {}
+    // Builds T straight in the storage, T needn't be copyable or movable
+    template <typename... Args>
+    explicit optional(std::in_place_t, Args&&... args)
+        : base(std::in_place, std::forward<Args>(args)...) {}
+
+    template <typename... Args> T& emplace(Args&&... args) {
+        this->reset();
+        this->construct(std::forward<Args>(args)...);
+        return this->obj_;
+    }
+    using base::reset;
 
     T& value() {
-        if (!has_value_) {
+        if (!has_value()) {
             throw std::logic_error("value() requested in empty optional!");
         }
-        return obj_;
+        return this->obj_;
     }
-    bool has_value() const noexcept { return has_value_; }
+    const T& value() const {
+        if (!has_value()) {
+            throw std::logic_error("value() requested in empty optional!");
+        }
+        return this->obj_;
+    }
+    template <typename U> T value_or(U&& fallback) const {
+        return has_value() ? this->obj_
+                           : static_cast<T>(std::forward<U>(fallback));
+    }
+    bool has_value() const noexcept { return this->engaged(); }
 
-    T& operator*() noexcept { return obj_; }
-    T* operator->() noexcept { return &obj_; }
+    T& operator*() noexcept { return this->obj_; }
+    const T& operator*() const noexcept { return this->obj_; }
+    T* operator->() noexcept { return &this->obj_; }
+    const T* operator->() const noexcept { return &this->obj_; }
     operator bool() const noexcept { return has_value(); }
-
-private:
-    T obj_;
-    bool has_value_;
 };
 }; // namespace fun
@@ -0,0 +1,219 @@
+#include "ring_buffer.hpp"
+#include "instrument.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+    Single-threaded behavior first, then stress tests that hammer the
+    queues from several threads. ring_buffer_tsan_tests runs this same file
+    under ThreadSanitizer when the toolchain supports it.
+*/
+using fun::instrument::counting_element;
+
+template <typename Ring> static void push_spin(Ring& ring, uint64_t v) {
+    while (!ring.try_push(v)) {
+        std::this_thread::yield();
+    }
+}
+
+template <typename Ring> class RingTests : public ::testing::Test {};
+using ring_types =
+    ::testing::Types<fun::spsc_ring<int>, fun::mpmc_ring<int>>;
+TYPED_TEST_SUITE(RingTests, ring_types);
+
+TYPED_TEST(RingTests, RoundsCapacityUp) {
+    TypeParam ring(5);
+    EXPECT_EQ(ring.capacity(), 8);
+}
+
+TYPED_TEST(RingTests, FifoUntilFull) {
+    TypeParam ring(4);
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(ring.try_push(i));
+    }
+    EXPECT_FALSE(ring.try_push(99));
+    EXPECT_EQ(ring.size_approx(), 4);
+
+    int out = -1;
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(ring.try_pop(out));
+        EXPECT_EQ(out, i);
+    }
+    EXPECT_FALSE(ring.try_pop(out));
+    EXPECT_TRUE(ring.empty_approx());
+}
+
+TYPED_TEST(RingTests, WrapsAround) {
+    TypeParam ring(4);
+    int out = 0;
+    for (int i = 0; i < 100; i++) {
+        ASSERT_TRUE(ring.try_push(i));
+        ASSERT_TRUE(ring.try_push(i + 1000));
+        ASSERT_TRUE(ring.try_pop(out));
+        ASSERT_EQ(out, i);
+        ASSERT_TRUE(ring.try_pop(out));
+        ASSERT_EQ(out, i + 1000);
+    }
+}
+
+TYPED_TEST(RingTests, Batches) {
+    TypeParam ring(8);
+    const std::vector<int> in{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+
+    // Only 8 fit
+    EXPECT_EQ(ring.try_push_n(in.begin(), in.size()), 8);
+    std::vector<int> out(10, 0);
+    EXPECT_EQ(ring.try_pop_n(out.begin(), 3), 3);
+    EXPECT_EQ(out[2], 3);
+
+    // Across the wrap point
+    EXPECT_EQ(ring.try_push_n(in.begin() + 8, 2), 2);
+    EXPECT_EQ(ring.try_pop_n(out.begin(), 10), 7);
+    EXPECT_EQ(out[0], 4);
+    EXPECT_EQ(out[6], 10);
+    EXPECT_EQ(ring.try_pop_n(out.begin(), 10), 0);
+}
+
+TEST(RingBufferTests, NonTrivialElements) {
+    fun::spsc_ring<std::string> ring(4);
+    ring.try_push(std::string(100, 'x'));
+    std::string out;
+    ASSERT_TRUE(ring.try_pop(out));
+    EXPECT_EQ(out.size(), 100);
+
+    auto moved = std::make_unique<int>(3);
+    fun::mpmc_ring<std::unique_ptr<int>> owners(2);
+    EXPECT_TRUE(owners.try_push(std::move(moved)));
+    std::unique_ptr<int> back;
+    EXPECT_TRUE(owners.try_pop(back));
+    EXPECT_EQ(*back, 3);
+}
+
+TEST(RingBufferTests, LeftoversDestroyed) {
+    counting_element::tally() = {};
+    {
+        fun::spsc_ring<counting_element> spsc(8);
+        fun::mpmc_ring<counting_element> mpmc(8);
+        for (int i = 0; i < 5; i++) {
+            spsc.try_emplace(i);
+            mpmc.try_emplace(i);
+        }
+        counting_element out;
+        spsc.try_pop(out);
+        mpmc.try_pop(out);
+    }
+    EXPECT_EQ(counting_element::tally().alive(), 0);
+}
+
+TEST(RingBufferStress, SpscKeepsOrder) {
+    constexpr uint64_t count = 200000;
+    fun::spsc_ring<uint64_t> ring(64);
+
+    std::thread producer([&] {
+        uint64_t next = 0;
+        while (next < count) {
+            // Mix single pushes and batches
+            if (next % 3 == 0) {
+                push_spin(ring, next++);
+                continue;
+            }
+            uint64_t batch[16];
+            const uint64_t n = std::min<uint64_t>(16, count - next);
+            for (uint64_t i = 0; i < n; i++) {
+                batch[i] = next + i;
+            }
+            const uint64_t pushed = ring.try_push_n(batch, n);
+            if (pushed == 0) {
+                std::this_thread::yield();
+            }
+            next += pushed;
+        }
+    });
+
+    uint64_t expected = 0;
+    uint64_t buf[32];
+    while (expected < count) {
+        const size_t got = ring.try_pop_n(buf, 32);
+        for (size_t i = 0; i < got; i++) {
+            ASSERT_EQ(buf[i], expected++);
+        }
+        if (got == 0) {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(ring.empty_approx());
+}
+
+TEST(RingBufferStress, MpmcDeliversEverythingOnce) {
+    constexpr int producers = 4;
+    constexpr int consumers = 4;
+    constexpr uint64_t per_producer = 50000;
+    fun::mpmc_ring<uint64_t> ring(128);
+
+    // Values are producer << 32 | sequence
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&, p] {
+            const uint64_t tag = static_cast<uint64_t>(p) << 32;
+            uint64_t next = 0;
+            while (next < per_producer) {
+                if (next % 2 == 0) {
+                    push_spin(ring, tag | next++);
+                    continue;
+                }
+                uint64_t batch[8];
+                const uint64_t n = std::min<uint64_t>(8, per_producer - next);
+                for (uint64_t i = 0; i < n; i++) {
+                    batch[i] = tag | (next + i);
+                }
+                const uint64_t pushed = ring.try_push_n(batch, n);
+                if (pushed == 0) {
+                    std::this_thread::yield();
+                }
+                next += pushed;
+            }
+        });
+    }
+
+    std::atomic<uint64_t> popped{0};
+    std::vector<std::vector<uint64_t>> seen(consumers);
+    for (int c = 0; c < consumers; c++) {
+        threads.emplace_back([&, c] {
+            uint64_t buf[8];
+            while (popped.load() < producers * per_producer) {
+                size_t got = ring.try_pop_n(buf, (c % 2) ? 8 : 1);
+                for (size_t i = 0; i < got; i++) {
+                    seen[c].push_back(buf[i]);
+                }
+                popped += got;
+                if (got == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    std::vector<int> delivered(producers * per_producer, 0);
+    for (const auto& values : seen) {
+        // Each consumer sees any one producer's values in push order
+        std::vector<int64_t> last(producers, -1);
+        for (uint64_t v : values) {
+            const auto p = static_cast<size_t>(v >> 32);
+            const auto seq = static_cast<int64_t>(v & 0xFFFFFFFF);
+            ASSERT_GT(seq, last[p]);
+            last[p] = seq;
+            delivered[p * per_producer + seq]++;
+        }
+    }
+    for (int d : delivered) {
+        ASSERT_EQ(d, 1);
+    }
+}
@@ -0,0 +1,322 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/*
+    Fixed-capacity lock-free queues for passing work between threads.
+
+    fun::spsc_ring<T>: exactly one producer thread and one consumer thread.
+    head_ and tail_ sit on their own cache lines so the two sides don't
+    false-share, and each side keeps a private copy of the other side's
+    index, only re-reading the shared atomic when the copy says full/empty.
+    In steady state a push or pop touches no line the other thread writes.
+
+    fun::mpmc_ring<T>: any number of producers and consumers, Dmitry
+    Vyukov's bounded queue. Every slot carries a sequence number that says
+    whose turn it is (a producer for lap k, or a consumer), so claiming a
+    slot is one CAS on the shared position and handing it over is one store.
+
+    Capacity is rounded up to a power of two. Everything is try_*: a full
+    push or an empty pop returns false (or a short count for the batch
+    versions) instead of blocking, spinning/yielding is up to the caller.
+    Batches move up to n elements with a single index update, which is where
+    most of the throughput comes from.
+*/
+namespace fun {
+namespace detail {
+
+// Fixed rather than std::hardware_destructive_interference_size, which gcc
+// warns about using in headers since it can change with -mtune
+inline constexpr size_t cache_line_size = 64;
+
+inline size_t ring_capacity_for(size_t n) {
+    size_t capacity = 1;
+    while (capacity < n) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+// A T-sized hole, constructed and destroyed by hand
+template <typename T> struct ring_slot {
+    alignas(T) unsigned char bytes[sizeof(T)];
+
+    T* get() noexcept { return std::launder(reinterpret_cast<T*>(bytes)); }
+};
+}; // namespace detail
+
+template <typename T> class spsc_ring {
+public:
+    explicit spsc_ring(size_t capacity)
+        : capacity_{detail::ring_capacity_for(capacity)},
+          mask_{capacity_ - 1}, slots_{new detail::ring_slot<T>[capacity_]} {}
+    ~spsc_ring() {
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        for (size_t i = head_.load(std::memory_order_acquire); i != tail;
+             i++) {
+            slots_[i & mask_].get()->~T();
+        }
+        delete[] slots_;
+    }
+
+    spsc_ring(const spsc_ring&) = delete;
+    spsc_ring& operator=(const spsc_ring&) = delete;
+
+    // Producer side
+
+    template <typename... Args> bool try_emplace(Args&&... args) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ == capacity_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ == capacity_) {
+                return false;
+            }
+        }
+
+        new (slots_[tail & mask_].get()) T(std::forward<Args>(args)...);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+    bool try_push(const T& val) { return try_emplace(val); }
+    bool try_push(T&& val) { return try_emplace(std::move(val)); }
+
+    // Pushes up to n elements from first, returns how many made it
+    template <typename InputIt> size_t try_push_n(InputIt first, size_t n) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t free = capacity_ - (tail - head_cache_);
+        if (free < n) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            free = capacity_ - (tail - head_cache_);
+        }
+
+        const size_t count = n < free ? n : free;
+        for (size_t i = 0; i < count; i++, ++first) {
+            new (slots_[(tail + i) & mask_].get()) T(*first);
+        }
+        tail_.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side
+
+    bool try_pop(T& out) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) {
+                return false;
+            }
+        }
+
+        T* elem = slots_[head & mask_].get();
+        out = std::move(*elem);
+        elem->~T();
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Pops up to n elements into out, returns how many there were
+    template <typename OutputIt> size_t try_pop_n(OutputIt out, size_t n) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        size_t ready = tail_cache_ - head;
+        if (ready < n) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            ready = tail_cache_ - head;
+        }
+
+        const size_t count = n < ready ? n : ready;
+        for (size_t i = 0; i < count; i++, ++out) {
+            T* elem = slots_[(head + i) & mask_].get();
+            *out = std::move(*elem);
+            elem->~T();
+        }
+        head_.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // Only a snapshot while the other side is running
+    size_t size_approx() const noexcept {
+        return tail_.load(std::memory_order_acquire) -
+               head_.load(std::memory_order_acquire);
+    }
+    bool empty_approx() const noexcept { return size_approx() == 0; }
+    size_t capacity() const noexcept { return capacity_; }
+
+private:
+    const size_t capacity_;
+    const size_t mask_;
+    detail::ring_slot<T>* const slots_;
+
+    // Consumer's line: where it reads next, and its copy of tail_
+    alignas(detail::cache_line_size) std::atomic<size_t> head_{0};
+    size_t tail_cache_ = 0;
+
+    // Producer's line: where it writes next, and its copy of head_
+    alignas(detail::cache_line_size) std::atomic<size_t> tail_{0};
+    size_t head_cache_ = 0;
+    // (the alignas also rounds sizeof up, so nothing after us shares it)
+};
+
+template <typename T> class mpmc_ring {
+public:
+    explicit mpmc_ring(size_t capacity)
+        : capacity_{detail::ring_capacity_for(capacity)},
+          mask_{capacity_ - 1}, cells_{new cell[capacity_]} {
+        // Slot i starts out waiting for the producer of position i
+        for (size_t i = 0; i < capacity_; i++) {
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+    ~mpmc_ring() {
+        // Nobody else is left, so whatever was pushed and not popped is full
+        const size_t enq = enqueue_pos_.load(std::memory_order_acquire);
+        for (size_t i = dequeue_pos_.load(std::memory_order_acquire); i != enq;
+             i++) {
+            cells_[i & mask_].slot.get()->~T();
+        }
+        delete[] cells_;
+    }
+
+    mpmc_ring(const mpmc_ring&) = delete;
+    mpmc_ring& operator=(const mpmc_ring&) = delete;
+
+    template <typename... Args> bool try_emplace(Args&&... args) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        cell* c;
+        for (;;) {
+            c = &cells_[pos & mask_];
+            const size_t seq = c->seq.load(std::memory_order_acquire);
+            const auto lag = static_cast<intptr_t>(seq - pos);
+            if (lag == 0) {
+                if (enqueue_pos_.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (lag < 0) {
+                // Still holding last lap's element, we're full
+                return false;
+            }
+            else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        new (c->slot.get()) T(std::forward<Args>(args)...);
+        c->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+    bool try_push(const T& val) { return try_emplace(val); }
+    bool try_push(T&& val) { return try_emplace(std::move(val)); }
+
+    bool try_pop(T& out) {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        cell* c;
+        for (;;) {
+            c = &cells_[pos & mask_];
+            const size_t seq = c->seq.load(std::memory_order_acquire);
+            const auto lag = static_cast<intptr_t>(seq - (pos + 1));
+            if (lag == 0) {
+                if (dequeue_pos_.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (lag < 0) {
+                return false;
+            }
+            else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        T* elem = c->slot.get();
+        out = std::move(*elem);
+        elem->~T();
+        // Free for the producer one lap later
+        c->seq.store(pos + capacity_, std::memory_order_release);
+        return true;
+    }
+
+    /*
+        Claims a run of consecutive ready slots with one CAS. Only slots
+        whose sequence says "producer's turn" count, and nobody else can
+        touch them once the CAS moved the position past them.
+    */
+    template <typename InputIt> size_t try_push_n(InputIt first, size_t n) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        size_t count;
+        do {
+            count = 0;
+            while (count < n &&
+                   cells_[(pos + count) & mask_].seq.load(
+                       std::memory_order_acquire) == pos + count) {
+                count++;
+            }
+            if (count == 0) {
+                return 0;
+            }
+        } while (!enqueue_pos_.compare_exchange_weak(
+            pos, pos + count, std::memory_order_relaxed));
+
+        for (size_t i = 0; i < count; i++, ++first) {
+            cell& c = cells_[(pos + i) & mask_];
+            new (c.slot.get()) T(*first);
+            c.seq.store(pos + i + 1, std::memory_order_release);
+        }
+        return count;
+    }
+
+    template <typename OutputIt> size_t try_pop_n(OutputIt out, size_t n) {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        size_t count;
+        do {
+            count = 0;
+            while (count < n &&
+                   cells_[(pos + count) & mask_].seq.load(
+                       std::memory_order_acquire) == pos + count + 1) {
+                count++;
+            }
+            if (count == 0) {
+                return 0;
+            }
+        } while (!dequeue_pos_.compare_exchange_weak(
+            pos, pos + count, std::memory_order_relaxed));
+
+        for (size_t i = 0; i < count; i++, ++out) {
+            cell& c = cells_[(pos + i) & mask_];
+            T* elem = c.slot.get();
+            *out = std::move(*elem);
+            elem->~T();
+            c.seq.store(pos + i + capacity_, std::memory_order_release);
+        }
+        return count;
+    }
+
+    size_t size_approx() const noexcept {
+        const size_t enq = enqueue_pos_.load(std::memory_order_acquire);
+        const size_t deq = dequeue_pos_.load(std::memory_order_acquire);
+        return enq > deq ? enq - deq : 0;
+    }
+    bool empty_approx() const noexcept { return size_approx() == 0; }
+    size_t capacity() const noexcept { return capacity_; }
+
+private:
+    struct cell {
+        std::atomic<size_t> seq;
+        detail::ring_slot<T> slot;
+    };
+
+    const size_t capacity_;
+    const size_t mask_;
+    cell* const cells_;
+
+    alignas(detail::cache_line_size) std::atomic<size_t> enqueue_pos_{0};
+    alignas(detail::cache_line_size) std::atomic<size_t> dequeue_pos_{0};
+};
+
+}; // namespace fun
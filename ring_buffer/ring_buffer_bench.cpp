@@ -0,0 +1,165 @@
+#include "ring_buffer.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+/*
+    The rings against the usual std::mutex + std::deque queue.
+
+    Throughput: one producer thread pushes a fixed number of uint64s while
+    the benchmark thread pops them, one at a time or in batches of 64.
+    Latency: a round trip through two queues, the other thread echoing back
+    what it gets, so each iteration is one handoff each way.
+
+    Real time, since the work is split between two threads. On a machine
+    with a single core this mostly measures the cost of the handoff plus
+    scheduling, the gap gets bigger with cores to spare.
+*/
+template <typename T> class locked_queue {
+public:
+    explicit locked_queue(size_t capacity) : capacity_{capacity} {}
+
+    bool try_push(const T& val) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (items_.size() == capacity_) {
+            return false;
+        }
+        items_.push_back(val);
+        return true;
+    }
+    bool try_pop(T& out) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (items_.empty()) {
+            return false;
+        }
+        out = items_.front();
+        items_.pop_front();
+        return true;
+    }
+    template <typename InputIt> size_t try_push_n(InputIt first, size_t n) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        size_t count = 0;
+        for (; count < n && items_.size() < capacity_; count++, ++first) {
+            items_.push_back(*first);
+        }
+        return count;
+    }
+    template <typename OutputIt> size_t try_pop_n(OutputIt out, size_t n) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        size_t count = 0;
+        for (; count < n && !items_.empty(); count++, ++out) {
+            *out = items_.front();
+            items_.pop_front();
+        }
+        return count;
+    }
+
+private:
+    const size_t capacity_;
+    std::mutex mtx_;
+    std::deque<T> items_;
+};
+
+constexpr size_t queue_capacity = 1024;
+constexpr uint64_t items_per_iteration = 1 << 16;
+
+template <typename Queue> static void BM_Throughput(benchmark::State& state) {
+    const auto batch = static_cast<size_t>(state.range(0));
+
+    for (auto _ : state) {
+        Queue queue(queue_capacity);
+        std::thread producer([&] {
+            uint64_t buf[64];
+            for (uint64_t next = 0; next < items_per_iteration;) {
+                size_t pushed;
+                if (batch == 1) {
+                    pushed = queue.try_push(next) ? 1 : 0;
+                }
+                else {
+                    for (size_t i = 0; i < batch; i++) {
+                        buf[i] = next + i;
+                    }
+                    pushed = queue.try_push_n(buf, batch);
+                }
+                if (pushed == 0) {
+                    std::this_thread::yield();
+                }
+                next += pushed;
+            }
+        });
+
+        uint64_t sum = 0;
+        uint64_t buf[64];
+        for (uint64_t popped = 0; popped < items_per_iteration;) {
+            size_t got = batch == 1 ? (queue.try_pop(buf[0]) ? 1 : 0)
+                                    : queue.try_pop_n(buf, batch);
+            for (size_t i = 0; i < got; i++) {
+                sum += buf[i];
+            }
+            if (got == 0) {
+                std::this_thread::yield();
+            }
+            popped += got;
+        }
+        producer.join();
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * items_per_iteration);
+}
+
+template <typename Queue> static void BM_PingPong(benchmark::State& state) {
+    Queue ping(queue_capacity);
+    Queue pong(queue_capacity);
+    std::thread echo([&] {
+        uint64_t v = 0;
+        for (;;) {
+            while (!ping.try_pop(v)) {
+                std::this_thread::yield();
+            }
+            while (!pong.try_push(v)) {
+                std::this_thread::yield();
+            }
+            // 0 is the stop signal, after it's been echoed
+            if (v == 0) {
+                return;
+            }
+        }
+    });
+
+    uint64_t v = 1;
+    for (auto _ : state) {
+        ping.try_push(v);
+        uint64_t back;
+        while (!pong.try_pop(back)) {
+            std::this_thread::yield();
+        }
+        benchmark::DoNotOptimize(back);
+        v++;
+    }
+
+    ping.try_push(0);
+    uint64_t back;
+    while (!pong.try_pop(back)) {
+        std::this_thread::yield();
+    }
+    echo.join();
+}
+
+BENCHMARK_TEMPLATE(BM_Throughput, fun::spsc_ring<uint64_t>)
+    ->Arg(1)
+    ->Arg(64)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Throughput, fun::mpmc_ring<uint64_t>)
+    ->Arg(1)
+    ->Arg(64)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Throughput, locked_queue<uint64_t>)
+    ->Arg(1)
+    ->Arg(64)
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_PingPong, fun::spsc_ring<uint64_t>)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PingPong, fun::mpmc_ring<uint64_t>)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PingPong, locked_queue<uint64_t>)->UseRealTime();
@@ -0,0 +1,297 @@
+#include "small_vector.hpp"
+#include "memory_resource.hpp"
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+// Stateful allocator that propagates on move assignment
+template <typename T> struct tagged_allocator {
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    int tag;
+
+    explicit tagged_allocator(int tag) : tag{tag} {}
+    template <typename U>
+    tagged_allocator(const tagged_allocator<U>& other) : tag{other.tag} {}
+
+    T* allocate(size_t n) { return std::allocator<T>{}.allocate(n); }
+    void deallocate(T* p, size_t n) { std::allocator<T>{}.deallocate(p, n); }
+
+    template <typename U> bool operator==(const tagged_allocator<U>& o) const {
+        return tag == o.tag;
+    }
+    template <typename U> bool operator!=(const tagged_allocator<U>& o) const {
+        return tag != o.tag;
+    }
+};
+
+TEST(SmallVectorTests, Ctor) {
+    fun::small_vector<int, 4> v;
+    EXPECT_EQ(v.size(), 0);
+    EXPECT_EQ(v.capacity(), 4);
+    EXPECT_TRUE(v.is_inline());
+}
+
+TEST(SmallVectorTests, InitializerList) {
+    fun::small_vector<int, 4> small = {1, 2, 3};
+    EXPECT_TRUE(small.is_inline());
+    EXPECT_EQ(small[2], 3);
+
+    fun::small_vector<int, 2> big = {1, 2, 3};
+    EXPECT_FALSE(big.is_inline());
+    EXPECT_EQ(big.size(), 3);
+    EXPECT_EQ(big[2], 3);
+}
+
+TEST(SmallVectorTests, PushBackStaysInline) {
+    fun::small_vector<int, 8> v;
+    for (int i = 0; i < 8; i++) {
+        v.push_back(i);
+    }
+
+    EXPECT_TRUE(v.is_inline());
+    EXPECT_EQ(v.capacity(), 8);
+    EXPECT_EQ(v[7], 7);
+}
+
+TEST(SmallVectorTests, SpillsToHeap) {
+    fun::small_vector<std::string, 2> v;
+    v.push_back("a");
+    v.push_back("b");
+    EXPECT_TRUE(v.is_inline());
+
+    v.push_back("c");
+    EXPECT_FALSE(v.is_inline());
+    EXPECT_EQ(v.size(), 3);
+    EXPECT_EQ(v.capacity(), 4);
+    EXPECT_EQ(v[0], "a");
+    EXPECT_EQ(v[1], "b");
+    EXPECT_EQ(v[2], "c");
+}
+
+TEST(SmallVectorTests, SpillMovingOwnElement) {
+    fun::small_vector<std::string, 2> v = {"a long enough string to allocate",
+                                           "b"};
+
+    // v[0] is relocated out of the inline buffer by the spill
+    v.push_back(std::move(v[0]));
+    EXPECT_FALSE(v.is_inline());
+    EXPECT_EQ(v.size(), 3);
+    EXPECT_EQ(v[1], "b");
+    EXPECT_EQ(v[2], "a long enough string to allocate");
+}
+
+TEST(SmallVectorTests, ElementAccessAt) {
+    fun::small_vector<int, 4> v = {1, 2, 3};
+    EXPECT_EQ(v.at(1), 2);
+    EXPECT_THROW(v.at(3), std::out_of_range);
+}
+
+TEST(SmallVectorTests, CopyCtor) {
+    fun::small_vector<std::string, 2> inline_v = {"x"};
+    fun::small_vector<std::string, 2> heap_v = {"x", "y", "z"};
+
+    fun::small_vector<std::string, 2> a(inline_v);
+    fun::small_vector<std::string, 2> b(heap_v);
+
+    EXPECT_TRUE(a.is_inline());
+    EXPECT_EQ(a[0], "x");
+    EXPECT_FALSE(b.is_inline());
+    EXPECT_EQ(b[2], "z");
+    EXPECT_NE(b.data(), heap_v.data());
+}
+
+TEST(SmallVectorTests, CopyAssign) {
+    fun::small_vector<int, 2> v = {1, 2, 3};
+    fun::small_vector<int, 2> v2 = {10};
+
+    v2 = v;
+    EXPECT_EQ(v2.size(), 3);
+    EXPECT_EQ(v2[2], 3);
+
+    v2 = v2;
+    EXPECT_EQ(v2.size(), 3);
+}
+
+TEST(SmallVectorTests, MoveCtorInline) {
+    fun::small_vector<std::string, 4> v = {"hello", "world"};
+    fun::small_vector<std::string, 4> v2(std::move(v));
+
+    // Inline elements can't be stolen, they get relocated into v2's buffer
+    EXPECT_TRUE(v2.is_inline());
+    EXPECT_EQ(v2.size(), 2);
+    EXPECT_EQ(v2[1], "world");
+    EXPECT_EQ(v.size(), 0);
+}
+
+TEST(SmallVectorTests, MoveCtorHeap) {
+    fun::small_vector<std::string, 1> v = {"a", "b", "c"};
+    const std::string* heap = v.data();
+
+    fun::small_vector<std::string, 1> v2(std::move(v));
+
+    // The heap buffer is stolen outright, and v drops back to inline storage
+    EXPECT_EQ(v2.data(), heap);
+    EXPECT_EQ(v2[2], "c");
+    EXPECT_EQ(v.size(), 0);
+    EXPECT_TRUE(v.is_inline());
+    EXPECT_EQ(v.capacity(), 1);
+
+    v.push_back("reused");
+    EXPECT_EQ(v[0], "reused");
+}
+
+TEST(SmallVectorTests, MoveInlineThenSpill) {
+    fun::small_vector<std::string, 2> v = {"a", "b"};
+    fun::small_vector<std::string, 2> v2;
+    v2 = std::move(v);
+
+    // The moved-to inline vector spills to the heap like any other
+    v2.push_back("c");
+    EXPECT_FALSE(v2.is_inline());
+    EXPECT_EQ(v2[0], "a");
+    EXPECT_EQ(v2[2], "c");
+}
+
+TEST(SmallVectorTests, MoveAssignHeapOverHeap) {
+    fun::small_vector<int, 1> v = {1, 2, 3};
+    fun::small_vector<int, 1> v2 = {4, 5, 6, 7};
+
+    v2 = std::move(v);
+    EXPECT_EQ(v2.size(), 3);
+    EXPECT_EQ(v2[0], 1);
+    EXPECT_TRUE(v.is_inline());
+}
+
+TEST(SmallVectorTests, MoveAssignAcrossArenas) {
+    fun::monotonic_arena a, b;
+    using svec = fun::small_vector<int, 1, std::pmr::polymorphic_allocator<int>>;
+    svec va({1, 2, 3}, &a);
+    svec vb{&b};
+
+    // b can't adopt a's heap buffer, so the elements are relocated
+    vb = std::move(va);
+    EXPECT_EQ(vb.size(), 3);
+    EXPECT_EQ(vb[2], 3);
+    EXPECT_EQ(vb.get_allocator().resource(), &b);
+}
+
+TEST(SmallVectorTests, Reserve) {
+    fun::small_vector<int, 4> v = {1, 2};
+    v.reserve(3);
+    EXPECT_TRUE(v.is_inline());
+
+    v.reserve(100);
+    EXPECT_FALSE(v.is_inline());
+    EXPECT_EQ(v.capacity(), 100);
+    EXPECT_EQ(v[1], 2);
+}
+
+TEST(SmallVectorTests, PushBackSelfReference) {
+    fun::small_vector<std::string, 1> v = {"self"};
+
+    // v[0] lives in the inline buffer that the spill is about to vacate
+    v.push_back(v[0]);
+    EXPECT_FALSE(v.is_inline());
+    EXPECT_EQ(v[1], "self");
+}
+
+TEST(SmallVectorTests, NoexceptMove) {
+    EXPECT_TRUE(
+        (std::is_nothrow_move_constructible_v<fun::small_vector<int, 4>>));
+    EXPECT_TRUE((std::is_nothrow_move_assignable_v<fun::small_vector<int, 4>>));
+
+    // Moving into another arena may have to allocate
+    using pmr_svec =
+        fun::small_vector<int, 4, std::pmr::polymorphic_allocator<int>>;
+    EXPECT_FALSE(std::is_nothrow_move_assignable_v<pmr_svec>);
+}
+
+TEST(SmallVectorTests, RangeFor) {
+    fun::small_vector<int, 2> v = {1, 2, 3};
+    int sum = 0;
+    for (int x : v) {
+        sum += x;
+    }
+    EXPECT_EQ(sum, 6);
+    EXPECT_EQ(v.end() - v.begin(), 3);
+
+    for (int& x : v) {
+        x *= 2;
+    }
+    const auto& cv = v;
+    EXPECT_EQ(*cv.begin(), 2);
+    EXPECT_EQ(*(cv.end() - 1), 6);
+}
+
+TEST(SmallVectorTests, EmplaceBack) {
+    fun::small_vector<std::string, 1> v;
+    std::string& first = v.emplace_back(3, 'a');
+    EXPECT_EQ(first, "aaa");
+    EXPECT_TRUE(v.is_inline());
+
+    // Spills while constructing from one of our own elements
+    std::string& second = v.emplace_back(v[0], 1);
+    EXPECT_FALSE(v.is_inline());
+    EXPECT_EQ(second, "aa");
+    EXPECT_EQ(v[0], "aaa");
+}
+
+TEST(SmallVectorTests, PopBack) {
+    fun::small_vector<std::string, 2> v = {"a", "b", "c"};
+    v.pop_back();
+    EXPECT_EQ(v.size(), 2);
+    EXPECT_EQ(v[1], "b");
+    v.pop_back();
+    v.pop_back();
+    EXPECT_TRUE(v.empty());
+}
+
+TEST(SmallVectorTests, Resize) {
+    fun::small_vector<int, 4> v = {1, 2};
+    v.resize(4);
+    EXPECT_TRUE(v.is_inline());
+    EXPECT_EQ(v[3], 0);
+
+    v.resize(6, 7);
+    EXPECT_FALSE(v.is_inline());
+    EXPECT_EQ(v[5], 7);
+    EXPECT_EQ(v[1], 2);
+
+    v.resize(1);
+    EXPECT_EQ(v.size(), 1);
+    v.resize_default_init(3);
+    EXPECT_EQ(v.size(), 3);
+    EXPECT_EQ(v[0], 1);
+}
+
+TEST(SmallVectorTests, ResizeGrowsGeometrically) {
+    fun::small_vector<int, 4> v;
+    size_t regrows = 0;
+    for (size_t i = 1; i <= 1000; i++) {
+        const size_t before = v.capacity();
+        v.resize(v.size() + 1, static_cast<int>(i));
+        regrows += v.capacity() != before;
+    }
+    EXPECT_EQ(v[999], 1000);
+    EXPECT_LE(regrows, 10);
+}
+
+TEST(SmallVectorTests, MoveAssignPropagatesInlineAllocator) {
+    using svec = fun::small_vector<int, 4, tagged_allocator<int>>;
+    svec a({1, 2}, tagged_allocator<int>(1));
+    svec b{tagged_allocator<int>(2)};
+
+    // a is inline, but POCMA still hands its allocator over
+    b = std::move(a);
+    EXPECT_EQ(b.get_allocator().tag, 1);
+    EXPECT_EQ(b[1], 2);
+
+    svec c({1, 2, 3, 4, 5}, tagged_allocator<int>(3));
+    b = std::move(c);
+    EXPECT_EQ(b.get_allocator().tag, 3);
+    EXPECT_EQ(b[4], 5);
+}
@@ -0,0 +1,274 @@
+#pragma once
+#include "vector.hpp"
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/*
+    fun::small_vector<int, 8> v;
+        -> first 8 elements live inside v itself, no heap allocation at all
+        -> the 9th push_back spills everything to the heap and from then on it
+           grows exactly like fun::vector
+
+    Growth and element relocation go through the same fun::detail helpers as
+    fun::vector, so trivially relocatable T still gets the memcpy paths.
+*/
+namespace fun {
+
+template <typename T, size_t N, typename Allocator = std::allocator<T>,
+          typename Growth = doubling_growth>
+class small_vector {
+    static_assert(N > 0, "small_vector needs at least one inline slot");
+
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    small_vector() : small_vector(Allocator()) {}
+    explicit small_vector(const Allocator& alloc)
+        : data_{inline_data()}, size_{0}, capacity_{N}, alloc_{alloc} {}
+    small_vector(const std::initializer_list<T>& list,
+                 const Allocator& alloc = Allocator())
+        : small_vector(alloc) {
+        reserve(list.size());
+        detail::copy_into_arr(data_, list.begin(), list.size());
+        size_ = list.size();
+    }
+    ~small_vector() {
+        clear();
+        release_heap();
+    }
+    small_vector(const small_vector& other)
+        : small_vector(alloc_traits::select_on_container_copy_construction(
+              other.alloc_)) {
+        reserve(other.size_);
+        detail::copy_into_arr(data_, other.data_, other.size_);
+        size_ = other.size_;
+    }
+    small_vector& operator=(const small_vector& other) {
+        if (this != &other) {
+            clear();
+            reserve(other.size_);
+            detail::copy_into_arr(data_, other.data_, other.size_);
+            size_ = other.size_;
+        }
+
+        return *this;
+    }
+    // Inline elements have to be relocated one by one, so this is only as
+    // noexcept as T's own move
+    small_vector(small_vector&& other) noexcept(
+        std::is_nothrow_move_constructible_v<T>)
+        : small_vector(other.alloc_) {
+        steal(other);
+    }
+    // Same as the move ctor, as long as we never have to allocate for
+    // another arena's elements
+    small_vector& operator=(small_vector&& other) noexcept(
+        std::is_nothrow_move_constructible_v<T> &&
+        (alloc_traits::propagate_on_container_move_assignment::value ||
+         alloc_traits::is_always_equal::value)) {
+        if (this != &other) {
+            clear();
+            release_heap();
+            steal(other);
+        }
+
+        return *this;
+    }
+
+    void push_back(const T& val) { emplace_back(val); }
+    void push_back(T&& val) { emplace_back(std::move(val)); }
+    template <typename... Args> T& emplace_back(Args&&... args) {
+        if (size_ == capacity_) {
+            // args may point into our elements, which the spill relocates
+            T tmp(std::forward<Args>(args)...);
+            grow_for(size_ + 1);
+            T* slot = new (data_ + size_) T(std::move(tmp));
+            size_++;
+            return *slot;
+        }
+
+        T* slot = new (data_ + size_) T(std::forward<Args>(args)...);
+        size_++;
+        return *slot;
+    }
+    void pop_back() {
+        assert(size_ > 0 && "pop_back on an empty small_vector");
+        shrink_size_to(size_ - 1);
+    }
+    void clear() {
+        detail::destroy_arr_elements(data_, size_);
+        size_ = 0;
+    }
+    // Strong exception safe, same as fun::vector::reserve
+    void reserve(size_t new_capacity) {
+        if (new_capacity > capacity_) {
+            T* new_data = alloc_traits::allocate(alloc_, new_capacity);
+            FUN_INSTRUMENT_HOOK(on_allocate(new_capacity * sizeof(T)));
+            try {
+                detail::relocate_arr(new_data, data_, size_);
+            }
+            catch (...) {
+                FUN_INSTRUMENT_HOOK(on_deallocate(new_capacity * sizeof(T)));
+                alloc_traits::deallocate(alloc_, new_data, new_capacity);
+                throw;
+            }
+
+            // The inline buffer is part of *this, only a heap buffer is freed
+            release_heap();
+            data_ = new_data;
+            capacity_ = new_capacity;
+        }
+    }
+
+    // Same as fun::vector, growth goes through the Growth policy so
+    // resize(size() + k) in a loop doesn't reallocate every time
+    void resize(size_t count) {
+        if (count <= size_) {
+            shrink_size_to(count);
+            return;
+        }
+
+        grow_for(count);
+        detail::value_init_arr(data_ + size_, count - size_);
+        size_ = count;
+    }
+    void resize(size_t count, const T& val) {
+        if (count <= size_) {
+            shrink_size_to(count);
+            return;
+        }
+
+        if (count > capacity_) {
+            // val may be one of our elements, which the regrow relocates
+            T copy(val);
+            grow_for(count);
+            detail::init_arr(data_ + size_, count - size_, copy);
+        }
+        else {
+            detail::init_arr(data_ + size_, count - size_, val);
+        }
+        size_ = count;
+    }
+    void resize_default_init(size_t count) {
+        if (count <= size_) {
+            shrink_size_to(count);
+            return;
+        }
+
+        grow_for(count);
+        detail::default_init_arr(data_ + size_, count - size_);
+        size_ = count;
+    }
+
+    T* begin() noexcept { return data_; }
+    const T* begin() const noexcept { return data_; }
+    T* end() noexcept { return data_ + size_; }
+    const T* end() const noexcept { return data_ + size_; }
+
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+    [[nodiscard]] size_t capacity() const noexcept { return capacity_; }
+    bool empty() const noexcept { return size_ == 0; }
+    // True while the elements still live in the inline buffer
+    bool is_inline() const noexcept { return data_ == inline_data(); }
+    static constexpr size_t inline_capacity() noexcept { return N; }
+
+    allocator_type get_allocator() const { return alloc_; }
+
+    T* data() noexcept { return data_; }
+    const T* data() const noexcept { return data_; }
+
+    T& operator[](size_t idx) { return data_[idx]; }
+    const T& operator[](size_t idx) const { return data_[idx]; }
+
+    T& at(size_t idx) {
+        if (idx >= size_) {
+            throw std::out_of_range("Value accessed out of range!");
+        }
+
+        return data_[idx];
+    }
+    const T& at(size_t idx) const {
+        if (idx >= size_) {
+            throw std::out_of_range("Value accessed out of range!");
+        }
+
+        return data_[idx];
+    }
+
+private:
+    T* data_;
+    size_t size_;
+    size_t capacity_;
+    Allocator alloc_;
+    alignas(T) unsigned char inline_buffer_[N * sizeof(T)];
+
+    T* inline_data() noexcept { return reinterpret_cast<T*>(inline_buffer_); }
+    const T* inline_data() const noexcept {
+        return reinterpret_cast<const T*>(inline_buffer_);
+    }
+
+    // Same policies as fun::vector, minus the heap-querying usable_capacity
+    void grow_for(size_t required) {
+        if (required > capacity_) {
+            reserve(Growth::next_capacity(capacity_, required, sizeof(T)));
+        }
+    }
+
+    void shrink_size_to(size_t count) {
+        detail::destroy_arr_elements(data_ + count, size_ - count);
+        size_ = count;
+    }
+
+    void release_heap() {
+        if (!is_inline()) {
+            FUN_INSTRUMENT_HOOK(on_deallocate(capacity_ * sizeof(T)));
+            alloc_traits::deallocate(alloc_, data_, capacity_);
+            data_ = inline_data();
+            capacity_ = N;
+        }
+    }
+
+    // Expects *this to be empty and inline. A heap buffer is stolen outright
+    // if our allocator can free it, otherwise (and always for inline
+    // elements, which live inside other) the elements are relocated
+    void steal(small_vector& other) {
+        // Propagate even for inline elements, other keeps a copy since it
+        // stays usable
+        if constexpr (alloc_traits::propagate_on_container_move_assignment::
+                          value) {
+            alloc_ = other.alloc_;
+        }
+        const bool can_adopt =
+            !other.is_inline() &&
+            (alloc_traits::propagate_on_container_move_assignment::value ||
+             alloc_ == other.alloc_);
+
+        if (can_adopt) {
+            data_ = other.data_;
+            size_ = other.size_;
+            capacity_ = other.capacity_;
+
+            other.data_ = other.inline_data();
+            other.capacity_ = N;
+        }
+        else {
+            reserve(other.size_);
+            detail::relocate_arr(data_, other.data_, other.size_);
+            size_ = other.size_;
+        }
+
+        other.size_ = 0;
+    }
+};
+
+}; // namespace fun
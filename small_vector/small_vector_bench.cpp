@@ -0,0 +1,48 @@
+#include "small_vector.hpp"
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
+
+/*
+    Every container gets the same counting allocator, so each benchmark can
+    report heap allocations per iteration next to its time.
+*/
+static size_t alloc_count = 0;
+
+template <typename T> struct counting_allocator {
+    using value_type = T;
+
+    counting_allocator() = default;
+    template <typename U> counting_allocator(const counting_allocator<U>&) {}
+
+    T* allocate(size_t n) {
+        alloc_count++;
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, size_t n) { std::allocator<T>().deallocate(p, n); }
+
+    bool operator==(const counting_allocator&) const { return true; }
+    bool operator!=(const counting_allocator&) const { return false; }
+};
+
+template <typename Vec> static void BM_ShortSequences(benchmark::State& state) {
+    const size_t len = state.range(0);
+    const size_t start = alloc_count;
+    for (auto _ : state) {
+        Vec v;
+        for (size_t i = 0; i < len; i++) {
+            v.push_back(static_cast<int>(i));
+        }
+        benchmark::DoNotOptimize(v.data());
+    }
+
+    state.counters["allocs_per_iter"] = benchmark::Counter(
+        static_cast<double>(alloc_count - start) / state.iterations());
+}
+using counted = counting_allocator<int>;
+BENCHMARK_TEMPLATE(BM_ShortSequences, fun::small_vector<int, 8, counted>)
+    ->DenseRange(0, 16, 4);
+BENCHMARK_TEMPLATE(BM_ShortSequences, fun::vector<int, counted>)
+    ->DenseRange(0, 16, 4);
+BENCHMARK_TEMPLATE(BM_ShortSequences, std::vector<int, counted>)
+    ->DenseRange(0, 16, 4);
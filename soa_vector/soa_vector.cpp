@@ -0,0 +1,206 @@
+#include "soa_vector.hpp"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+using fun::instrument::counting_element;
+
+// Copyable, but its move may throw, so regrows copy it and can fail
+struct throwing_copy {
+    static inline int copies_left = -1;
+    int value;
+
+    throwing_copy(int v = 0) : value{v} {}
+    throwing_copy(const throwing_copy& o) : value{o.value} {
+        if (copies_left == 0) {
+            throw std::runtime_error("copy");
+        }
+        copies_left--;
+    }
+    throwing_copy(throwing_copy&& o) : value{o.value} {}
+    throwing_copy& operator=(const throwing_copy&) = default;
+};
+
+template <typename T> static bool is_aligned(const T* p, size_t align) {
+    return reinterpret_cast<uintptr_t>(p) % align == 0;
+}
+
+TEST(SoaVectorTests, EmptyDoesNotAllocate) {
+    fun::soa_vector<int, double> v;
+    EXPECT_EQ(v.size(), 0);
+    EXPECT_EQ(v.capacity(), 0);
+    EXPECT_EQ(v.data<0>(), nullptr);
+    EXPECT_TRUE(v.field<1>().empty());
+    EXPECT_EQ(v.begin(), v.end());
+}
+
+TEST(SoaVectorTests, PushAndEmplaceRows) {
+    fun::soa_vector<uint32_t, std::string, double> v;
+    v.emplace_back(1u, "one", 1.5);
+    v.push_back({2u, "two", 2.5});
+    const std::tuple<uint32_t, std::string, double> row{3u, "three", 3.5};
+    v.push_back(row);
+
+    EXPECT_EQ(v.size(), 3);
+    EXPECT_EQ(std::get<1>(v[1]), "two");
+    EXPECT_EQ(v[2], row);
+    EXPECT_THROW(v.at(3), std::out_of_range);
+}
+
+TEST(SoaVectorTests, RowsAreProxies) {
+    fun::soa_vector<int, float> v;
+    v.emplace_back(1, 1.0f);
+    v.emplace_back(2, 2.0f);
+
+    auto [id, mass] = v[0];
+    id = 10;
+    mass *= 3.0f;
+    EXPECT_EQ(v.data<0>()[0], 10);
+    EXPECT_EQ(v.data<1>()[0], 3.0f);
+
+    // Assigning a value through the proxy writes both columns
+    v[1] = std::make_tuple(20, 4.0f);
+    EXPECT_EQ(v.field<0>()[1], 20);
+    EXPECT_EQ(v.field<1>()[1], 4.0f);
+
+    int sum = 0;
+    for (auto [i, m] : v) {
+        sum += i;
+        m = 0.0f;
+    }
+    EXPECT_EQ(sum, 30);
+    EXPECT_EQ(v.field<1>()[0], 0.0f);
+
+    const auto& cv = v;
+    static_assert(
+        std::is_same_v<decltype(cv[0]), std::tuple<const int&, const float&>>);
+    EXPECT_EQ(std::get<0>(*(cv.end() - 1)), 20);
+}
+
+TEST(SoaVectorTests, ColumnsAreContiguousAndAligned) {
+    fun::soa_vector<char, double, uint16_t> v;
+    for (int i = 0; i < 1000; i++) {
+        v.emplace_back(static_cast<char>(i), i * 0.5,
+                       static_cast<uint16_t>(i));
+    }
+
+    EXPECT_TRUE(is_aligned(v.data<0>(), 64));
+    EXPECT_TRUE(is_aligned(v.data<1>(), 64));
+    EXPECT_TRUE(is_aligned(v.data<2>(), 64));
+
+    const auto xs = v.field<1>();
+    EXPECT_EQ(xs.size(), 1000);
+    EXPECT_EQ(std::accumulate(xs.begin(), xs.end(), 0.0), 999 * 1000 / 4.0);
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_EQ(v.field<2>()[i], i);
+    }
+}
+
+TEST(SoaVectorTests, ResizeReserveClear) {
+    fun::soa_vector<int, std::string> v;
+    v.reserve(10);
+    EXPECT_EQ(v.capacity(), 10);
+    v.resize(4);
+    EXPECT_EQ(v.size(), 4);
+    EXPECT_EQ(std::get<0>(v[3]), 0);
+    EXPECT_EQ(std::get<1>(v[3]), "");
+
+    v.resize(2);
+    EXPECT_EQ(v.size(), 2);
+    v.pop_back();
+    EXPECT_EQ(v.size(), 1);
+    v.clear();
+    EXPECT_TRUE(v.empty());
+    EXPECT_EQ(v.capacity(), 10);
+}
+
+TEST(SoaVectorTests, ResizeGrowsGeometrically) {
+    fun::soa_vector<int, double> v;
+    size_t regrows = 0;
+    for (size_t i = 1; i <= 1000; i++) {
+        const size_t capacity = v.capacity();
+        v.resize(i);
+        regrows += v.capacity() != capacity;
+    }
+    EXPECT_EQ(v.size(), 1000);
+    EXPECT_LE(regrows, 11);
+}
+
+TEST(SoaVectorTests, CopyMoveSwap) {
+    fun::soa_vector<int, std::string> a;
+    a.emplace_back(1, "x");
+    a.emplace_back(2, "y");
+
+    fun::soa_vector<int, std::string> b(a);
+    std::get<1>(b[0]) = "changed";
+    EXPECT_EQ(std::get<1>(a[0]), "x");
+
+    fun::soa_vector<int, std::string> c(std::move(b));
+    EXPECT_EQ(b.size(), 0);
+    EXPECT_EQ(std::get<1>(c[0]), "changed");
+
+    a = c;
+    EXPECT_EQ(std::get<1>(a[0]), "changed");
+    c.emplace_back(3, "z");
+    a = std::move(c);
+    EXPECT_EQ(a.size(), 3);
+
+    swap(a, b);
+    EXPECT_TRUE(a.empty());
+    EXPECT_EQ(std::get<1>(b[2]), "z");
+}
+
+TEST(SoaVectorTests, MoveOnlyFieldsAndSelfAliasing) {
+    fun::soa_vector<std::unique_ptr<int>, std::string> v;
+    for (int i = 0; i < 100; i++) {
+        v.emplace_back(std::make_unique<int>(i), std::to_string(i));
+    }
+    EXPECT_EQ(*std::get<0>(v[99]), 99);
+
+    // The argument is one of our own rows, and this push regrows
+    fun::soa_vector<std::string, int> s;
+    s.emplace_back("first", 1);
+    while (s.size() < s.capacity()) {
+        s.emplace_back("more", 0);
+    }
+    s.emplace_back(std::get<0>(s[0]), std::get<1>(s[0]));
+    EXPECT_EQ(std::get<0>(s[s.size() - 1]), "first");
+}
+
+TEST(SoaVectorTests, ElementLifetimes) {
+    counting_element::tally() = {};
+    {
+        fun::soa_vector<counting_element, int, counting_element> v;
+        for (int i = 0; i < 1000; i++) {
+            v.emplace_back(i, i, counting_element(i));
+        }
+        v.resize(500);
+        auto copy = v;
+        copy.pop_back();
+    }
+    EXPECT_EQ(counting_element::tally().alive(), 0);
+}
+
+TEST(SoaVectorTests, ThrowingRegrowLeavesRowsIntact) {
+    fun::soa_vector<int, throwing_copy, std::string> v;
+    for (int i = 0; i < 8; i++) {
+        v.emplace_back(i, throwing_copy(i), std::to_string(i));
+    }
+    ASSERT_EQ(v.size(), v.capacity());
+
+    // Fails copying the throwing_copy column, after the int column moved
+    throwing_copy::copies_left = 3;
+    EXPECT_THROW(v.emplace_back(8, throwing_copy(8), "8"), std::runtime_error);
+    EXPECT_THROW(v.reserve(100), std::runtime_error);
+    throwing_copy::copies_left = -1;
+
+    EXPECT_EQ(v.size(), 8);
+    for (int i = 0; i < 8; i++) {
+        ASSERT_EQ(std::get<0>(v[i]), i);
+        ASSERT_EQ(std::get<1>(v[i]).value, i);
+        ASSERT_EQ(std::get<2>(v[i]), std::to_string(i));
+    }
+}
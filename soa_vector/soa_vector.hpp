@@ -0,0 +1,496 @@
+#pragma once
+#include "growth.hpp"
+#include "instrument.hpp"
+#include "vector.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/*
+    fun::soa_vector<uint32_t, float, double> v;
+    v.emplace_back(7, 1.5f, 2.0);
+    auto [id, mass, x] = v[0];      // references into the three columns
+    for (float m : v.field<1>()) ...  // one contiguous float array
+
+    A structure-of-arrays vector: every field lives in its own array, so a
+    loop over one field only pulls that field through the cache and the
+    compiler sees a plain contiguous T* it can vectorize. With a
+    fun::vector<Struct> the same loop drags every other member along.
+
+    All the columns sit in one allocation, each starting on a 64 byte
+    boundary. Growth goes through the same policies as fun::vector (the
+    element size a policy sees is the size of a whole row), and elements are
+    moved around with the same detail:: primitives, so trivially relocatable
+    fields regrow with a memcpy per column.
+
+    Rows are std::tuple<Fields&...> proxies: assignable from a
+    std::tuple<Fields...>, comparable, and fine with structured bindings.
+*/
+namespace fun {
+
+// Just a pointer and a length, a std::span stand-in until C++20
+template <typename T> class field_span {
+public:
+    field_span(T* data, size_t size) : data_{data}, size_{size} {}
+
+    T* begin() const noexcept { return data_; }
+    T* end() const noexcept { return data_ + size_; }
+    T* data() const noexcept { return data_; }
+    size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+    T& operator[](size_t idx) const { return data_[idx]; }
+
+private:
+    T* data_;
+    size_t size_;
+};
+
+template <typename Growth, typename... Fields> class basic_soa_vector {
+    static_assert(sizeof...(Fields) > 0, "soa_vector needs a field");
+    static_assert(!detail::has_usable_capacity<Growth>::value,
+                  "soa_vector doesn't come from malloc, no usable_capacity");
+
+    static constexpr size_t field_count = sizeof...(Fields);
+    using indices = std::index_sequence_for<Fields...>;
+    using pointers = std::tuple<Fields*...>;
+
+public:
+    // Columns start on cache line boundaries (and anything stricter a field
+    // asks for)
+    static constexpr size_t column_alignment =
+        std::max({size_t{64}, alignof(Fields)...});
+    static constexpr size_t row_size = (sizeof(Fields) + ...);
+
+    using value_type = std::tuple<Fields...>;
+    using reference = std::tuple<Fields&...>;
+    using const_reference = std::tuple<const Fields&...>;
+    template <size_t I>
+    using field_type = std::tuple_element_t<I, value_type>;
+
+    template <bool Const> class row_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::tuple<Fields...>;
+        using reference =
+            std::conditional_t<Const, std::tuple<const Fields&...>,
+                               std::tuple<Fields&...>>;
+        using difference_type = std::ptrdiff_t;
+        // Rows are made up on the fly, there's nothing to point at
+        using pointer = void;
+
+        row_iterator() = default;
+        row_iterator(const pointers& cols, size_t idx)
+            : cols_{cols}, idx_{idx} {}
+
+        reference operator*() const { return row(indices{}); }
+        reference operator[](difference_type n) const {
+            return *(*this + n);
+        }
+
+        row_iterator& operator++() {
+            idx_++;
+            return *this;
+        }
+        row_iterator operator++(int) {
+            row_iterator old = *this;
+            idx_++;
+            return old;
+        }
+        row_iterator& operator--() {
+            idx_--;
+            return *this;
+        }
+        row_iterator operator--(int) {
+            row_iterator old = *this;
+            idx_--;
+            return old;
+        }
+        row_iterator& operator+=(difference_type n) {
+            idx_ += n;
+            return *this;
+        }
+        row_iterator& operator-=(difference_type n) {
+            idx_ -= n;
+            return *this;
+        }
+        row_iterator operator+(difference_type n) const {
+            return row_iterator(cols_, idx_ + n);
+        }
+        row_iterator operator-(difference_type n) const {
+            return row_iterator(cols_, idx_ - n);
+        }
+        difference_type operator-(const row_iterator& o) const {
+            return static_cast<difference_type>(idx_) -
+                   static_cast<difference_type>(o.idx_);
+        }
+
+        bool operator==(const row_iterator& o) const { return idx_ == o.idx_; }
+        bool operator!=(const row_iterator& o) const { return idx_ != o.idx_; }
+        bool operator<(const row_iterator& o) const { return idx_ < o.idx_; }
+
+    private:
+        pointers cols_{};
+        size_t idx_ = 0;
+
+        template <size_t... I>
+        reference row(std::index_sequence<I...>) const {
+            return reference(std::get<I>(cols_)[idx_]...);
+        }
+    };
+    using iterator = row_iterator<false>;
+    using const_iterator = row_iterator<true>;
+
+    // Empty vectors don't allocate, the first insert does
+    basic_soa_vector() = default;
+    ~basic_soa_vector() {
+        clear();
+        free_columns(cols_, capacity_);
+    }
+    basic_soa_vector(const basic_soa_vector& other) {
+        if (other.size_ == 0) {
+            return;
+        }
+        pointers cols = alloc_columns(other.size_);
+        copy_columns(cols, other.cols_, other.size_, indices{});
+        cols_ = cols;
+        size_ = other.size_;
+        capacity_ = other.size_;
+    }
+    basic_soa_vector(basic_soa_vector&& other) noexcept
+        : cols_{std::exchange(other.cols_, pointers{})},
+          size_{std::exchange(other.size_, 0)},
+          capacity_{std::exchange(other.capacity_, 0)} {}
+    basic_soa_vector& operator=(const basic_soa_vector& other) {
+        if (this != &other) {
+            basic_soa_vector copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+    basic_soa_vector& operator=(basic_soa_vector&& other) noexcept {
+        if (this != &other) {
+            basic_soa_vector gone(std::move(other));
+            swap(gone);
+        }
+        return *this;
+    }
+
+    void swap(basic_soa_vector& other) noexcept {
+        std::swap(cols_, other.cols_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+    friend void swap(basic_soa_vector& a, basic_soa_vector& b) noexcept {
+        a.swap(b);
+    }
+
+    // One argument per field. Strong exception safe like fun::vector, and
+    // the arguments may be our own elements even when we regrow
+    template <typename... Args> reference emplace_back(Args&&... args) {
+        static_assert(sizeof...(Args) == field_count,
+                      "emplace_back takes exactly one argument per field");
+        if (size_ == capacity_) {
+            realloc_emplace_back(std::forward<Args>(args)...);
+        }
+        else {
+            construct_row(cols_, size_, std::forward<Args>(args)...);
+            size_++;
+        }
+        return (*this)[size_ - 1];
+    }
+    void push_back(const value_type& row) {
+        std::apply([this](const Fields&... f) { emplace_back(f...); }, row);
+    }
+    void push_back(value_type&& row) {
+        std::apply([this](Fields&... f) { emplace_back(std::move(f)...); },
+                   row);
+    }
+
+    void pop_back() {
+        size_--;
+        destroy_rows(size_, 1);
+    }
+    void clear() {
+        destroy_rows(0, size_);
+        size_ = 0;
+    }
+
+    // Strong exception safe: a throwing copy leaves the old columns alone
+    void reserve(size_t new_capacity) {
+        if (new_capacity <= capacity_) {
+            return;
+        }
+        pointers cols = alloc_columns(new_capacity);
+        try {
+            relocate_columns(cols, cols_, size_);
+        }
+        catch (...) {
+            free_columns(cols, new_capacity);
+            throw;
+        }
+        free_columns(cols_, capacity_);
+        cols_ = cols;
+        capacity_ = new_capacity;
+    }
+    // New rows are value-initialized
+    void resize(size_t count) {
+        if (count <= size_) {
+            destroy_rows(count, size_ - count);
+            size_ = count;
+            return;
+        }
+        if (count > capacity_) {
+            // Amortized like push_back, not exactly count
+            reserve(Growth::next_capacity(capacity_, count, row_size));
+        }
+        while (size_ < count) {
+            construct_row(cols_, size_, Fields{}...);
+            size_++;
+        }
+    }
+
+    reference operator[](size_t idx) { return row(idx, indices{}); }
+    const_reference operator[](size_t idx) const {
+        return row(idx, indices{});
+    }
+    reference at(size_t idx) {
+        if (idx >= size_) {
+            throw std::out_of_range("Value accessed out of range!");
+        }
+        return (*this)[idx];
+    }
+    const_reference at(size_t idx) const {
+        if (idx >= size_) {
+            throw std::out_of_range("Value accessed out of range!");
+        }
+        return (*this)[idx];
+    }
+
+    // A whole column, contiguous and column_alignment aligned
+    template <size_t I> field_span<field_type<I>> field() noexcept {
+        return {std::get<I>(cols_), size_};
+    }
+    template <size_t I> field_span<const field_type<I>> field() const noexcept {
+        return {std::get<I>(cols_), size_};
+    }
+    template <size_t I> field_type<I>* data() noexcept {
+        return std::get<I>(cols_);
+    }
+    template <size_t I> const field_type<I>* data() const noexcept {
+        return std::get<I>(cols_);
+    }
+
+    iterator begin() noexcept { return iterator(cols_, 0); }
+    iterator end() noexcept { return iterator(cols_, size_); }
+    const_iterator begin() const noexcept { return const_iterator(cols_, 0); }
+    const_iterator end() const noexcept {
+        return const_iterator(cols_, size_);
+    }
+
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+    [[nodiscard]] size_t capacity() const noexcept { return capacity_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+private:
+    pointers cols_{};
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+
+    /*
+        Layout of one block: column I starts at column_offset<I>, every
+        column padded up to column_alignment so the next one starts aligned
+    */
+    static size_t padded(size_t bytes) {
+        return (bytes + column_alignment - 1) & ~(column_alignment - 1);
+    }
+    static size_t block_bytes(size_t capacity) {
+        return (padded(sizeof(Fields) * capacity) + ...);
+    }
+
+    static pointers alloc_columns(size_t capacity) {
+        const size_t bytes = block_bytes(capacity);
+        auto* block = static_cast<unsigned char*>(
+            ::operator new(bytes, std::align_val_t{column_alignment}));
+        FUN_INSTRUMENT_HOOK(on_allocate(bytes));
+
+        size_t offset = 0;
+        pointers cols;
+        std::apply(
+            [&](auto*&... col) {
+                ((col = reinterpret_cast<std::remove_reference_t<decltype(col)>>(
+                      block + offset),
+                  offset += padded(sizeof(*col) * capacity)),
+                 ...);
+            },
+            cols);
+        return cols;
+    }
+    static void free_columns(const pointers& cols, size_t capacity) {
+        // Moved-from and empty vectors hold nullptr
+        if (std::get<0>(cols) != nullptr) {
+            const size_t bytes = block_bytes(capacity);
+            FUN_INSTRUMENT_HOOK(on_deallocate(bytes));
+            ::operator delete(static_cast<void*>(std::get<0>(cols)), bytes,
+                              std::align_val_t{column_alignment});
+        }
+    }
+
+    template <size_t... I>
+    reference row(size_t idx, std::index_sequence<I...>) {
+        return reference(std::get<I>(cols_)[idx]...);
+    }
+    template <size_t... I>
+    const_reference row(size_t idx, std::index_sequence<I...>) const {
+        return const_reference(std::get<I>(cols_)[idx]...);
+    }
+
+    void destroy_rows(size_t first, size_t count) {
+        std::apply(
+            [&](auto*... col) {
+                (detail::destroy_arr_elements(col + first, count), ...);
+            },
+            cols_);
+    }
+
+    // Builds row idx field by field, a throw destroys the fields already
+    // built
+    template <typename... Args>
+    static void construct_row(const pointers& cols, size_t idx,
+                              Args&&... args) {
+        construct_row_impl(cols, idx, indices{},
+                           std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+    template <size_t... I, typename ArgTuple>
+    static void construct_row_impl(const pointers& cols, size_t idx,
+                                   std::index_sequence<I...>, ArgTuple&& args) {
+        size_t built = 0;
+        try {
+            ((new (std::get<I>(cols) + idx) field_type<I>(
+                  std::get<I>(std::move(args))),
+              built++),
+             ...);
+        }
+        catch (...) {
+            ((I < built ? std::destroy_at(std::get<I>(cols) + idx) : void()),
+             ...);
+            throw;
+        }
+    }
+
+    template <size_t... I>
+    static void copy_columns(const pointers& dst, const pointers& src,
+                             size_t count, std::index_sequence<I...>) {
+        size_t copied = 0;
+        try {
+            ((detail::copy_into_arr(std::get<I>(dst), std::get<I>(src), count),
+              copied++),
+             ...);
+        }
+        catch (...) {
+            ((I < copied
+                  ? detail::destroy_arr_elements(std::get<I>(dst), count)
+                  : void()),
+             ...);
+            free_columns(dst, count);
+            throw;
+        }
+    }
+
+    /*
+        Moves count rows from src to dst column by column, destroying src.
+        Columns that relocate by copy (throwing move) go first and keep
+        their source until every copy has succeeded, so a throw anywhere
+        leaves src exactly as it was. The rest can't throw.
+    */
+    static void relocate_columns(const pointers& dst, const pointers& src,
+                                 size_t count) {
+        relocate_columns_impl(dst, src, count, indices{});
+    }
+    template <size_t... I>
+    static void relocate_columns_impl(const pointers& dst, const pointers& src,
+                                      size_t count,
+                                      std::index_sequence<I...>) {
+        size_t copied = 0;
+        try {
+            (copy_if_throwing_move<I>(dst, src, count, copied), ...);
+        }
+        catch (...) {
+            (destroy_copy<I>(dst, count, copied), ...);
+            throw;
+        }
+        (finish_relocate<I>(dst, src, count), ...);
+    }
+    template <size_t I>
+    static void copy_if_throwing_move(const pointers& dst, const pointers& src,
+                                      size_t count, size_t& copied) {
+        using T = field_type<I>;
+        if constexpr (detail::relocate_by_copy_v<T>) {
+            detail::copy_into_arr(std::get<I>(dst),
+                                  static_cast<const T*>(std::get<I>(src)),
+                                  count);
+        }
+        copied++;
+    }
+    template <size_t I>
+    static void destroy_copy(const pointers& dst, size_t count,
+                             size_t copied) {
+        if constexpr (detail::relocate_by_copy_v<field_type<I>>) {
+            if (I < copied) {
+                detail::destroy_arr_elements(std::get<I>(dst), count);
+            }
+        }
+    }
+    template <size_t I>
+    static void finish_relocate(const pointers& dst, const pointers& src,
+                                size_t count) {
+        if constexpr (detail::relocate_by_copy_v<field_type<I>>) {
+            detail::destroy_arr_elements(std::get<I>(src), count);
+        }
+        else {
+            detail::relocate_arr(std::get<I>(dst), std::get<I>(src), count);
+        }
+    }
+
+    // The new row goes into the new block before anything is relocated,
+    // same as fun::vector, so args may alias our own rows
+    template <typename... Args> void realloc_emplace_back(Args&&... args) {
+        size_t new_capacity =
+            Growth::next_capacity(capacity_, size_ + 1, row_size);
+        pointers cols = alloc_columns(new_capacity);
+        try {
+            construct_row(cols, size_, std::forward<Args>(args)...);
+        }
+        catch (...) {
+            free_columns(cols, new_capacity);
+            throw;
+        }
+        try {
+            relocate_columns(cols, cols_, size_);
+        }
+        catch (...) {
+            std::apply(
+                [&](auto*... col) {
+                    (detail::destroy_arr_elements(col + size_, 1), ...);
+                },
+                cols);
+            free_columns(cols, new_capacity);
+            throw;
+        }
+
+        free_columns(cols_, capacity_);
+        cols_ = cols;
+        capacity_ = new_capacity;
+        size_++;
+    }
+};
+
+template <typename... Fields>
+using soa_vector = basic_soa_vector<doubling_growth, Fields...>;
+
+}; // namespace fun
@@ -0,0 +1,131 @@
+#include "soa_vector.hpp"
+#include "vector.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <random>
+
+/*
+    The same 64 byte particle stored as a fun::vector<particle> (AoS) and as
+    a fun::soa_vector with one column per member (SoA).
+
+    Sum adds up one float field, Filter counts the rows whose mass passes a
+    threshold and sums their ids (two fields), Update does x += vx * dt.
+    AoS streams the whole 64 byte row for each 4-8 bytes it uses, SoA only
+    the columns it touches and the loops vectorize.
+*/
+struct particle {
+    double x, y, z;
+    double vx, vy, vz;
+    float mass;
+    uint32_t id;
+};
+static_assert(sizeof(particle) == 56 || sizeof(particle) == 64);
+
+using particle_soa = fun::soa_vector<double, double, double, double, double,
+                                     double, float, uint32_t>;
+enum : size_t { X, Y, Z, VX, VY, VZ, MASS, ID };
+
+static fun::vector<particle> make_aos(size_t n) {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    fun::vector<particle> v;
+    v.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        const double d = dist(rng);
+        v.push_back({d, d, d, d, d, d, dist(rng), static_cast<uint32_t>(i)});
+    }
+    return v;
+}
+
+static particle_soa make_soa(size_t n) {
+    particle_soa v;
+    v.reserve(n);
+    for (const particle& p : make_aos(n)) {
+        v.emplace_back(p.x, p.y, p.z, p.vx, p.vy, p.vz, p.mass, p.id);
+    }
+    return v;
+}
+
+static void BM_SumAoS(benchmark::State& state) {
+    const auto v = make_aos(state.range(0));
+    for (auto _ : state) {
+        float sum = 0.0f;
+        for (const particle& p : v) {
+            sum += p.mass;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * v.size());
+}
+
+static void BM_SumSoA(benchmark::State& state) {
+    const auto v = make_soa(state.range(0));
+    for (auto _ : state) {
+        float sum = 0.0f;
+        for (float m : v.field<MASS>()) {
+            sum += m;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * v.size());
+}
+
+static void BM_FilterAoS(benchmark::State& state) {
+    const auto v = make_aos(state.range(0));
+    for (auto _ : state) {
+        uint64_t ids = 0;
+        for (const particle& p : v) {
+            ids += p.mass > 0.5f ? p.id : 0;
+        }
+        benchmark::DoNotOptimize(ids);
+    }
+    state.SetItemsProcessed(state.iterations() * v.size());
+}
+
+static void BM_FilterSoA(benchmark::State& state) {
+    const auto v = make_soa(state.range(0));
+    const float* mass = v.data<MASS>();
+    const uint32_t* id = v.data<ID>();
+    for (auto _ : state) {
+        uint64_t ids = 0;
+        for (size_t i = 0; i < v.size(); i++) {
+            ids += mass[i] > 0.5f ? id[i] : 0;
+        }
+        benchmark::DoNotOptimize(ids);
+    }
+    state.SetItemsProcessed(state.iterations() * v.size());
+}
+
+static void BM_UpdateAoS(benchmark::State& state) {
+    auto v = make_aos(state.range(0));
+    for (auto _ : state) {
+        for (particle& p : v) {
+            p.x += p.vx * 0.01;
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * v.size());
+}
+
+static void BM_UpdateSoA(benchmark::State& state) {
+    auto v = make_soa(state.range(0));
+    for (auto _ : state) {
+        double* x = v.data<X>();
+        const double* vx = v.data<VX>();
+        for (size_t i = 0; i < v.size(); i++) {
+            x[i] += vx[i] * 0.01;
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * v.size());
+}
+
+// L1/L2 sized, L3 sized, and main memory
+#define SOA_SIZES ->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 22)
+
+BENCHMARK(BM_SumAoS) SOA_SIZES;
+BENCHMARK(BM_SumSoA) SOA_SIZES;
+BENCHMARK(BM_FilterAoS) SOA_SIZES;
+BENCHMARK(BM_FilterSoA) SOA_SIZES;
+BENCHMARK(BM_UpdateAoS) SOA_SIZES;
+BENCHMARK(BM_UpdateSoA) SOA_SIZES;
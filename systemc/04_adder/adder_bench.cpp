@@ -0,0 +1,97 @@
+#include "sc_bench.hpp"
+#include "wide_adder.hpp"
+#include <benchmark/benchmark.h>
+#include <random>
+
+/*
+    Adds per wall-clock second and delta cycles per add, for each adder
+    model at 8, 32 and 64 bits. Every add is a fresh random a and b, then
+    1 ns for the model to settle, the same way main.cpp drives them.
+
+    deltas/add counts every delta cycle the kernel ran, including the one
+    each new time step starts with, so WordAdder is the floor. RippleAdder
+    grows with N, CarryLookaheadAdder shouldn't.
+
+    Each rig's driver sits idle until its benchmark asks it for adds.
+*/
+template <typename Model, size_t N> class Rig : public sc_module {
+public:
+    sc_signal<sc_uint<N>> a, b, sum;
+    sc_signal<bool> cin, cout;
+    Model dut;
+
+    SC_HAS_PROCESS(Rig);
+    Rig(sc_module_name name) : sc_module(name), dut("dut") {
+        dut.a(a);
+        dut.b(b);
+        dut.cin(cin);
+        dut.sum(sum);
+        dut.cout(cout);
+        SC_THREAD(drive);
+    }
+
+    // Runs adds adds to completion
+    void run(uint64_t adds) {
+        pending_ = adds;
+        go_.notify(SC_ZERO_TIME);
+        sc_start();
+    }
+
+private:
+    uint64_t pending_ = 0;
+    sc_event go_;
+    std::mt19937_64 rng_{1};
+
+    void drive() {
+        while (true) {
+            wait(go_);
+            for (; pending_ > 0; pending_--) {
+                a.write(rng_());
+                b.write(rng_());
+                cin.write(rng_() & 1);
+                wait(1, SC_NS);
+            }
+        }
+    }
+};
+
+static constexpr uint64_t batch = 1024;
+
+template <typename R> static void BM_Add(benchmark::State& state) {
+    R& rig = *instance<R>();
+    const sc_dt::uint64 deltas = sc_delta_count();
+    for (auto _ : state) {
+        rig.run(batch);
+    }
+    const uint64_t adds = state.iterations() * batch;
+    state.SetItemsProcessed(adds);
+    state.counters["deltas/add"] =
+        double(sc_delta_count() - deltas) / double(adds);
+}
+
+#define ADDER_BENCH(N)                                                        \
+    BENCHMARK_TEMPLATE(BM_Add, Rig<RippleAdder<N>, N>);                       \
+    BENCHMARK_TEMPLATE(BM_Add, Rig<CarryLookaheadAdder<N>, N>);               \
+    BENCHMARK_TEMPLATE(BM_Add, Rig<WordAdder<N>, N>)
+
+ADDER_BENCH(8);
+ADDER_BENCH(32);
+ADDER_BENCH(64);
+
+int sc_main(int argc, char* argv[]) {
+    auto ripple8 = build<Rig<RippleAdder<8>, 8>>("ripple8");
+    auto cla8 = build<Rig<CarryLookaheadAdder<8>, 8>>("cla8");
+    auto word8 = build<Rig<WordAdder<8>, 8>>("word8");
+    auto ripple32 = build<Rig<RippleAdder<32>, 32>>("ripple32");
+    auto cla32 = build<Rig<CarryLookaheadAdder<32>, 32>>("cla32");
+    auto word32 = build<Rig<WordAdder<32>, 32>>("word32");
+    auto ripple64 = build<Rig<RippleAdder<64>, 64>>("ripple64");
+    auto cla64 = build<Rig<CarryLookaheadAdder<64>, 64>>("cla64");
+    auto word64 = build<Rig<WordAdder<64>, 64>>("word64");
+    sc_start(SC_ZERO_TIME);
+
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
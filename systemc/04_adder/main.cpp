@@ -1,5 +1,8 @@
 #include "adder.hpp"
+#include "wide_adder.hpp"
+#include <random>
 #include <sstream>
+#include <string>
 
 static void expect(const char* name, bool got_sum, bool got_cout, bool exp_sum,
                    bool exp_cout, bool a, bool b, bool cin) {
@@ -13,6 +16,69 @@ static void expect(const char* name, bool got_sum, bool got_cout, bool exp_sum,
     }
 }
 
+/*
+    The three N bit adders side by side on the same inputs, each add is
+    checked against an sc_biguint<N + 1> sum.
+*/
+template <size_t N> struct WideBench {
+    sc_signal<sc_uint<N>> a, b;
+    sc_signal<bool> cin;
+    sc_signal<sc_uint<N>> ripple_sum, cla_sum, word_sum;
+    sc_signal<bool> ripple_cout, cla_cout, word_cout;
+    RippleAdder<N> ripple;
+    CarryLookaheadAdder<N> cla;
+    WordAdder<N> word;
+
+    WideBench(const std::string& name)
+        : ripple{(name + "_ripple").c_str()}, cla{(name + "_cla").c_str()},
+          word{(name + "_word").c_str()} {
+        bind(ripple, ripple_sum, ripple_cout);
+        bind(cla, cla_sum, cla_cout);
+        bind(word, word_sum, word_cout);
+    }
+
+    template <typename Model>
+    void bind(Model& m, sc_signal<sc_uint<N>>& sum, sc_signal<bool>& cout) {
+        m.a(a);
+        m.b(b);
+        m.cin(cin);
+        m.sum(sum);
+        m.cout(cout);
+    }
+
+    void check(uint64_t av, uint64_t bv, bool c) {
+        a = av;
+        b = bv;
+        cin = c;
+        sc_start(1, SC_NS);
+
+        sc_biguint<N + 1> r = a.read().to_uint64();
+        r += b.read().to_uint64();
+        r += int(c);
+        const sc_uint<N> exp_sum = r.range(N - 1, 0).to_uint64();
+        const bool exp_cout = r[N];
+
+        check_one("RippleAdder", ripple_sum, ripple_cout, exp_sum, exp_cout);
+        check_one("CarryLookaheadAdder", cla_sum, cla_cout, exp_sum,
+                  exp_cout);
+        check_one("WordAdder", word_sum, word_cout, exp_sum, exp_cout);
+    }
+
+    void check_one(const char* model, const sc_signal<sc_uint<N>>& sum,
+                   const sc_signal<bool>& cout, const sc_uint<N>& exp_sum,
+                   bool exp_cout) {
+        if (sum.read() != exp_sum || cout.read() != exp_cout) {
+            std::ostringstream oss;
+            oss << model << "<" << N << "> FAIL @ " << sc_time_stamp()
+                << "  a=" << a.read() << " b=" << b.read()
+                << " cin=" << cin.read() << "  got(sum=" << sum.read()
+                << ", cout=" << cout.read() << ")  exp(sum=" << exp_sum
+                << ", cout=" << exp_cout << ")";
+            SC_REPORT_ERROR("TB", oss.str().c_str());
+        }
+    }
+};
+
 int sc_main(int argc, char* argv[]) {
     sc_signal<bool> a, b, cin;
     sc_signal<bool> sum, cout;
@@ -24,6 +90,10 @@ int sc_main(int argc, char* argv[]) {
     adder.sum(sum);
     adder.cout(cout);
 
+    WideBench<4> wide4{"wide4"};
+    WideBench<32> wide32{"wide32"};
+    WideBench<64> wide64{"wide64"};
+
     struct Vec {
         bool a, b, cin, sum, cout;
     };
@@ -44,6 +114,34 @@ int sc_main(int argc, char* argv[]) {
                t.cin);
     }
 
+    // Every 4 bit add, then random and carry-chain corner cases wider
+    for (uint64_t x = 0; x < 16; x++) {
+        for (uint64_t y = 0; y < 16; y++) {
+            wide4.check(x, y, false);
+            wide4.check(x, y, true);
+        }
+    }
+
+    const uint64_t ones = ~uint64_t{0};
+    const uint64_t corners[][2] = {
+        {0, 0}, {ones, 1}, {ones, 0}, {ones, ones}, {1ull << 31, 1ull << 31},
+        {0x5555555555555555ull, 0xaaaaaaaaaaaaaaaaull}, {1ull << 63, 1},
+    };
+    for (const auto& c : corners) {
+        for (bool cin_v : {false, true}) {
+            wide32.check(c[0] & 0xffffffffull, c[1] & 0xffffffffull, cin_v);
+            wide64.check(c[0], c[1], cin_v);
+        }
+    }
+
+    std::mt19937_64 rng(1);
+    for (int i = 0; i < 2000; i++) {
+        const uint64_t x = rng(), y = rng();
+        const bool c = rng() & 1;
+        wide32.check(x & 0xffffffffull, y & 0xffffffffull, c);
+        wide64.check(x, y, c);
+    }
+
     printf("All adder test cases passed\n");
 
     return 0;
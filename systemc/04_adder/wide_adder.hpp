@@ -0,0 +1,252 @@
+#pragma once
+#include "adder.hpp"
+#include <systemc.h>
+
+/*
+    N bit adders at three levels of abstraction, all with the same ports so
+    they drop in for each other:
+
+        a, b : sc_uint<N>   cin : bool   ->   sum : sc_uint<N>   cout : bool
+
+    RippleAdder<N>          N Adders from adder.hpp, carry chained bit to
+                            bit. Up to N + 2 delta cycles per add, the
+                            carry has to walk the whole chain.
+    CarryLookaheadAdder<N>  4 bit blocks that each work out propagate and
+                            generate, one lookahead unit turns those into
+                            every block's carry at once. About 5 delta
+                            cycles whatever N is.
+    WordAdder<N>            a + b + cin in one process, one delta cycle.
+
+    N is at most 64 (sc_uint), the lookahead one also wants a multiple of 4.
+*/
+template <size_t N> class RippleAdder : public sc_module {
+public:
+    static_assert(N >= 1 && N <= 64, "1 to 64 bits");
+
+    sc_in<sc_uint<N>> a;
+    sc_in<sc_uint<N>> b;
+    sc_in<bool> cin;
+    sc_out<sc_uint<N>> sum;
+    sc_out<bool> cout;
+
+    SC_CTOR(RippleAdder)
+        : bits_{"bit", N}, a_{"a", N}, b_{"b", N}, s_{"s", N},
+          c_{"c", N} {
+        for (size_t i = 0; i < N; i++) {
+            bits_[i].a(a_[i]);
+            bits_[i].b(b_[i]);
+            if (i == 0) {
+                bits_[i].cin(cin);
+            }
+            else {
+                bits_[i].cin(c_[i - 1]);
+            }
+            bits_[i].sum(s_[i]);
+            bits_[i].cout(c_[i]);
+        }
+
+        // Fan the words out to the bit adders, and collect the sum bits
+        SC_METHOD(split);
+        sensitive << a << b;
+        dont_initialize();
+
+        SC_METHOD(join);
+        for (size_t i = 0; i < N; i++) {
+            sensitive << s_[i];
+        }
+        sensitive << c_[N - 1];
+        dont_initialize();
+    }
+
+private:
+    sc_vector<Adder> bits_;
+    sc_vector<sc_signal<bool>> a_, b_, s_, c_;
+
+    void split() {
+        const sc_uint<N> av = a.read();
+        const sc_uint<N> bv = b.read();
+        for (size_t i = 0; i < N; i++) {
+            a_[i].write(av[i]);
+            b_[i].write(bv[i]);
+        }
+    }
+
+    void join() {
+        sc_uint<N> s = 0;
+        for (size_t i = 0; i < N; i++) {
+            s[i] = s_[i].read();
+        }
+        sum.write(s);
+        cout.write(c_[N - 1].read());
+    }
+};
+
+/*
+    One 4 bit lookahead block. p and g say whether the block propagates a
+    carry through or generates one on its own, they only depend on a and b.
+    The sums wait for the block's carry in.
+
+    P = p3 p2 p1 p0
+    G = g3 | p3 g2 | p3 p2 g1 | p3 p2 p1 g0
+*/
+class ClaBlock : public sc_module {
+public:
+    sc_in<sc_uint<4>> a;
+    sc_in<sc_uint<4>> b;
+    sc_in<bool> cin;
+    sc_out<bool> p;
+    sc_out<bool> g;
+    sc_out<sc_uint<4>> sum;
+
+    SC_CTOR(ClaBlock) {
+        SC_METHOD(eval_pg);
+        sensitive << a << b;
+        dont_initialize();
+
+        SC_METHOD(eval_sum);
+        sensitive << a << b << cin;
+        dont_initialize();
+    }
+
+private:
+    static bool bit(unsigned x, int i) { return (x >> i) & 1; }
+
+    void eval_pg() {
+        const unsigned pi = a.read() ^ b.read();
+        const unsigned gi = a.read() & b.read();
+        p.write(pi == 0xF);
+        g.write(bit(gi, 3) || (bit(pi, 3) && bit(gi, 2)) ||
+                (bit(pi, 3) && bit(pi, 2) && bit(gi, 1)) ||
+                (bit(pi, 3) && bit(pi, 2) && bit(pi, 1) && bit(gi, 0)));
+    }
+
+    void eval_sum() {
+        const unsigned pi = a.read() ^ b.read();
+        const unsigned gi = a.read() & b.read();
+        unsigned s = 0;
+        bool c = cin.read();
+        for (int i = 0; i < 4; i++) {
+            s |= unsigned(bit(pi, i) != c) << i;
+            c = bit(gi, i) || (bit(pi, i) && c);
+        }
+        sum.write(s);
+    }
+};
+
+template <size_t N> class CarryLookaheadAdder : public sc_module {
+public:
+    static_assert(N >= 4 && N <= 64 && N % 4 == 0,
+                  "4 to 64 bits, a multiple of 4");
+    static constexpr size_t blocks = N / 4;
+
+    sc_in<sc_uint<N>> a;
+    sc_in<sc_uint<N>> b;
+    sc_in<bool> cin;
+    sc_out<sc_uint<N>> sum;
+    sc_out<bool> cout;
+
+    SC_CTOR(CarryLookaheadAdder)
+        : blocks_{"block", blocks}, a_{"a", blocks}, b_{"b", blocks},
+          s_{"s", blocks}, p_{"p", blocks}, g_{"g", blocks},
+          c_{"c", blocks} {
+        for (size_t i = 0; i < blocks; i++) {
+            blocks_[i].a(a_[i]);
+            blocks_[i].b(b_[i]);
+            if (i == 0) {
+                blocks_[i].cin(cin);
+            }
+            else {
+                blocks_[i].cin(c_[i]);
+            }
+            blocks_[i].p(p_[i]);
+            blocks_[i].g(g_[i]);
+            blocks_[i].sum(s_[i]);
+        }
+
+        SC_METHOD(split);
+        sensitive << a << b;
+        dont_initialize();
+
+        // The lookahead unit, every block's carry from cin, P and G
+        SC_METHOD(lookahead);
+        sensitive << cin;
+        for (size_t i = 0; i < blocks; i++) {
+            sensitive << p_[i] << g_[i];
+        }
+        dont_initialize();
+
+        SC_METHOD(join);
+        for (size_t i = 0; i < blocks; i++) {
+            sensitive << s_[i];
+        }
+        dont_initialize();
+    }
+
+private:
+    sc_vector<ClaBlock> blocks_;
+    sc_vector<sc_signal<sc_uint<4>>> a_, b_, s_;
+    // c_[i] is block i's carry in, c_[0] goes unused (block 0 takes cin)
+    sc_vector<sc_signal<bool>> p_, g_, c_;
+
+    void split() {
+        const sc_uint<N> av = a.read();
+        const sc_uint<N> bv = b.read();
+        for (size_t i = 0; i < blocks; i++) {
+            a_[i].write(av.range(4 * i + 3, 4 * i));
+            b_[i].write(bv.range(4 * i + 3, 4 * i));
+        }
+    }
+
+    void lookahead() {
+        bool c = cin.read();
+        for (size_t i = 0; i < blocks; i++) {
+            if (i > 0) {
+                c_[i].write(c);
+            }
+            c = g_[i].read() | (p_[i].read() & c);
+        }
+        cout.write(c);
+    }
+
+    void join() {
+        sc_uint<N> s = 0;
+        for (size_t i = 0; i < blocks; i++) {
+            s.range(4 * i + 3, 4 * i) = s_[i].read();
+        }
+        sum.write(s);
+    }
+};
+
+template <size_t N> class WordAdder : public sc_module {
+public:
+    static_assert(N >= 1 && N <= 64, "1 to 64 bits");
+
+    sc_in<sc_uint<N>> a;
+    sc_in<sc_uint<N>> b;
+    sc_in<bool> cin;
+    sc_out<sc_uint<N>> sum;
+    sc_out<bool> cout;
+
+    SC_CTOR(WordAdder) {
+        SC_METHOD(eval);
+        sensitive << a << b << cin;
+        dont_initialize();
+    }
+
+private:
+    void eval() {
+        const uint64_t av = a.read().to_uint64();
+        const uint64_t bv = b.read().to_uint64();
+        const uint64_t s = av + bv + cin.read();
+
+        sum.write(s);
+        if constexpr (N == 64) {
+            // s < a means it wrapped, s == a with b or cin set means b + cin
+            // was exactly 2^64
+            cout.write(s < av || (s == av && (bv != 0 || cin.read())));
+        }
+        else {
+            cout.write((s >> N) & 1);
+        }
+    }
+};
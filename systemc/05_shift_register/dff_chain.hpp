@@ -0,0 +1,33 @@
+#pragma once
+#include "../02_dff/dff.hpp"
+#include <systemc.h>
+
+/*
+The same serial-in shift register built the obvious way, N DFFs from
+02_dff with stage i's q feeding stage i + 1's d. That's N processes and N
+signals per clock edge, kept around as the reference for ShiftRegister.
+*/
+template <size_t N> class DffChain : public sc_module {
+public:
+    sc_in<bool> clk;
+    sc_in<bool> serial_in;
+
+    SC_CTOR(DffChain) : stages_{"stage", N}, q_{"q", N} {
+        for (size_t i = 0; i < N; i++) {
+            stages_[i].clock(clk);
+            if (i == 0) {
+                stages_[i].d(serial_in);
+            }
+            else {
+                stages_[i].d(q_[i - 1]);
+            }
+            stages_[i].q(q_[i]);
+        }
+    }
+
+    bool bit(size_t i) const { return q_[i].read(); }
+
+private:
+    sc_vector<DFF> stages_;
+    sc_vector<sc_signal<bool>> q_;
+};
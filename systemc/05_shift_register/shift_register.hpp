@@ -0,0 +1,56 @@
+#pragma once
+#include <systemc.h>
+#include <type_traits>
+
+/*
+N bit shift register, the whole state is one word updated by one process
+
+Bit 0 is the stage closest to serial_in, bit N-1 the one that falls out to
+serial_out, so it matches a chain of N DFFs where stage i is bit i. Up to 64
+bits the word is an sc_uint, past that an sc_biguint.
+
+On every rising edge, in priority order:
+    reset -> all zeros
+    load  -> parallel_in
+    else  -> shift up by one, serial_in into bit 0
+*/
+template <size_t N>
+using shift_word = std::conditional_t<(N <= 64), sc_uint<N>, sc_biguint<N>>;
+
+template <size_t N> class ShiftRegister : public sc_module {
+public:
+    // Ports
+    sc_in<bool> clk;
+    sc_in<bool> reset;
+    sc_in<bool> load;
+    sc_in<bool> serial_in;
+    sc_in<shift_word<N>> parallel_in;
+    sc_out<shift_word<N>> parallel_out;
+    sc_out<bool> serial_out;
+
+    SC_CTOR(ShiftRegister) : state_{0} {
+        SC_METHOD(on_edge);
+        sensitive << clk.pos();
+        dont_initialize();
+    }
+
+private:
+    // Internal register, stage i is bit i
+    shift_word<N> state_;
+
+    void on_edge() {
+        if (reset.read()) {
+            state_ = 0;
+        }
+        else if (load.read()) {
+            state_ = parallel_in.read();
+        }
+        else {
+            state_ = state_ << 1;
+            state_[0] = serial_in.read();
+        }
+
+        parallel_out.write(state_);
+        serial_out.write(state_[N - 1]);
+    }
+};
@@ -0,0 +1,107 @@
+#include "dff_chain.hpp"
+#include "sc_bench.hpp"
+#include "shift_register.hpp"
+#include <benchmark/benchmark.h>
+
+/*
+    Simulated clock edges per wall-clock second, packed ShiftRegister<N>
+    against a chain of N DFFs, for N = 8, 64 and 256. The chain pays N
+    process activations and N signal updates per edge, the packed register
+    one of each, so the gap should open up roughly linearly with N.
+
+    Each design has its own ClockGen, parked while the others run.
+*/
+
+// Feeds an alternating bit pattern in so every stage toggles
+class Pattern : public sc_module {
+public:
+    sc_in<bool> clk;
+    sc_out<bool> bit;
+
+    SC_CTOR(Pattern) {
+        SC_METHOD(on_edge);
+        sensitive << clk.pos();
+        dont_initialize();
+    }
+
+private:
+    void on_edge() { bit.write(!bit.read()); }
+};
+
+template <size_t N> struct Packed {
+    ClockGen gen;
+    Pattern pattern;
+    sc_signal<bool> low, serial_in, serial_out;
+    sc_signal<shift_word<N>> parallel_in, parallel_out;
+    ShiftRegister<N> reg;
+
+    Packed()
+        : gen{sc_gen_unique_name("packed_clk")},
+          pattern{sc_gen_unique_name("packed_pattern")},
+          reg{sc_gen_unique_name("packed")} {
+        pattern.clk(gen.clk);
+        pattern.bit(serial_in);
+        reg.clk(gen.clk);
+        reg.reset(low);
+        reg.load(low);
+        reg.serial_in(serial_in);
+        reg.parallel_in(parallel_in);
+        reg.parallel_out(parallel_out);
+        reg.serial_out(serial_out);
+    }
+};
+
+template <size_t N> struct Chained {
+    ClockGen gen;
+    Pattern pattern;
+    sc_signal<bool> serial_in;
+    DffChain<N> chain;
+
+    Chained()
+        : gen{sc_gen_unique_name("chained_clk")},
+          pattern{sc_gen_unique_name("chained_pattern")},
+          chain{sc_gen_unique_name("chained")} {
+        pattern.clk(gen.clk);
+        pattern.bit(serial_in);
+        chain.clk(gen.clk);
+        chain.serial_in(serial_in);
+    }
+};
+
+// Simulated time per iteration, 10k clock edges
+static sc_time slice() { return sc_time(100, SC_US); }
+
+template <typename Design>
+static void BM_Edges(benchmark::State& state) {
+    Design& design = *instance<Design>();
+    const uint64_t before = design.gen.edges();
+    design.gen.enable(true);
+    for (auto _ : state) {
+        sc_start(slice());
+    }
+    design.gen.enable(false);
+    state.SetItemsProcessed(design.gen.edges() - before);
+}
+
+#define SHIFT_BENCH(N)                                                        \
+    BENCHMARK_TEMPLATE(BM_Edges, Packed<N>)->Unit(benchmark::kMillisecond);  \
+    BENCHMARK_TEMPLATE(BM_Edges, Chained<N>)->Unit(benchmark::kMillisecond)
+
+SHIFT_BENCH(8);
+SHIFT_BENCH(64);
+SHIFT_BENCH(256);
+
+int sc_main(int argc, char* argv[]) {
+    auto packed8 = build<Packed<8>>();
+    auto chained8 = build<Chained<8>>();
+    auto packed64 = build<Packed<64>>();
+    auto chained64 = build<Chained<64>>();
+    auto packed256 = build<Packed<256>>();
+    auto chained256 = build<Chained<256>>();
+    sc_start(SC_ZERO_TIME);
+
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
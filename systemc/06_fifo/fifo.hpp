@@ -0,0 +1,146 @@
+#pragma once
+#include <systemc.h>
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+/*
+    A bounded FIFO between two clock domains. The storage is one ring of
+    depth words inside the module, not a signal per element, so a push or
+    pop is an array store plus a handful of flag writes.
+
+    Producer side, on wclk: a word is pushed on every rising edge where
+    wr_en is high. full and almost_full are registered here, after the push.
+    Consumer side, on rclk: with rd_en high and something stored, the head
+    is popped to rdata and rvalid goes high for that cycle. empty is
+    registered here.
+
+    Each flag only updates on its own clock, so it lags whatever the other
+    side did since, but always in the safe direction (full may stay up a
+    little after a pop, empty after a push). A producer that decides off a
+    registered flag has a word in flight, which is what almost_full is for:
+    it defaults to depth - 1 so stopping on it never overflows.
+*/
+struct FifoStats {
+    uint64_t writes = 0;
+    uint64_t reads = 0;
+    // Writes dropped because the ring was full
+    uint64_t overflows = 0;
+    // wclk edges with almost_full up, rclk edges asking for a word with
+    // nothing stored
+    uint64_t backpressure_cycles = 0;
+    uint64_t starved_cycles = 0;
+    size_t high_water = 0;
+    // occupancy[n] is how many wclk edges ended with n words stored
+    std::vector<uint64_t> occupancy;
+
+    double mean_occupancy() const {
+        uint64_t samples = 0;
+        double sum = 0.0;
+        for (size_t n = 0; n < occupancy.size(); n++) {
+            samples += occupancy[n];
+            sum += double(n) * occupancy[n];
+        }
+        return samples == 0 ? 0.0 : sum / samples;
+    }
+
+    void print(std::ostream& out) const {
+        out << "writes " << writes << ", reads " << reads << ", overflows "
+            << overflows << "\n"
+            << "backpressure " << backpressure_cycles << " cycles, starved "
+            << starved_cycles << " cycles\n"
+            << "occupancy mean " << mean_occupancy() << ", high water "
+            << high_water << "\n";
+    }
+};
+
+template <unsigned Width = 32>
+class Fifo : public sc_module {
+public:
+    using word = sc_uint<Width>;
+
+    sc_in<bool> wclk;
+    sc_in<bool> wr_en;
+    sc_in<word> wdata;
+    sc_out<bool> full;
+    sc_out<bool> almost_full;
+
+    sc_in<bool> rclk;
+    sc_in<bool> rd_en;
+    sc_out<word> rdata;
+    sc_out<bool> rvalid;
+    sc_out<bool> empty;
+
+    SC_HAS_PROCESS(Fifo);
+    Fifo(sc_module_name name, size_t depth, size_t almost_full_at = 0)
+        : sc_module(name), ring_(depth),
+          almost_full_at_(almost_full_at == 0 ? depth - 1 : almost_full_at) {
+        if (depth < 2 || almost_full_at_ > depth) {
+            SC_REPORT_ERROR("Fifo", "depth must be at least 2, and "
+                                    "almost_full_at at most depth");
+        }
+        stats_.occupancy.assign(depth + 1, 0);
+        full.initialize(false);
+        almost_full.initialize(false);
+        rvalid.initialize(false);
+        empty.initialize(true);
+
+        SC_METHOD(on_wclk);
+        sensitive << wclk.pos();
+        dont_initialize();
+
+        SC_METHOD(on_rclk);
+        sensitive << rclk.pos();
+        dont_initialize();
+    }
+
+    size_t depth() const { return ring_.size(); }
+    size_t size() const { return count_; }
+    const FifoStats& stats() const { return stats_; }
+
+private:
+    std::vector<word> ring_;
+    size_t almost_full_at_;
+    size_t head_ = 0;
+    size_t tail_ = 0;
+    size_t count_ = 0;
+    FifoStats stats_;
+
+    void on_wclk() {
+        if (wr_en.read()) {
+            if (count_ == ring_.size()) {
+                stats_.overflows++;
+            }
+            else {
+                ring_[tail_] = wdata.read();
+                tail_ = tail_ + 1 == ring_.size() ? 0 : tail_ + 1;
+                count_++;
+                stats_.writes++;
+            }
+        }
+
+        const bool af = count_ >= almost_full_at_;
+        full.write(count_ == ring_.size());
+        almost_full.write(af);
+        stats_.backpressure_cycles += af;
+        stats_.high_water = std::max(stats_.high_water, count_);
+        stats_.occupancy[count_]++;
+    }
+
+    void on_rclk() {
+        const bool want = rd_en.read();
+        if (want && count_ > 0) {
+            rdata.write(ring_[head_]);
+            head_ = head_ + 1 == ring_.size() ? 0 : head_ + 1;
+            count_--;
+            stats_.reads++;
+            rvalid.write(true);
+        }
+        else {
+            rvalid.write(false);
+            stats_.starved_cycles += want;
+        }
+        empty.write(count_ == 0);
+    }
+};
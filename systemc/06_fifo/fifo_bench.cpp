@@ -0,0 +1,104 @@
+#include "fifo.hpp"
+#include "sc_bench.hpp"
+#include "traffic.hpp"
+#include <benchmark/benchmark.h>
+
+/*
+    Words moved per wall-clock second, one word per cycle on both sides of
+    a 16 deep FIFO:
+
+        Fifo    the clocked Fifo module, producer and consumer are
+                SC_METHODs on the clock, flags are signals
+        ScFifo  sc_fifo with an SC_THREAD on each side doing a blocking
+                write or read every clock edge
+
+    Each design has its own ClockGen, parked while the other one runs.
+*/
+
+class ScFifoPair : public sc_module {
+public:
+    sc_in<bool> clk;
+    sc_fifo<sc_uint<32>> fifo;
+
+    SC_HAS_PROCESS(ScFifoPair);
+    ScFifoPair(sc_module_name name) : sc_module(name), fifo("fifo", 16) {
+        SC_THREAD(produce);
+        sensitive << clk.pos();
+        SC_THREAD(consume);
+        sensitive << clk.pos();
+    }
+
+    uint64_t received() const { return received_; }
+
+private:
+    uint64_t received_ = 0;
+
+    void produce() {
+        sc_uint<32> seq = 0;
+        while (true) {
+            wait();
+            fifo.write(seq++);
+        }
+    }
+
+    void consume() {
+        while (true) {
+            wait();
+            benchmark::DoNotOptimize(fifo.read());
+            received_++;
+        }
+    }
+};
+
+static ClockGen* fifo_clock;
+static ClockGen* sc_fifo_clock;
+static Lane<32>* bench_lane;
+static ScFifoPair* bench_pair;
+
+// Simulated time per iteration, 10k cycles of 10 ns
+static sc_time slice() { return sc_time(100, SC_US); }
+
+static void BM_Fifo(benchmark::State& state) {
+    const uint64_t before = bench_lane->consumer.received();
+    fifo_clock->enable(true);
+    for (auto _ : state) {
+        sc_start(slice());
+    }
+    fifo_clock->enable(false);
+    state.SetItemsProcessed(bench_lane->consumer.received() - before);
+}
+
+static void BM_ScFifo(benchmark::State& state) {
+    const uint64_t before = bench_pair->received();
+    sc_fifo_clock->enable(true);
+    for (auto _ : state) {
+        sc_start(slice());
+    }
+    sc_fifo_clock->enable(false);
+    state.SetItemsProcessed(bench_pair->received() - before);
+}
+
+BENCHMARK(BM_Fifo)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ScFifo)->Unit(benchmark::kMillisecond);
+
+int sc_main(int argc, char* argv[]) {
+    ClockGen fifo_gen{"fifo_clock", sc_time(10, SC_NS)};
+    ClockGen sc_fifo_gen{"sc_fifo_clock", sc_time(10, SC_NS)};
+    Lane<32> fifo_lane{"lane", fifo_gen.clk, fifo_gen.clk, 16, 1, 0};
+    ScFifoPair sc_fifo_pair{"pair"};
+    sc_fifo_pair.clk(sc_fifo_gen.clk);
+
+    fifo_clock = &fifo_gen;
+    sc_fifo_clock = &sc_fifo_gen;
+    bench_lane = &fifo_lane;
+    bench_pair = &sc_fifo_pair;
+    sc_start(SC_ZERO_TIME);
+
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    std::cout << "Fifo: ";
+    fifo_lane.fifo.stats().print(std::cout);
+    return 0;
+}
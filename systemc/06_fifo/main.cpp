@@ -0,0 +1,123 @@
+#include "fifo.hpp"
+#include "traffic.hpp"
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+static void expect(const char* name, bool ok, const std::string& detail) {
+    if (!ok) {
+        std::ostringstream oss;
+        oss << name << " FAIL  " << detail;
+        SC_REPORT_ERROR("TB", oss.str().c_str());
+    }
+}
+
+/*
+    The producer runs at 10 ns in bursts of 32 words with 32 idle cycles
+    between them, one word per 20 ns on average. Each scenario gives the
+    consumer a different clock and every depth gets its own lane, so one
+    run sweeps the whole table. The deep lane's high water mark is the
+    occupancy the traffic really needs.
+
+    A consumer slower than the average (25 ns) can't keep up at any depth,
+    a deeper FIFO only postpones the stalls.
+*/
+static constexpr unsigned burst = 32;
+static constexpr unsigned gap = 32;
+static const size_t depths[] = {2, 4, 8, 16, 24, 32, 64};
+static constexpr size_t deep = 4096;
+
+struct Scenario {
+    unsigned consumer_ns;
+    bool keeps_up;
+    std::unique_ptr<sc_clock> rclk;
+    std::vector<std::unique_ptr<Lane<32>>> lanes;
+};
+
+int sc_main(int argc, char* argv[]) {
+    sc_clock wclk{"wclk", 10, SC_NS};
+
+    std::vector<Scenario> scenarios;
+    for (unsigned ns : {7, 10, 15, 20, 25}) {
+        scenarios.push_back({ns, ns <= 20, nullptr, {}});
+    }
+    for (Scenario& s : scenarios) {
+        const std::string name = "c" + std::to_string(s.consumer_ns);
+        s.rclk = std::make_unique<sc_clock>((name + "_clk").c_str(),
+                                            s.consumer_ns, SC_NS);
+        for (size_t depth : depths) {
+            s.lanes.push_back(std::make_unique<Lane<32>>(
+                name + "_d" + std::to_string(depth), wclk, *s.rclk, depth,
+                burst, gap));
+        }
+        s.lanes.push_back(std::make_unique<Lane<32>>(
+            name + "_deep", wclk, *s.rclk, deep, burst, gap));
+    }
+
+    sc_start(100, SC_US);
+
+    std::cout << "rate (prod/cons)  high water  min depth  stalls by depth\n";
+    for (const Scenario& s : scenarios) {
+        const auto& deepest = *s.lanes.back();
+        size_t min_depth = 0;
+        uint64_t prev_stalls = ~uint64_t{0};
+
+        std::ostringstream row;
+        for (const auto& lane : s.lanes) {
+            const std::string where = "consumer " +
+                                      std::to_string(s.consumer_ns) +
+                                      " ns, depth " +
+                                      std::to_string(lane->fifo.depth());
+            // Every word arrives once and in order, nothing is dropped
+            expect("integrity", lane->consumer.errors() == 0, where);
+            expect("overflow", lane->fifo.stats().overflows == 0, where);
+            expect("accounting",
+                   lane->producer.sent() == lane->fifo.stats().writes &&
+                       lane->consumer.received() == lane->fifo.stats().reads,
+                   where);
+            // More room never means more stalls for the same traffic
+            const uint64_t stalls = lane->producer.stalls();
+            expect("monotonic", stalls <= prev_stalls, where);
+            prev_stalls = stalls;
+
+            if (stalls == 0 && min_depth == 0) {
+                min_depth = lane->fifo.depth();
+            }
+            if (lane.get() != &deepest) {
+                row << " " << lane->fifo.depth() << ":" << stalls;
+            }
+        }
+
+        const std::string where =
+            "consumer " + std::to_string(s.consumer_ns) + " ns";
+        if (s.keeps_up) {
+            expect("keeps up", min_depth != 0 && min_depth != deep, where);
+            expect("high water", min_depth >= deepest.fifo.stats().high_water,
+                   where);
+        }
+        else {
+            expect("falls behind", min_depth == 0 || min_depth == deep,
+                   where);
+        }
+
+        std::cout << std::setw(8) << "20/" << std::left << std::setw(9)
+                  << s.consumer_ns << std::right << std::setw(11)
+                  << deepest.fifo.stats().high_water << std::setw(11);
+        if (min_depth == 0 || min_depth == deep) {
+            std::cout << "none";
+        }
+        else {
+            std::cout << min_depth;
+        }
+        std::cout << " " << row.str() << "\n";
+    }
+
+    std::cout << "\nmatched rates (20/20), depth " << deep << ":\n";
+    scenarios[3].lanes.back()->fifo.stats().print(std::cout);
+
+    printf("All fifo test cases passed\n");
+
+    return 0;
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include "fifo.hpp"
+#include <string>
+
+/*
+    Test traffic for Fifo. The producer sends numbered words in bursts of
+    burst cycles followed by gap idle cycles, holding off while almost_full
+    is up (a stall). The consumer reads every cycle of its own clock and
+    checks the numbers arrive in order, none lost or doubled.
+*/
+template <unsigned Width = 32>
+class Producer : public sc_module {
+public:
+    sc_in<bool> clk;
+    sc_in<bool> almost_full;
+    sc_out<bool> wr_en;
+    sc_out<sc_uint<Width>> wdata;
+
+    SC_HAS_PROCESS(Producer);
+    Producer(sc_module_name name, unsigned burst, unsigned gap)
+        : sc_module(name), burst_(burst), gap_(gap) {
+        wr_en.initialize(false);
+        SC_METHOD(on_clk);
+        sensitive << clk.pos();
+        dont_initialize();
+    }
+
+    uint64_t sent() const { return seq_; }
+    // Cycles it had a word to send but almost_full held it back
+    uint64_t stalls() const { return stalls_; }
+
+private:
+    unsigned burst_;
+    unsigned gap_;
+    unsigned phase_ = 0;
+    uint64_t seq_ = 0;
+    uint64_t stalls_ = 0;
+
+    void on_clk() {
+        if (phase_ < burst_) {
+            if (almost_full.read()) {
+                wr_en.write(false);
+                stalls_++;
+                return;
+            }
+            wr_en.write(true);
+            wdata.write(seq_++);
+        }
+        else {
+            wr_en.write(false);
+        }
+        phase_ = phase_ + 1 == burst_ + gap_ ? 0 : phase_ + 1;
+    }
+};
+
+template <unsigned Width = 32>
+class Consumer : public sc_module {
+public:
+    sc_in<bool> clk;
+    sc_in<bool> rvalid;
+    sc_in<sc_uint<Width>> rdata;
+    sc_out<bool> rd_en;
+
+    SC_HAS_PROCESS(Consumer);
+    Consumer(sc_module_name name) : sc_module(name) {
+        rd_en.initialize(true);
+        SC_METHOD(on_clk);
+        sensitive << clk.pos();
+        dont_initialize();
+    }
+
+    uint64_t received() const { return received_; }
+    uint64_t errors() const { return errors_; }
+
+private:
+    sc_uint<Width> expected_ = 0;
+    uint64_t received_ = 0;
+    uint64_t errors_ = 0;
+
+    void on_clk() {
+        if (rvalid.read()) {
+            errors_ += rdata.read() != expected_;
+            expected_++;
+            received_++;
+        }
+    }
+};
+
+// A producer, a Fifo and a consumer wired up, on the clocks given
+template <unsigned Width = 32>
+struct Lane {
+    sc_signal<bool> wr_en, full, almost_full;
+    sc_signal<bool> rd_en, rvalid, empty;
+    sc_signal<sc_uint<Width>> wdata, rdata;
+    Fifo<Width> fifo;
+    Producer<Width> producer;
+    Consumer<Width> consumer;
+
+    Lane(const std::string& name, sc_signal_in_if<bool>& wclk,
+         sc_signal_in_if<bool>& rclk, size_t depth, unsigned burst,
+         unsigned gap)
+        : fifo((name + "_fifo").c_str(), depth),
+          producer((name + "_producer").c_str(), burst, gap),
+          consumer((name + "_consumer").c_str()) {
+        fifo.wclk(wclk);
+        fifo.wr_en(wr_en);
+        fifo.wdata(wdata);
+        fifo.full(full);
+        fifo.almost_full(almost_full);
+        fifo.rclk(rclk);
+        fifo.rd_en(rd_en);
+        fifo.rdata(rdata);
+        fifo.rvalid(rvalid);
+        fifo.empty(empty);
+
+        producer.clk(wclk);
+        producer.almost_full(almost_full);
+        producer.wr_en(wr_en);
+        producer.wdata(wdata);
+
+        consumer.clk(rclk);
+        consumer.rvalid(rvalid);
+        consumer.rdata(rdata);
+        consumer.rd_en(rd_en);
+    }
+};
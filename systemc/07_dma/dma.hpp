@@ -0,0 +1,203 @@
+#pragma once
+#define SC_INCLUDE_DYNAMIC_PROCESSES
+#include <systemc.h>
+#include <tlm.h>
+#include <tlm_utils/simple_initiator_socket.h>
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+/*
+    A descriptor-chained DMA engine, transaction level. It reads descriptors
+    from the memory on src, then copies each one's bytes from src to dst in
+    bursts of up to max_burst bytes. A burst is a single read transaction
+    and a single write transaction carrying the whole span.
+
+    Descriptors are 32 bytes in host byte order. next == 0 ends the chain,
+    so a descriptor can't follow another one from address 0.
+
+    Timing: each transaction costs the target's latency (annotated by the
+    memory) and then ceil(bytes / bus_width) cycles on one shared bus. Up to
+    max_outstanding bursts are in flight at once, their latencies overlap
+    but their beats queue for the bus. max_outstanding = 1 is the
+    latency-bound case, a large one shows whether the bus saturates.
+*/
+struct DmaDescriptor {
+    uint64_t src;
+    uint64_t dst;
+    uint32_t length;
+    uint32_t reserved;
+    uint64_t next;
+};
+static_assert(sizeof(DmaDescriptor) == 32, "descriptors are 32 bytes");
+
+struct DmaConfig {
+    size_t bus_width = 8;
+    sc_time cycle = sc_time(1, SC_NS);
+    size_t max_burst = 256;
+    size_t max_outstanding = 4;
+    // Decoding a descriptor, per descriptor
+    sc_time setup_latency = sc_time(10, SC_NS);
+};
+
+struct DmaStats {
+    uint64_t descriptors = 0;
+    uint64_t bursts = 0;
+    uint64_t bytes = 0;
+    // Time the bus spent moving beats, and time from start() to done
+    sc_time bus_busy = SC_ZERO_TIME;
+    sc_time elapsed = SC_ZERO_TIME;
+
+    // Bytes copied per simulated second
+    double bandwidth() const {
+        return elapsed == SC_ZERO_TIME ? 0.0 : bytes / elapsed.to_seconds();
+    }
+    double utilization() const {
+        return elapsed == SC_ZERO_TIME ? 0.0 : bus_busy / elapsed;
+    }
+
+    void print(std::ostream& out) const {
+        out << "descriptors: " << descriptors << ", bursts: " << bursts
+            << ", bytes: " << bytes << "\n"
+            << "elapsed:     " << elapsed << "\n"
+            << "bandwidth:   " << bandwidth() / 1e9 << " GB/s\n"
+            << "bus busy:    " << utilization() * 100.0 << "%\n";
+    }
+};
+
+struct DmaBurst {
+    uint64_t src;
+    uint64_t dst;
+    uint32_t length;
+};
+
+// sc_fifo wants to be able to print what it holds
+inline std::ostream& operator<<(std::ostream& out, const DmaBurst& b) {
+    return out << "burst " << b.length << "B " << b.src << " -> " << b.dst;
+}
+
+class Dma : public sc_module {
+public:
+    tlm_utils::simple_initiator_socket<Dma> src;
+    tlm_utils::simple_initiator_socket<Dma> dst;
+    // Notified once the last burst of a chain has been written
+    sc_event done;
+
+    SC_HAS_PROCESS(Dma);
+    Dma(sc_module_name name, const DmaConfig& config)
+        : sc_module(name), src("src"), dst("dst"), config_(config),
+          queue_("queue", 1) {
+        if (config.bus_width == 0 || config.max_burst == 0 ||
+            config.max_outstanding == 0) {
+            SC_REPORT_ERROR("Dma", "bus width, burst and outstanding "
+                                   "limits must be at least 1");
+        }
+        SC_THREAD(run);
+        for (size_t i = 0; i < config.max_outstanding; i++) {
+            sc_spawn([this] { worker(); }, sc_gen_unique_name("worker"));
+        }
+    }
+
+    // Kicks off the chain at descriptor, from sc_main or another process
+    void start(uint64_t descriptor) {
+        if (busy_) {
+            SC_REPORT_ERROR("Dma", "start() while a chain is running");
+        }
+        busy_ = true;
+        head_ = descriptor;
+        start_.notify(SC_ZERO_TIME);
+    }
+
+    bool busy() const { return busy_; }
+    const DmaConfig& config() const { return config_; }
+    const DmaStats& stats() const { return stats_; }
+
+private:
+    DmaConfig config_;
+    DmaStats stats_;
+    sc_fifo<DmaBurst> queue_;
+    sc_event start_;
+    sc_event burst_done_;
+    uint64_t head_ = 0;
+    uint64_t pending_ = 0;
+    bool busy_ = false;
+    sc_time bus_free_ = SC_ZERO_TIME;
+
+    void run() {
+        while (true) {
+            wait(start_);
+            const sc_time began = sc_time_stamp();
+
+            uint64_t next = head_;
+            do {
+                DmaDescriptor d;
+                transfer(src, tlm::TLM_READ_COMMAND, next,
+                         reinterpret_cast<unsigned char*>(&d), sizeof(d));
+                wait(config_.setup_latency);
+                stats_.descriptors++;
+
+                const uint64_t burst = config_.max_burst;
+                for (uint64_t off = 0; off < d.length; off += burst) {
+                    const uint64_t len =
+                        std::min<uint64_t>(burst, d.length - off);
+                    pending_++;
+                    queue_.write({d.src + off, d.dst + off,
+                                  static_cast<uint32_t>(len)});
+                }
+                next = d.next;
+            } while (next != 0);
+
+            while (pending_ > 0) {
+                wait(burst_done_);
+            }
+            stats_.elapsed += sc_time_stamp() - began;
+            busy_ = false;
+            done.notify();
+        }
+    }
+
+    void worker() {
+        std::vector<unsigned char> buffer(config_.max_burst);
+        while (true) {
+            const DmaBurst b = queue_.read();
+            transfer(src, tlm::TLM_READ_COMMAND, b.src, buffer.data(),
+                     b.length);
+            transfer(dst, tlm::TLM_WRITE_COMMAND, b.dst, buffer.data(),
+                     b.length);
+            stats_.bursts++;
+            stats_.bytes += b.length;
+            pending_--;
+            burst_done_.notify();
+        }
+    }
+
+    // One transaction, then its beats once the bus is free
+    void transfer(tlm_utils::simple_initiator_socket<Dma>& socket,
+                  tlm::tlm_command cmd, uint64_t addr, unsigned char* data,
+                  unsigned len) {
+        tlm::tlm_generic_payload trans;
+        trans.set_command(cmd);
+        trans.set_address(addr);
+        trans.set_data_ptr(data);
+        trans.set_data_length(len);
+        trans.set_streaming_width(len);
+        trans.set_byte_enable_ptr(nullptr);
+        trans.set_dmi_allowed(false);
+        trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+        sc_time delay = SC_ZERO_TIME;
+        socket->b_transport(trans, delay);
+        if (trans.is_response_error()) {
+            SC_REPORT_ERROR("Dma", trans.get_response_string().c_str());
+        }
+
+        const size_t beats = (len + config_.bus_width - 1) / config_.bus_width;
+        const sc_time on_bus = static_cast<double>(beats) * config_.cycle;
+        const sc_time ready = sc_time_stamp() + delay;
+        const sc_time begin = std::max(ready, bus_free_);
+        bus_free_ = begin + on_bus;
+        stats_.bus_busy += on_bus;
+        wait(bus_free_ - sc_time_stamp());
+    }
+};
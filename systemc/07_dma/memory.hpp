@@ -0,0 +1,69 @@
+#pragma once
+#include <systemc.h>
+#include <tlm.h>
+#include <tlm_utils/simple_target_socket.h>
+#include <cstring>
+#include <vector>
+
+/*
+    A flat byte-addressed memory as a TLM-2.0 target. Reads and writes of
+    any length are one memcpy, each transaction adds a fixed latency to the
+    delay argument (the bus transfer itself is the initiator's business).
+
+    Out of range accesses come back as TLM_ADDRESS_ERROR_RESPONSE, byte
+    enables aren't supported. data() is the backdoor for testbenches.
+*/
+class Memory : public sc_module {
+public:
+    tlm_utils::simple_target_socket<Memory> socket;
+
+    Memory(sc_module_name name, size_t size,
+           sc_time read_latency = sc_time(20, SC_NS),
+           sc_time write_latency = sc_time(10, SC_NS))
+        : sc_module(name), socket("socket"), store_(size),
+          read_latency_(read_latency), write_latency_(write_latency) {
+        socket.register_b_transport(this, &Memory::b_transport);
+        socket.register_transport_dbg(this, &Memory::transport_dbg);
+    }
+
+    unsigned char* data() { return store_.data(); }
+    size_t size() const { return store_.size(); }
+
+private:
+    std::vector<unsigned char> store_;
+    sc_time read_latency_;
+    sc_time write_latency_;
+
+    // Copies and returns the number of bytes moved, 0 on an error response
+    unsigned access(tlm::tlm_generic_payload& trans) {
+        const uint64_t addr = trans.get_address();
+        const unsigned len = trans.get_data_length();
+        if (addr > store_.size() || len > store_.size() - addr) {
+            trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+            return 0;
+        }
+        if (trans.get_byte_enable_ptr() != nullptr ||
+            trans.get_streaming_width() < len) {
+            trans.set_response_status(tlm::TLM_BURST_ERROR_RESPONSE);
+            return 0;
+        }
+
+        if (trans.is_read()) {
+            std::memcpy(trans.get_data_ptr(), &store_[addr], len);
+        }
+        else if (trans.is_write()) {
+            std::memcpy(&store_[addr], trans.get_data_ptr(), len);
+        }
+        trans.set_response_status(tlm::TLM_OK_RESPONSE);
+        return len;
+    }
+
+    void b_transport(tlm::tlm_generic_payload& trans, sc_time& delay) {
+        access(trans);
+        delay += trans.is_write() ? write_latency_ : read_latency_;
+    }
+
+    unsigned transport_dbg(tlm::tlm_generic_payload& trans) {
+        return access(trans);
+    }
+};
@@ -0,0 +1,317 @@
+#pragma once
+#include <systemc.h>
+#include <tlm.h>
+#include <tlm_utils/simple_target_socket.h>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+/*
+    A set-associative cache, timing and statistics only (tags, no data).
+
+    CacheCore is the plain C++ bookkeeping: which line lives where, who gets
+    evicted, what got dirty. Cache wraps it as a TLM-2.0 target, every
+    b_transport() looks the touched lines up and adds the latency to the
+    delay argument instead of waiting, so a whole trace runs without the
+    kernel scheduling anything per access (loosely timed, see replay.hpp).
+
+    address = | tag | set | offset |
+                      ^ log2(sets) bits, offset is log2(line_bytes)
+
+    Write-back caches allocate on a write miss and write dirty lines back on
+    eviction. Write-through caches send every write to memory and don't
+    allocate on a write miss (the usual pairings).
+*/
+enum class Replacement { lru, plru, random };
+enum class WritePolicy { write_back, write_through };
+
+struct CacheConfig {
+    size_t size_bytes = 32 * 1024;
+    size_t ways = 8;
+    size_t line_bytes = 64;
+    Replacement replacement = Replacement::lru;
+    WritePolicy write_policy = WritePolicy::write_back;
+    sc_time hit_latency = sc_time(1, SC_NS);
+    // Per line fill or writeback, and per write-through write
+    sc_time memory_latency = sc_time(50, SC_NS);
+
+    size_t sets() const { return size_bytes / (line_bytes * ways); }
+};
+
+struct CacheStats {
+    uint64_t reads = 0;
+    uint64_t writes = 0;
+    uint64_t read_hits = 0;
+    uint64_t write_hits = 0;
+    uint64_t evictions = 0;
+    uint64_t writebacks = 0;
+    // Lines read from memory, and write-through writes sent to it
+    uint64_t fills = 0;
+    uint64_t memory_writes = 0;
+
+    uint64_t accesses() const { return reads + writes; }
+    uint64_t hits() const { return read_hits + write_hits; }
+    uint64_t misses() const { return accesses() - hits(); }
+    double hit_rate() const {
+        return accesses() == 0 ? 0.0 : double(hits()) / double(accesses());
+    }
+
+    void print(std::ostream& out) const {
+        out << "accesses:    " << accesses() << " (" << reads << " reads, "
+            << writes << " writes)\n"
+            << "hits:        " << hits() << " (" << hit_rate() * 100.0
+            << "%)\n"
+            << "misses:      " << misses() << " (" << reads - read_hits
+            << " read, " << writes - write_hits << " write)\n"
+            << "evictions:   " << evictions << " (" << writebacks
+            << " dirty)\n"
+            << "memory:      " << fills << " line fills, " << memory_writes
+            << " writes\n";
+    }
+};
+
+struct AccessResult {
+    bool hit = false;
+    bool filled = false;
+    bool evicted = false;
+    bool writeback = false;
+    bool memory_write = false;
+};
+
+class CacheCore {
+public:
+    explicit CacheCore(const CacheConfig& config)
+        : config_{config}, ways_{config.ways} {
+        const size_t sets = config.sets();
+        if (!is_pow2(config.line_bytes) || ways_ == 0 || sets == 0 ||
+            !is_pow2(sets) ||
+            sets * ways_ * config.line_bytes != config.size_bytes) {
+            throw std::invalid_argument(
+                "cache needs size = sets * ways * line_bytes, with the line "
+                "size and the number of sets powers of two");
+        }
+        if (config.replacement == Replacement::plru &&
+            (!is_pow2(ways_) || ways_ > 64)) {
+            throw std::invalid_argument("PLRU needs 1-64 ways, a power of two");
+        }
+
+        line_shift_ = log2(config.line_bytes);
+        set_bits_ = log2(sets);
+        set_mask_ = sets - 1;
+        tags_.assign(sets * ways_, invalid_tag);
+        dirty_.assign(sets * ways_, 0);
+        last_use_.assign(sets * ways_, 0);
+        plru_.assign(sets, 0);
+    }
+
+    AccessResult access(uint64_t addr, bool write) {
+        const uint64_t line = addr >> line_shift_;
+        const size_t set = line & set_mask_;
+        const uint64_t tag = line >> set_bits_;
+        const size_t base = set * ways_;
+        const bool write_back = config_.write_policy == WritePolicy::write_back;
+
+        AccessResult res;
+        write ? stats_.writes++ : stats_.reads++;
+        clock_++;
+
+        for (size_t w = 0; w < ways_; w++) {
+            if (tags_[base + w] == tag) {
+                res.hit = true;
+                write ? stats_.write_hits++ : stats_.read_hits++;
+                touch(set, w);
+                if (write) {
+                    if (write_back) {
+                        dirty_[base + w] = 1;
+                    }
+                    else {
+                        res.memory_write = true;
+                        stats_.memory_writes++;
+                    }
+                }
+                return res;
+            }
+        }
+
+        // Write-through doesn't allocate, the write just goes to memory
+        if (write && !write_back) {
+            res.memory_write = true;
+            stats_.memory_writes++;
+            return res;
+        }
+
+        const size_t w = victim(set);
+        if (tags_[base + w] != invalid_tag) {
+            res.evicted = true;
+            stats_.evictions++;
+            if (dirty_[base + w]) {
+                res.writeback = true;
+                stats_.writebacks++;
+            }
+        }
+        tags_[base + w] = tag;
+        dirty_[base + w] = write;
+        res.filled = true;
+        stats_.fills++;
+        touch(set, w);
+        return res;
+    }
+
+    // Writes back every dirty line, e.g. at the end of a trace
+    uint64_t flush() {
+        uint64_t flushed = 0;
+        for (size_t i = 0; i < tags_.size(); i++) {
+            if (tags_[i] != invalid_tag && dirty_[i]) {
+                dirty_[i] = 0;
+                flushed++;
+            }
+        }
+        stats_.writebacks += flushed;
+        return flushed;
+    }
+
+    const CacheConfig& config() const { return config_; }
+    const CacheStats& stats() const { return stats_; }
+    void reset_stats() { stats_ = CacheStats{}; }
+
+private:
+    // Tags are addresses shifted right by at least one bit, never all ones
+    static constexpr uint64_t invalid_tag = ~uint64_t{0};
+
+    CacheConfig config_;
+    size_t ways_;
+    unsigned line_shift_ = 0;
+    unsigned set_bits_ = 0;
+    size_t set_mask_ = 0;
+
+    // sets x ways, row major
+    std::vector<uint64_t> tags_;
+    std::vector<uint8_t> dirty_;
+    std::vector<uint64_t> last_use_;
+    // One tree per set, bit n is node n (heap order, root is 1). A set bit
+    // means the victim is down the right subtree
+    std::vector<uint64_t> plru_;
+    uint64_t clock_ = 0;
+    uint64_t rng_ = 0x9E3779B97F4A7C15ull;
+    CacheStats stats_;
+
+    static bool is_pow2(size_t n) { return n != 0 && (n & (n - 1)) == 0; }
+    static unsigned log2(size_t n) {
+        unsigned bits = 0;
+        while ((size_t{1} << bits) < n) {
+            bits++;
+        }
+        return bits;
+    }
+
+    void touch(size_t set, size_t way) {
+        switch (config_.replacement) {
+        case Replacement::lru:
+            last_use_[set * ways_ + way] = clock_;
+            break;
+        case Replacement::plru: {
+            // Point every node on the way down away from this way
+            uint64_t& tree = plru_[set];
+            size_t node = 1;
+            for (size_t half = ways_ / 2; half > 0; half /= 2) {
+                const bool right = (way & half) != 0;
+                if (right) {
+                    tree &= ~(uint64_t{1} << node);
+                }
+                else {
+                    tree |= uint64_t{1} << node;
+                }
+                node = node * 2 + right;
+            }
+            break;
+        }
+        case Replacement::random:
+            break;
+        }
+    }
+
+    size_t victim(size_t set) {
+        const size_t base = set * ways_;
+        // Empty ways first, whatever the policy
+        for (size_t w = 0; w < ways_; w++) {
+            if (tags_[base + w] == invalid_tag) {
+                return w;
+            }
+        }
+
+        switch (config_.replacement) {
+        case Replacement::lru: {
+            size_t oldest = 0;
+            for (size_t w = 1; w < ways_; w++) {
+                if (last_use_[base + w] < last_use_[base + oldest]) {
+                    oldest = w;
+                }
+            }
+            return oldest;
+        }
+        case Replacement::plru: {
+            const uint64_t tree = plru_[set];
+            size_t node = 1;
+            while (node < ways_) {
+                node = node * 2 + ((tree >> node) & 1);
+            }
+            return node - ways_;
+        }
+        case Replacement::random:
+        default:
+            rng_ ^= rng_ << 13;
+            rng_ ^= rng_ >> 7;
+            rng_ ^= rng_ << 17;
+            return rng_ % ways_;
+        }
+    }
+};
+
+/*
+    The TLM face of CacheCore. Reads and writes of any length are split into
+    the lines they touch, each line adds hit_latency, plus memory_latency
+    per fill, per dirty writeback and per write-through write.
+
+    Nothing behind it holds data, so payloads come back OK with their data
+    untouched. Wire a memory model behind it if you need the bytes.
+*/
+class Cache : public sc_module {
+public:
+    tlm_utils::simple_target_socket<Cache> socket;
+
+    Cache(sc_module_name name, const CacheConfig& config)
+        : sc_module(name), socket("socket"), core_(config) {
+        socket.register_b_transport(this, &Cache::b_transport);
+    }
+
+    const CacheStats& stats() const { return core_.stats(); }
+    CacheCore& core() { return core_; }
+
+private:
+    CacheCore core_;
+
+    void b_transport(tlm::tlm_generic_payload& trans, sc_time& delay) {
+        const tlm::tlm_command cmd = trans.get_command();
+        if (cmd == tlm::TLM_IGNORE_COMMAND) {
+            trans.set_response_status(tlm::TLM_OK_RESPONSE);
+            return;
+        }
+
+        const bool write = cmd == tlm::TLM_WRITE_COMMAND;
+        const CacheConfig& cfg = core_.config();
+        const uint64_t first = trans.get_address();
+        const uint64_t last = first + std::max(trans.get_data_length(), 1u) - 1;
+        const uint64_t line_mask = ~uint64_t{cfg.line_bytes - 1};
+
+        for (uint64_t line = first & line_mask; line <= last;
+             line += cfg.line_bytes) {
+            const AccessResult res = core_.access(line, write);
+            delay += cfg.hit_latency;
+            const int trips =
+                int(res.filled) + int(res.writeback) + int(res.memory_write);
+            delay += trips * cfg.memory_latency;
+        }
+        trans.set_response_status(tlm::TLM_OK_RESPONSE);
+    }
+};
@@ -0,0 +1,126 @@
+#include "cache.hpp"
+#include "pin_cache.hpp"
+#include "replay.hpp"
+#include <benchmark/benchmark.h>
+#include <random>
+
+/*
+    Simulated accesses per second for the same 32 KiB 8-way cache:
+
+        Core      CacheCore::access() in a plain loop, the floor
+        Tlm       b_transport() through a socket with timing annotation
+        PinLevel  PinCache, req/addr/ready signals and a clock, one access
+                  per cycle (two kernel process activations + signal updates)
+
+    All three see the same trace: 80% of the accesses in a 16 KiB hot set,
+    the rest spread over 64 MiB, a quarter of them writes.
+
+    sc_main builds everything up front (see sc_bench.hpp) and the
+    benchmarks share it, PinLevel just keeps advancing the same simulation.
+*/
+static const std::vector<TraceEntry>& bench_trace() {
+    static const std::vector<TraceEntry> trace = [] {
+        std::mt19937_64 rng(1);
+        std::vector<TraceEntry> t;
+        t.reserve(1 << 20);
+        for (size_t i = 0; i < (1 << 20); i++) {
+            const bool hot = rng() % 5 != 0;
+            const uint64_t addr = hot ? rng() % (16 << 10) : rng() % (64 << 20);
+            t.push_back({addr & ~uint64_t{3}, 4, rng() % 4 == 0});
+        }
+        return t;
+    }();
+    return trace;
+}
+
+static Cache* tlm_cache;
+static TraceReplayer* tlm_initiator;
+static PinDriver* pin_driver;
+
+static void BM_Core(benchmark::State& state) {
+    const auto& trace = bench_trace();
+    CacheCore core{CacheConfig{}};
+    for (auto _ : state) {
+        for (const TraceEntry& e : trace) {
+            benchmark::DoNotOptimize(core.access(e.addr, e.write));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * trace.size());
+}
+
+static void BM_Tlm(benchmark::State& state) {
+    const auto& trace = bench_trace();
+    unsigned char data[4] = {};
+    tlm::tlm_generic_payload trans;
+    trans.set_data_ptr(data);
+    trans.set_data_length(4);
+    trans.set_streaming_width(4);
+    sc_time delay = SC_ZERO_TIME;
+
+    for (auto _ : state) {
+        for (const TraceEntry& e : trace) {
+            trans.set_command(e.write ? tlm::TLM_WRITE_COMMAND
+                                      : tlm::TLM_READ_COMMAND);
+            trans.set_address(e.addr);
+            tlm_initiator->socket->b_transport(trans, delay);
+        }
+    }
+    benchmark::DoNotOptimize(delay);
+    state.SetItemsProcessed(state.iterations() * trace.size());
+}
+
+static void BM_PinLevel(benchmark::State& state) {
+    const uint64_t before = pin_driver->issued();
+    for (auto _ : state) {
+        sc_start(state.range(0), SC_NS);
+    }
+    state.SetItemsProcessed(pin_driver->issued() - before);
+}
+
+BENCHMARK(BM_Core)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Tlm)->Unit(benchmark::kMillisecond);
+// Cycles of 1 ns simulated per iteration
+BENCHMARK(BM_PinLevel)->Arg(1 << 16)->Unit(benchmark::kMillisecond);
+
+int sc_main(int argc, char* argv[]) {
+    const auto& trace = bench_trace();
+    const std::vector<TraceEntry> nothing;
+
+    Cache cache{"cache", CacheConfig{}};
+    TraceReplayer initiator{"initiator", nothing};
+    initiator.socket.bind(cache.socket);
+
+    sc_clock clk{"clk", 1, SC_NS};
+    sc_signal<bool> req, we, ready, hit;
+    sc_signal<uint64_t> addr;
+    PinCache pin_cache{"pin_cache", CacheConfig{}};
+    PinDriver driver{"driver", trace};
+    pin_cache.clk(clk);
+    pin_cache.req(req);
+    pin_cache.we(we);
+    pin_cache.addr(addr);
+    pin_cache.ready(ready);
+    pin_cache.hit(hit);
+    driver.clk(clk);
+    driver.ready(ready);
+    driver.req(req);
+    driver.we(we);
+    driver.addr(addr);
+
+    tlm_cache = &cache;
+    tlm_initiator = &initiator;
+    pin_driver = &driver;
+
+    // Elaborate, bind the sockets and let the empty initiator finish
+    sc_start(SC_ZERO_TIME);
+
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    std::cout << "tlm: ";
+    tlm_cache->stats().print(std::cout);
+    std::cout << "pin: ";
+    pin_cache.stats().print(std::cout);
+    return 0;
+}
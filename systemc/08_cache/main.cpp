@@ -0,0 +1,207 @@
+#include "cache.hpp"
+#include "replay.hpp"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+/*
+    With no arguments, runs the directed checks below. With a trace file,
+    replays it through the TLM model and prints the statistics:
+
+        08_cache trace.txt [size_kib ways line_bytes lru|plru|random wb|wt]
+*/
+static void expect(const char* name, uint64_t got, uint64_t exp) {
+    if (got != exp) {
+        std::ostringstream oss;
+        oss << name << " FAIL  got " << got << "  exp " << exp;
+        SC_REPORT_ERROR("TB", oss.str().c_str());
+    }
+}
+
+static CacheConfig small(size_t ways, Replacement repl,
+                         WritePolicy policy = WritePolicy::write_back) {
+    // 4 sets of 16 byte lines
+    CacheConfig cfg;
+    cfg.line_bytes = 16;
+    cfg.ways = ways;
+    cfg.size_bytes = 4 * ways * 16;
+    cfg.replacement = repl;
+    cfg.write_policy = policy;
+    return cfg;
+}
+
+// Addresses 64 bytes apart all land in set 0
+static uint64_t set0(uint64_t n) { return n * 64; }
+
+static void test_direct_mapped() {
+    CacheCore c{small(1, Replacement::lru)};
+    c.access(set0(0), false);
+    c.access(set0(0) + 8, false);
+    c.access(set0(1), false);
+    c.access(set0(0), false);
+    c.access(16, false);
+    expect("direct mapped hits", c.stats().hits(), 1);
+    expect("direct mapped evictions", c.stats().evictions, 2);
+}
+
+static void test_lru() {
+    CacheCore c{small(2, Replacement::lru)};
+    // A B A C: C evicts B, so A hits and B misses
+    for (uint64_t n : {0, 1, 0, 2, 0, 1}) {
+        c.access(set0(n), false);
+    }
+    expect("LRU hits", c.stats().hits(), 2);
+    expect("LRU misses", c.stats().misses(), 4);
+}
+
+static void test_plru() {
+    CacheCore c{small(4, Replacement::plru)};
+    // Fill 0-3, touch 0 and 2, the tree then points at 1 first, then 3
+    for (uint64_t n : {0, 1, 2, 3, 0, 2, 4, 5}) {
+        c.access(set0(n), false);
+    }
+    c.access(set0(0), false);
+    c.access(set0(2), false);
+    c.access(set0(1), false);
+    c.access(set0(3), false);
+    expect("PLRU hits", c.stats().hits(), 4);
+    expect("PLRU evictions", c.stats().evictions, 4);
+}
+
+static void test_random() {
+    CacheCore c{small(4, Replacement::random)};
+    for (uint64_t n = 0; n < 1000; n++) {
+        c.access(set0(n % 7), false);
+    }
+    // Never more lines than ways, whichever ones it picked
+    expect("random fills", c.stats().fills - c.stats().evictions, 4);
+}
+
+static void test_write_back() {
+    CacheCore c{small(1, Replacement::lru)};
+    c.access(set0(0), true);
+    c.access(set0(0), true);
+    c.access(set0(1), false);
+    c.access(set0(0), false);
+    expect("write-back writebacks", c.stats().writebacks, 1);
+    expect("write-back memory writes", c.stats().memory_writes, 0);
+    c.access(set0(0), true);
+    expect("write-back flush", c.flush(), 1);
+}
+
+static void test_write_through() {
+    CacheCore c{small(1, Replacement::lru, WritePolicy::write_through)};
+    c.access(set0(0), true);
+    c.access(set0(0), false);
+    c.access(set0(0), true);
+    c.access(set0(1), false);
+    expect("write-through no-allocate", c.stats().fills, 2);
+    expect("write-through memory writes", c.stats().memory_writes, 2);
+    expect("write-through writebacks", c.stats().writebacks, 0);
+}
+
+static void test_timing(tlm_utils::simple_initiator_socket<TraceReplayer>& s,
+                        const CacheConfig& cfg) {
+    unsigned char data[64] = {};
+    tlm::tlm_generic_payload trans;
+    trans.set_data_ptr(data);
+    trans.set_command(tlm::TLM_READ_COMMAND);
+
+    auto run = [&](uint64_t addr, unsigned len) {
+        trans.set_address(addr);
+        trans.set_data_length(len);
+        trans.set_streaming_width(len);
+        sc_time delay = SC_ZERO_TIME;
+        s->b_transport(trans, delay);
+        return delay;
+    };
+
+    const sc_time miss = cfg.hit_latency + cfg.memory_latency;
+    expect("miss latency", run(0x100, 4) == miss, 1);
+    expect("hit latency", run(0x104, 4) == cfg.hit_latency, 1);
+    // Straddles two lines, the second one misses
+    expect("split latency", run(0x13c, 8) == cfg.hit_latency + miss, 1);
+    expect("response", trans.is_response_ok(), 1);
+}
+
+static int replay(int argc, char* argv[]) {
+    CacheConfig cfg;
+    if (argc > 2) {
+        cfg.size_bytes = std::strtoull(argv[2], nullptr, 10) * 1024;
+    }
+    if (argc > 3) {
+        cfg.ways = std::strtoull(argv[3], nullptr, 10);
+    }
+    if (argc > 4) {
+        cfg.line_bytes = std::strtoull(argv[4], nullptr, 10);
+    }
+    if (argc > 5) {
+        cfg.replacement = !std::strcmp(argv[5], "plru") ? Replacement::plru
+                          : !std::strcmp(argv[5], "random")
+                              ? Replacement::random
+                              : Replacement::lru;
+    }
+    if (argc > 6 && !std::strcmp(argv[6], "wt")) {
+        cfg.write_policy = WritePolicy::write_through;
+    }
+
+    const std::vector<TraceEntry> trace = load_trace(argv[1]);
+    Cache cache{"cache", cfg};
+    TraceReplayer replayer{"replayer", trace};
+    replayer.socket.bind(cache.socket);
+
+    sc_start();
+
+    std::cout << argv[1] << ": " << trace.size() << " entries, "
+              << cfg.size_bytes / 1024 << " KiB, " << cfg.ways << " ways, "
+              << cfg.line_bytes << " byte lines\n";
+    cache.stats().print(std::cout);
+    std::cout << "simulated:   " << sc_time_stamp() << "\n";
+    return 0;
+}
+
+int sc_main(int argc, char* argv[]) {
+    if (argc > 1) {
+        return replay(argc, argv);
+    }
+
+    test_direct_mapped();
+    test_lru();
+    test_plru();
+    test_random();
+    test_write_back();
+    test_write_through();
+
+    // The TLM side, and a short trace through the replayer
+    const char* path = "08_cache_selftest.trace";
+    {
+        std::ofstream out(path);
+        out << "# warm up\nR 0x0\nW 0x40 8\n\n0 80\n1 0\nr 0x40\n";
+    }
+    const std::vector<TraceEntry> trace = load_trace(path);
+    std::remove(path);
+    expect("trace entries", trace.size(), 5);
+
+    Cache cache{"cache", CacheConfig{}};
+    TraceReplayer replayer{"replayer", trace};
+    replayer.socket.bind(cache.socket);
+    // A fresh cache poked directly through a socket with nothing to replay
+    const std::vector<TraceEntry> nothing;
+    Cache timed{"timed", CacheConfig{}};
+    TraceReplayer probe{"probe", nothing};
+    probe.socket.bind(timed.socket);
+
+    sc_start();
+
+    expect("replay hits", cache.stats().hits(), 2);
+    expect("replay fills", cache.stats().fills, 3);
+    const sc_time per_miss = sc_time(51, SC_NS);
+    expect("replay time", sc_time_stamp() == 3 * per_miss + sc_time(2, SC_NS),
+           1);
+    test_timing(probe.socket, timed.core().config());
+
+    printf("All cache test cases passed\n");
+
+    return 0;
+}
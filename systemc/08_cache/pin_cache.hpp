@@ -0,0 +1,96 @@
+#pragma once
+#include "cache.hpp"
+#include "replay.hpp"
+
+/*
+    The same CacheCore behind a pin-level interface, the way 03_counter and
+    friends are written: sample req/we/addr on every rising edge, answer on
+    hit/ready. Hits are ready on the next edge, misses hold ready low for
+    miss_cycles edges first.
+
+    Only here to show what per-cycle signal toggling costs next to the TLM
+    model (cache_bench.cpp), both count the exact same hits and misses.
+*/
+class PinCache : public sc_module {
+public:
+    sc_in<bool> clk;
+    sc_in<bool> req;
+    sc_in<bool> we;
+    sc_in<uint64_t> addr;
+    sc_out<bool> ready;
+    sc_out<bool> hit;
+
+    SC_HAS_PROCESS(PinCache);
+    PinCache(sc_module_name name, const CacheConfig& config,
+             unsigned miss_cycles = 0)
+        : sc_module(name), core_(config), miss_cycles_(miss_cycles) {
+        SC_METHOD(on_clk);
+        sensitive << clk.pos();
+        dont_initialize();
+    }
+
+    const CacheStats& stats() const { return core_.stats(); }
+
+private:
+    CacheCore core_;
+    unsigned miss_cycles_;
+    unsigned stall_ = 0;
+
+    void on_clk() {
+        if (stall_ > 0) {
+            stall_--;
+            ready.write(stall_ == 0);
+            return;
+        }
+        if (!req.read()) {
+            ready.write(false);
+            return;
+        }
+
+        const AccessResult res = core_.access(addr.read(), we.read());
+        hit.write(res.hit);
+        stall_ = res.hit ? 0 : miss_cycles_;
+        ready.write(stall_ == 0);
+    }
+};
+
+/*
+    Feeds a trace into a PinCache. Drives and samples on the falling edge,
+    half a cycle away from the cache, so ready is always settled. Wraps
+    around at the end of the trace so the bench can keep going.
+*/
+class PinDriver : public sc_module {
+public:
+    sc_in<bool> clk;
+    sc_in<bool> ready;
+    sc_out<bool> req;
+    sc_out<bool> we;
+    sc_out<uint64_t> addr;
+
+    SC_HAS_PROCESS(PinDriver);
+    PinDriver(sc_module_name name, const std::vector<TraceEntry>& trace)
+        : sc_module(name), trace_(trace) {
+        SC_THREAD(run);
+        sensitive << clk.neg();
+    }
+
+    uint64_t issued() const { return issued_; }
+
+private:
+    const std::vector<TraceEntry>& trace_;
+    uint64_t issued_ = 0;
+
+    void run() {
+        size_t i = 0;
+        while (!trace_.empty()) {
+            req.write(true);
+            we.write(trace_[i].write);
+            addr.write(trace_[i].addr);
+            do {
+                wait();
+            } while (!ready.read());
+            issued_++;
+            i = i + 1 == trace_.size() ? 0 : i + 1;
+        }
+    }
+};
@@ -0,0 +1,149 @@
+#pragma once
+#include "cache.hpp"
+#include <tlm_utils/simple_initiator_socket.h>
+#include <tlm_utils/tlm_quantumkeeper.h>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+    Address traces, one access per line:
+
+        R 0x7ffd1234 [size]     read, size in bytes defaults to 4
+        W 7ffd1238              write, the 0x is optional
+        0 7ffd1234              dinero style, 0 read, 1 write, 2 fetch
+        # comment
+
+    The whole file is read in one go and parsed in place, multi-million
+    line traces load in well under a second.
+*/
+struct TraceEntry {
+    uint64_t addr;
+    uint32_t size;
+    bool write;
+};
+
+inline std::vector<TraceEntry> load_trace(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("can't open trace " + path);
+    }
+    std::ostringstream buf;
+    buf << in.rdbuf();
+    const std::string text = buf.str();
+
+    std::vector<TraceEntry> trace;
+    trace.reserve(text.size() / 12);
+    const char* p = text.c_str();
+    size_t lineno = 0;
+
+    while (*p != '\0') {
+        lineno++;
+        const char* end = p;
+        while (*end != '\0' && *end != '\n') {
+            end++;
+        }
+        while (p < end && (*p == ' ' || *p == '\t')) {
+            p++;
+        }
+
+        if (p < end && *p != '#' && *p != '\r') {
+            bool write = false;
+            switch (*p) {
+            case 'R': case 'r': case '0': case '2':
+                break;
+            case 'W': case 'w': case '1':
+                write = true;
+                break;
+            default:
+                throw std::runtime_error(
+                    path + ":" + std::to_string(lineno) + ": bad access type");
+            }
+            p++;
+
+            char* next = nullptr;
+            const uint64_t addr = std::strtoull(p, &next, 16);
+            if (next == p || next > end) {
+                throw std::runtime_error(
+                    path + ":" + std::to_string(lineno) + ": missing address");
+            }
+            p = next;
+            unsigned long size = std::strtoul(p, &next, 10);
+            if (next == p || next > end || size == 0) {
+                size = 4;
+            }
+            trace.push_back({addr, static_cast<uint32_t>(size), write});
+        }
+
+        p = *end == '\0' ? end : end + 1;
+    }
+    return trace;
+}
+
+/*
+    Drives a trace into a target socket from an SC_THREAD, loosely timed.
+    Each b_transport() adds its latency to a local offset and the thread
+    only yields to the kernel once per quantum, so replaying costs a
+    function call per access instead of a context switch.
+
+    done is notified after the last access, sc_time_stamp() is then the
+    simulated time of the whole trace.
+*/
+class TraceReplayer : public sc_module {
+public:
+    tlm_utils::simple_initiator_socket<TraceReplayer> socket;
+    sc_event done;
+
+    SC_HAS_PROCESS(TraceReplayer);
+    TraceReplayer(sc_module_name name, const std::vector<TraceEntry>& trace,
+                  sc_time quantum = sc_time(1, SC_US))
+        : sc_module(name), socket("socket"), trace_(trace) {
+        tlm::tlm_global_quantum::instance().set(quantum);
+        qk_.reset();
+        SC_THREAD(run);
+    }
+
+private:
+    const std::vector<TraceEntry>& trace_;
+    tlm_utils::tlm_quantumkeeper qk_;
+
+    void run() {
+        uint32_t widest = 1;
+        for (const TraceEntry& e : trace_) {
+            widest = std::max(widest, e.size);
+        }
+        std::vector<unsigned char> data(widest);
+
+        tlm::tlm_generic_payload trans;
+        trans.set_data_ptr(data.data());
+        trans.set_streaming_width(widest);
+        trans.set_byte_enable_ptr(nullptr);
+        trans.set_dmi_allowed(false);
+
+        for (const TraceEntry& e : trace_) {
+            trans.set_command(e.write ? tlm::TLM_WRITE_COMMAND
+                                      : tlm::TLM_READ_COMMAND);
+            trans.set_address(e.addr);
+            trans.set_data_length(e.size);
+            trans.set_streaming_width(e.size);
+            trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+            sc_time delay = qk_.get_local_time();
+            socket->b_transport(trans, delay);
+            if (trans.is_response_error()) {
+                SC_REPORT_ERROR("TraceReplayer",
+                                trans.get_response_string().c_str());
+            }
+            qk_.set(delay);
+            if (qk_.need_sync()) {
+                qk_.sync();
+            }
+        }
+        qk_.sync();
+        done.notify();
+    }
+};
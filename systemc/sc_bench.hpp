@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <systemc.h>
+#include <utility>
+
+/*
+    Shared pieces for the *_bench.cpp SystemC benches.
+
+    SystemC elaborates once per process: every module has to exist before
+    the first sc_start and none can be added after it. So a bench's sc_main
+    builds every design it measures up front, and each benchmark only drives
+    its own design while the others sit idle in the same simulation.
+*/
+
+// A clock that only ticks while enabled, so idle designs cost nothing
+class ClockGen : public sc_module {
+public:
+    sc_signal<bool> clk;
+
+    SC_HAS_PROCESS(ClockGen);
+    ClockGen(sc_module_name name, sc_time period = sc_time(10, SC_NS))
+        : sc_module(name), half_(period / 2) {
+        SC_THREAD(run);
+    }
+
+    void enable(bool on) {
+        enabled_ = on;
+        if (on) {
+            resume_.notify(SC_ZERO_TIME);
+        }
+    }
+
+    // Rising edges so far
+    uint64_t edges() const { return edges_; }
+
+private:
+    sc_time half_;
+    bool enabled_ = false;
+    uint64_t edges_ = 0;
+    sc_event resume_;
+
+    void run() {
+        while (true) {
+            if (!enabled_) {
+                wait(resume_);
+                continue;
+            }
+            edges_ += !clk.read();
+            clk.write(!clk.read());
+            wait(half_);
+        }
+    }
+};
+
+// One of each design, so a BENCHMARK_TEMPLATE can find the one sc_main built
+template <typename T> T*& instance() {
+    static T* design = nullptr;
+    return design;
+}
+
+// Builds a T and makes it instance<T>(), sc_main keeps it alive
+template <typename T, typename... Args>
+std::unique_ptr<T> build(Args&&... args) {
+    auto design = std::make_unique<T>(std::forward<Args>(args)...);
+    instance<T>() = design.get();
+    return design;
+}
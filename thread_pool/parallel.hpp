@@ -0,0 +1,244 @@
+#pragma once
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/*
+    Parallel algorithms on a fun::thread_pool, for random access ranges
+    like fun::vector and fun::array:
+
+    fun::parallel::sort(v.begin(), v.end());
+    double total = fun::parallel::reduce(v.begin(), v.end(), 0.0);
+
+    Every algorithm takes the pool last, defaulting to thread_pool::global().
+
+    Grain size is automatic. A range is cut into at most max_chunks chunks
+    of at least min_grain elements, and the cut points only depend on the
+    length, never on the number of threads or who stole what. So reduce()
+    and inclusive_scan() with a floating point op give the same bits on
+    every run and on every pool size (they may differ from the serial
+    std::accumulate order, which is the price of doing it in parallel).
+
+    min_grain keeps cheap loops from drowning in task overhead. If you have
+    a handful of very expensive items, use a task_group directly.
+*/
+namespace fun {
+namespace parallel {
+namespace detail {
+
+inline constexpr size_t max_chunks = 512;
+inline constexpr size_t min_grain = 512;
+
+inline size_t grain_for(size_t n) {
+    return std::max(min_grain, (n + max_chunks - 1) / max_chunks);
+}
+
+// Halves the range until it's a single grain, stolen work is the big half
+template <typename Body>
+void split(task_group& group, size_t lo, size_t hi, size_t grain,
+           const Body& body) {
+    while (hi - lo > grain) {
+        // Cut on a grain boundary so chunks are [k * grain, (k + 1) * grain)
+        const size_t grains = (hi - lo + grain - 1) / grain;
+        const size_t mid = lo + grains / 2 * grain;
+        group.run([&group, mid, hi, grain, &body] {
+            split(group, mid, hi, grain, body);
+        });
+        hi = mid;
+    }
+    body(lo, hi);
+}
+
+// Calls body(lo, hi) for every chunk of [0, n), returns when all are done
+template <typename Body>
+void for_chunks(thread_pool& pool, size_t n, size_t grain, const Body& body) {
+    if (n <= grain) {
+        if (n != 0) {
+            body(0, n);
+        }
+        return;
+    }
+    task_group group(pool);
+    group.run([&] { split(group, 0, n, grain, body); });
+    group.wait();
+}
+
+template <typename It, typename Out, typename Compare>
+void merge(task_group& group, It a, size_t na, It b, size_t nb, Out out,
+           const Compare& comp, size_t grain) {
+    while (na + nb > grain) {
+        // Split the longer run in half and find where its middle lands in
+        // the other. Ties go to a first, which keeps the merge stable
+        size_t ma;
+        size_t mb;
+        if (na >= nb) {
+            ma = na / 2;
+            mb = std::lower_bound(b, b + nb, a[ma], comp) - b;
+        }
+        else {
+            mb = nb / 2;
+            ma = std::upper_bound(a, a + na, b[mb], comp) - a;
+        }
+        group.run([&group, a, ma, na, b, mb, nb, out, &comp, grain] {
+            merge(group, a + ma, na - ma, b + mb, nb - mb, out + ma + mb, comp,
+                  grain);
+        });
+        na = ma;
+        nb = mb;
+    }
+    std::merge(std::make_move_iterator(a), std::make_move_iterator(a + na),
+               std::make_move_iterator(b), std::make_move_iterator(b + nb),
+               out, comp);
+}
+
+/*
+    Merge sort bouncing between the input and a scratch buffer: sorts
+    [src, src + n) and leaves the result in dst if to_dst, else in src.
+    The halves are sorted into whichever buffer the final merge reads.
+*/
+template <typename It1, typename It2, typename Compare>
+void merge_sort(thread_pool& pool, It1 src, It2 dst, size_t n, bool to_dst,
+                const Compare& comp, size_t grain) {
+    if (n <= grain) {
+        std::sort(src, src + n, comp);
+        if (to_dst) {
+            std::move(src, src + n, dst);
+        }
+        return;
+    }
+
+    const size_t half = (n + grain - 1) / grain / 2 * grain;
+    {
+        task_group group(pool);
+        group.run([&] {
+            merge_sort(pool, src, dst, half, !to_dst, comp, grain);
+        });
+        merge_sort(pool, src + half, dst + half, n - half, !to_dst, comp,
+                   grain);
+        group.wait();
+    }
+
+    task_group group(pool);
+    if (to_dst) {
+        merge(group, src, half, src + half, n - half, dst, comp, grain);
+    }
+    else {
+        merge(group, dst, half, dst + half, n - half, src, comp, grain);
+    }
+    group.wait();
+}
+}; // namespace detail
+
+template <typename RandomIt, typename F>
+void for_each(RandomIt first, RandomIt last, F f,
+              thread_pool& pool = thread_pool::global()) {
+    const auto n = static_cast<size_t>(last - first);
+    detail::for_chunks(pool, n, detail::grain_for(n),
+                       [&](size_t lo, size_t hi) {
+                           std::for_each(first + lo, first + hi, f);
+                       });
+}
+
+template <typename RandomIt, typename OutIt, typename UnaryOp>
+OutIt transform(RandomIt first, RandomIt last, OutIt out, UnaryOp op,
+                thread_pool& pool = thread_pool::global()) {
+    const auto n = static_cast<size_t>(last - first);
+    detail::for_chunks(pool, n, detail::grain_for(n),
+                       [&](size_t lo, size_t hi) {
+                           std::transform(first + lo, first + hi, out + lo,
+                                          op);
+                       });
+    return out + n;
+}
+
+// Chunk totals are combined left to right, so the result is deterministic
+template <typename RandomIt, typename T, typename BinaryOp = std::plus<>>
+T reduce(RandomIt first, RandomIt last, T init, BinaryOp op = {},
+         thread_pool& pool = thread_pool::global()) {
+    const auto n = static_cast<size_t>(last - first);
+    const size_t grain = detail::grain_for(n);
+    std::vector<std::optional<T>> partial((n + grain - 1) / grain);
+
+    detail::for_chunks(pool, n, grain, [&](size_t lo, size_t hi) {
+        T acc = first[lo];
+        for (size_t i = lo + 1; i < hi; i++) {
+            acc = op(std::move(acc), first[i]);
+        }
+        partial[lo / grain].emplace(std::move(acc));
+    });
+
+    for (auto& p : partial) {
+        init = op(std::move(init), std::move(*p));
+    }
+    return init;
+}
+
+/*
+    Three passes: total every chunk but the last, scan the totals serially
+    to get each chunk's carry-in, then scan the chunks again from their
+    carry. out may be first.
+*/
+template <typename RandomIt, typename OutIt, typename BinaryOp = std::plus<>>
+OutIt inclusive_scan(RandomIt first, RandomIt last, OutIt out,
+                     BinaryOp op = {},
+                     thread_pool& pool = thread_pool::global()) {
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+    const auto n = static_cast<size_t>(last - first);
+    const size_t grain = detail::grain_for(n);
+    const size_t chunks = (n + grain - 1) / grain;
+
+    std::vector<std::optional<T>> carry(chunks);
+    if (chunks > 1) {
+        std::vector<std::optional<T>> total(chunks);
+        const size_t all_but_last = (chunks - 1) * grain;
+        detail::for_chunks(pool, all_but_last, grain, [&](size_t lo,
+                                                          size_t hi) {
+            T acc = first[lo];
+            for (size_t i = lo + 1; i < hi; i++) {
+                acc = op(std::move(acc), first[i]);
+            }
+            total[lo / grain].emplace(std::move(acc));
+        });
+
+        carry[1] = std::move(total[0]);
+        for (size_t c = 2; c < chunks; c++) {
+            carry[c].emplace(op(*carry[c - 1], std::move(*total[c - 1])));
+        }
+    }
+
+    detail::for_chunks(pool, n, grain, [&](size_t lo, size_t hi) {
+        const auto& in = carry[lo / grain];
+        T acc = in ? op(*in, first[lo]) : T(first[lo]);
+        out[lo] = acc;
+        for (size_t i = lo + 1; i < hi; i++) {
+            acc = op(std::move(acc), first[i]);
+            out[i] = acc;
+        }
+    });
+    return out + n;
+}
+
+// Not stable, like std::sort. Needs a scratch copy of the range
+template <typename RandomIt, typename Compare = std::less<>>
+void sort(RandomIt first, RandomIt last, Compare comp = {},
+          thread_pool& pool = thread_pool::global()) {
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+    const auto n = static_cast<size_t>(last - first);
+    const size_t grain = detail::grain_for(n);
+    if (n <= grain) {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    std::vector<T> scratch(std::make_move_iterator(first),
+                           std::make_move_iterator(last));
+    detail::merge_sort(pool, scratch.begin(), first, n, true, comp, grain);
+}
+
+}; // namespace parallel
+}; // namespace fun
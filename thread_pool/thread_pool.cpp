@@ -0,0 +1,237 @@
+#include "array.hpp"
+#include "parallel.hpp"
+#include "thread_pool.hpp"
+#include "vector.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+static fun::vector<double> random_doubles(size_t n, uint32_t seed) {
+    std::mt19937 rng(seed);
+    // Wildly different magnitudes so the summation order shows up
+    std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+    std::uniform_int_distribution<int> exponent(-20, 20);
+    fun::vector<double> v;
+    v.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        v.push_back(std::ldexp(mantissa(rng), exponent(rng)));
+    }
+    return v;
+}
+
+static bool same_bits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+static int fib(fun::thread_pool& pool, int n) {
+    if (n < 2) {
+        return n;
+    }
+    int left = 0;
+    fun::task_group group(pool);
+    group.run([&] { left = fib(pool, n - 1); });
+    const int right = fib(pool, n - 2);
+    group.wait();
+    return left + right;
+}
+
+TEST(ThreadPoolTests, RunsEverything) {
+    fun::thread_pool pool(4);
+    std::atomic<int> count{0};
+    fun::task_group group(pool);
+    for (int i = 0; i < 10000; i++) {
+        group.run([&] { count++; });
+    }
+    group.wait();
+    EXPECT_EQ(count.load(), 10000);
+}
+
+TEST(ThreadPoolTests, Submit) {
+    fun::thread_pool pool(2);
+    auto answer = pool.submit([] { return 42; });
+    auto broken = pool.submit([]() -> int { throw std::runtime_error("x"); });
+    EXPECT_EQ(answer.get(), 42);
+    EXPECT_THROW(broken.get(), std::runtime_error);
+    EXPECT_THROW(fun::thread_pool(0), std::invalid_argument);
+}
+
+TEST(ThreadPoolTests, NestedGroupsDontDeadlock) {
+    // Every level waits on its children from inside a task
+    for (size_t threads : {1, 2, 4}) {
+        fun::thread_pool pool(threads);
+        auto root = pool.submit([&] { return fib(pool, 20); });
+        EXPECT_EQ(root.get(), 6765);
+    }
+}
+
+TEST(ThreadPoolTests, ExceptionsReachWait) {
+    fun::thread_pool pool(3);
+    fun::task_group group(pool);
+    std::atomic<int> finished{0};
+    for (int i = 0; i < 100; i++) {
+        group.run([&, i] {
+            if (i == 37) {
+                throw std::runtime_error("task 37");
+            }
+            finished++;
+        });
+    }
+    EXPECT_THROW(group.wait(), std::runtime_error);
+    // The others still ran, and the group is reusable
+    EXPECT_EQ(finished.load(), 99);
+    group.run([&] { finished++; });
+    EXPECT_NO_THROW(group.wait());
+}
+
+TEST(ThreadPoolTests, DrainsOnDestruction) {
+    std::atomic<int> count{0};
+    {
+        fun::thread_pool pool(2);
+        for (int i = 0; i < 1000; i++) {
+            pool.submit([&] { count++; });
+        }
+    }
+    EXPECT_EQ(count.load(), 1000);
+}
+
+TEST(ParallelTests, ForEachTransform) {
+    fun::thread_pool pool(4);
+    fun::vector<int> v;
+    for (int i = 0; i < 100000; i++) {
+        v.push_back(i);
+    }
+
+    fun::parallel::for_each(v.begin(), v.end(), [](int& x) { x *= 2; }, pool);
+    fun::vector<long> squares;
+    squares.resize(v.size());
+    fun::parallel::transform(v.begin(), v.end(), squares.begin(),
+                             [](int x) { return long{x} * x; }, pool);
+    for (int i = 0; i < 100000; i++) {
+        ASSERT_EQ(v[i], 2 * i);
+        ASSERT_EQ(squares[i], 4L * i * i);
+    }
+
+    // Smaller than a grain, runs inline
+    fun::array<int, 8> arr{1, 2, 3, 4, 5, 6, 7, 8};
+    fun::parallel::for_each(arr.begin(), arr.end(), [](int& x) { x++; }, pool);
+    EXPECT_EQ(arr[7], 9);
+    fun::parallel::for_each(arr.begin(), arr.begin(), [](int&) { FAIL(); });
+}
+
+TEST(ParallelTests, ReduceIsDeterministic) {
+    const auto v = random_doubles(1000003, 1);
+    const double reference = fun::parallel::reduce(v.begin(), v.end(), 0.0);
+
+    // Same bits whatever the pool size, and run after run
+    for (size_t threads : {1, 2, 3, 4, 7}) {
+        fun::thread_pool pool(threads);
+        for (int run = 0; run < 5; run++) {
+            const double sum = fun::parallel::reduce(
+                v.begin(), v.end(), 0.0, std::plus<>{}, pool);
+            ASSERT_TRUE(same_bits(sum, reference)) << threads << " threads";
+        }
+    }
+
+    // And close to the serial answer
+    const double serial = std::accumulate(v.begin(), v.end(), 0.0);
+    EXPECT_NEAR(reference, serial, 1e-6 * std::abs(serial) + 1e-6);
+}
+
+TEST(ParallelTests, ReduceExact) {
+    fun::vector<uint64_t> v;
+    for (uint64_t i = 1; i <= 200000; i++) {
+        v.push_back(i);
+    }
+    EXPECT_EQ(fun::parallel::reduce(v.begin(), v.end(), uint64_t{0}),
+              200000ull * 200001 / 2);
+    EXPECT_EQ(fun::parallel::reduce(v.begin(), v.begin(), uint64_t{5}), 5);
+
+    // Non-commutative but associative, chunks must stay in order
+    fun::vector<std::string> words;
+    for (int i = 0; i < 5000; i++) {
+        words.push_back(std::string(1, static_cast<char>('a' + i % 26)));
+    }
+    const std::string joined =
+        fun::parallel::reduce(words.begin(), words.end(), std::string{});
+    EXPECT_EQ(joined, std::accumulate(words.begin(), words.end(),
+                                      std::string{}));
+}
+
+TEST(ParallelTests, InclusiveScan) {
+    fun::thread_pool pool(4);
+    for (size_t n : {0, 1, 511, 512, 513, 1100, 300001}) {
+        fun::vector<int64_t> v;
+        for (size_t i = 0; i < n; i++) {
+            v.push_back(static_cast<int64_t>(i % 17) - 8);
+        }
+        fun::vector<int64_t> expected;
+        expected.resize(n);
+        std::inclusive_scan(v.begin(), v.end(), expected.begin());
+
+        fun::vector<int64_t> out;
+        out.resize(n);
+        fun::parallel::inclusive_scan(v.begin(), v.end(), out.begin(),
+                                      std::plus<>{}, pool);
+        ASSERT_TRUE(std::equal(out.begin(), out.end(), expected.begin()))
+            << n;
+
+        // In place
+        fun::parallel::inclusive_scan(v.begin(), v.end(), v.begin(),
+                                      std::plus<>{}, pool);
+        ASSERT_TRUE(std::equal(v.begin(), v.end(), expected.begin())) << n;
+    }
+}
+
+TEST(ParallelTests, InclusiveScanIsDeterministic) {
+    const auto v = random_doubles(400000, 2);
+    fun::vector<double> reference;
+    reference.resize(v.size());
+    fun::parallel::inclusive_scan(v.begin(), v.end(), reference.begin());
+
+    for (size_t threads : {1, 3, 8}) {
+        fun::thread_pool pool(threads);
+        fun::vector<double> out;
+        out.resize(v.size());
+        fun::parallel::inclusive_scan(v.begin(), v.end(), out.begin(),
+                                      std::plus<>{}, pool);
+        for (size_t i = 0; i < v.size(); i++) {
+            ASSERT_TRUE(same_bits(out[i], reference[i])) << i;
+        }
+    }
+}
+
+TEST(ParallelTests, Sort) {
+    fun::thread_pool pool(4);
+    std::mt19937 rng(3);
+    for (size_t n : {0, 1, 2, 511, 513, 4097, 1000000}) {
+        fun::vector<uint32_t> v;
+        for (size_t i = 0; i < n; i++) {
+            // Plenty of duplicates
+            v.push_back(rng() % (n / 4 + 1));
+        }
+        fun::vector<uint32_t> expected(v);
+        std::sort(expected.begin(), expected.end());
+
+        fun::parallel::sort(v.begin(), v.end(), std::less<>{}, pool);
+        ASSERT_TRUE(std::equal(v.begin(), v.end(), expected.begin())) << n;
+    }
+}
+
+TEST(ParallelTests, SortNonTrivial) {
+    fun::vector<std::string> v;
+    for (int i = 0; i < 20000; i++) {
+        v.push_back(std::to_string((i * 7919) % 20000));
+    }
+    fun::vector<std::string> expected(v);
+    const auto longer_first = [](const std::string& a, const std::string& b) {
+        return a.size() != b.size() ? a.size() > b.size() : a < b;
+    };
+    std::sort(expected.begin(), expected.end(), longer_first);
+
+    fun::parallel::sort(v.begin(), v.end(), longer_first);
+    EXPECT_TRUE(std::equal(v.begin(), v.end(), expected.begin()));
+}
@@ -0,0 +1,451 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+    A work-stealing thread pool.
+
+    Every worker owns a Chase-Lev deque. Tasks a worker spawns go on the
+    bottom of its own deque and it pops them back LIFO (hot in cache,
+    depth-first, so recursive splitting doesn't blow up the queue). Idle
+    workers steal from the top of someone else's deque, which is where the
+    oldest and so usually biggest pieces of work are. Tasks submitted from
+    outside the pool go through one shared queue.
+
+    fun::task_group is the fork-join interface, run() a bunch of closures
+    and wait() for all of them. Waiting on a worker thread runs other tasks
+    in the meantime, so nested parallelism can't deadlock even with one
+    worker. The first exception any task throws comes back out of wait().
+
+    See parallel.hpp for for_each/reduce/sort/... on top of this.
+*/
+namespace fun {
+
+class thread_pool;
+class task_group;
+
+namespace detail {
+
+// Type-erased closure, heap allocated per spawn and deleted after it runs
+struct pool_task {
+    void (*invoke)(pool_task*);
+};
+
+template <typename F> struct pool_task_impl : pool_task {
+    F fn;
+    task_group* group;
+
+    template <typename G>
+    pool_task_impl(G&& g, task_group* grp)
+        : pool_task{&run}, fn(std::forward<G>(g)), group{grp} {}
+
+    static void run(pool_task* base);
+};
+
+/*
+    Chase-Lev deque, as in "Correct and Efficient Work-Stealing for Weak
+    Memory Models" (Le et al., 2013). The owner pushes and pops at bottom_,
+    thieves CAS top_. The paper's seq_cst fences are folded into seq_cst
+    loads and stores here, same ordering but ThreadSanitizer understands it.
+
+    Growing copies into a ring twice the size. Old rings are kept until the
+    deque dies since a thief may still be reading one.
+*/
+class work_deque {
+public:
+    work_deque() {
+        rings_.push_back(std::make_unique<ring>(64));
+        ring_.store(rings_.back().get(), std::memory_order_relaxed);
+    }
+
+    work_deque(const work_deque&) = delete;
+    work_deque& operator=(const work_deque&) = delete;
+
+    // Owner only
+    void push(pool_task* task) {
+        const int64_t b = bottom_.load(std::memory_order_relaxed);
+        const int64_t t = top_.load(std::memory_order_acquire);
+        ring* r = ring_.load(std::memory_order_relaxed);
+        if (b - t >= r->capacity()) {
+            r = grow(r, t, b);
+        }
+        r->put(b, task);
+        bottom_.store(b + 1, std::memory_order_seq_cst);
+    }
+
+    // Owner only, newest first
+    pool_task* pop() {
+        const int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        ring* r = ring_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_seq_cst);
+
+        if (t > b) {
+            // Was empty
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        pool_task* task = r->get(b);
+        if (t == b) {
+            // Last one, thieves might be after it too
+            if (!top_.compare_exchange_strong(t, t + 1,
+                                              std::memory_order_seq_cst,
+                                              std::memory_order_relaxed)) {
+                task = nullptr;
+            }
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return task;
+    }
+
+    // Anyone, oldest first. nullptr if empty or we lost a race
+    pool_task* steal() {
+        int64_t t = top_.load(std::memory_order_seq_cst);
+        const int64_t b = bottom_.load(std::memory_order_seq_cst);
+        if (t >= b) {
+            return nullptr;
+        }
+        pool_task* task = ring_.load(std::memory_order_acquire)->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return task;
+    }
+
+private:
+    class ring {
+    public:
+        explicit ring(int64_t capacity)
+            : mask_{capacity - 1},
+              slots_{new std::atomic<pool_task*>[capacity]} {}
+
+        int64_t capacity() const noexcept { return mask_ + 1; }
+        pool_task* get(int64_t i) const noexcept {
+            return slots_[i & mask_].load(std::memory_order_relaxed);
+        }
+        void put(int64_t i, pool_task* task) noexcept {
+            slots_[i & mask_].store(task, std::memory_order_relaxed);
+        }
+
+    private:
+        const int64_t mask_;
+        std::unique_ptr<std::atomic<pool_task*>[]> slots_;
+    };
+
+    ring* grow(ring* old, int64_t top, int64_t bottom) {
+        rings_.push_back(std::make_unique<ring>(old->capacity() * 2));
+        ring* bigger = rings_.back().get();
+        for (int64_t i = top; i < bottom; i++) {
+            bigger->put(i, old->get(i));
+        }
+        ring_.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+
+    alignas(64) std::atomic<int64_t> top_{0};
+    alignas(64) std::atomic<int64_t> bottom_{0};
+    std::atomic<ring*> ring_{nullptr};
+    std::vector<std::unique_ptr<ring>> rings_;
+};
+}; // namespace detail
+
+class thread_pool {
+public:
+    static size_t default_size() noexcept {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // One worker per hardware thread, created on first use
+    static thread_pool& global() {
+        static thread_pool pool;
+        return pool;
+    }
+
+    explicit thread_pool(size_t threads = default_size()) {
+        if (threads == 0) {
+            throw std::invalid_argument("thread_pool needs a thread");
+        }
+        for (size_t i = 0; i < threads; i++) {
+            workers_.push_back(std::make_unique<worker>(this, i));
+        }
+        // Only start once every deque exists, they steal from each other
+        for (auto& w : workers_) {
+            w->thread = std::thread([this, self = w.get()] { run(self); });
+        }
+    }
+
+    // Whatever is still queued gets run before the workers exit
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& w : workers_) {
+            w->thread.join();
+        }
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    size_t size() const noexcept { return workers_.size(); }
+
+    // True on one of this pool's workers
+    bool on_worker() const noexcept {
+        return current_ != nullptr && current_->pool == this;
+    }
+
+    // Fire and forget with a future for the result (or exception)
+    template <typename F> auto submit(F&& f) {
+        using R = std::invoke_result_t<std::decay_t<F>&>;
+        std::packaged_task<R()> job(std::forward<F>(f));
+        std::future<R> result = job.get_future();
+        spawn(make_task([job = std::move(job)]() mutable { job(); }, nullptr));
+        return result;
+    }
+
+private:
+    friend class task_group;
+
+    struct worker {
+        thread_pool* pool;
+        detail::work_deque deque;
+        std::thread thread;
+        // Picks steal victims
+        uint64_t rng;
+
+        worker(thread_pool* p, size_t i)
+            : pool{p}, rng{0x9E3779B97F4A7C15ull * (i + 1)} {}
+    };
+
+    static inline thread_local worker* current_ = nullptr;
+
+    std::vector<std::unique_ptr<worker>> workers_;
+
+    std::mutex inject_mutex_;
+    std::deque<detail::pool_task*> injected_;
+
+    // Tasks sitting in any queue, so sleepers know whether to bother
+    std::atomic<int64_t> queued_{0};
+    std::atomic<size_t> sleeping_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+
+    template <typename F>
+    static detail::pool_task* make_task(F&& f, task_group* group) {
+        return new detail::pool_task_impl<std::decay_t<F>>(std::forward<F>(f),
+                                                           group);
+    }
+
+    void spawn(detail::pool_task* task) {
+        if (on_worker()) {
+            current_->deque.push(task);
+        }
+        else {
+            std::lock_guard<std::mutex> lock(inject_mutex_);
+            injected_.push_back(task);
+        }
+
+        queued_.fetch_add(1, std::memory_order_seq_cst);
+        if (sleeping_.load(std::memory_order_seq_cst) != 0) {
+            // Taking the lock means a worker between its last check and the
+            // wait can't miss this
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            wake_.notify_one();
+        }
+    }
+
+    detail::pool_task* find_task(worker* self) {
+        detail::pool_task* task = self->deque.pop();
+        if (task == nullptr && queued_.load(std::memory_order_relaxed) > 0) {
+            task = take_injected();
+            if (task == nullptr) {
+                task = steal(self);
+            }
+        }
+        if (task != nullptr) {
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return task;
+    }
+
+    detail::pool_task* take_injected() {
+        std::lock_guard<std::mutex> lock(inject_mutex_);
+        if (injected_.empty()) {
+            return nullptr;
+        }
+        detail::pool_task* task = injected_.front();
+        injected_.pop_front();
+        return task;
+    }
+
+    // One pass over everyone else, starting somewhere random
+    detail::pool_task* steal(worker* self) {
+        const size_t n = workers_.size();
+        self->rng ^= self->rng << 13;
+        self->rng ^= self->rng >> 7;
+        self->rng ^= self->rng << 17;
+        const size_t start = self->rng % n;
+        for (size_t k = 0; k < n; k++) {
+            worker* victim = workers_[(start + k) % n].get();
+            if (victim == self) {
+                continue;
+            }
+            if (detail::pool_task* task = victim->deque.steal()) {
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    // Runs one task if it finds any, for workers waiting on a task_group
+    bool help(worker* self) {
+        detail::pool_task* task = find_task(self);
+        if (task == nullptr) {
+            return false;
+        }
+        task->invoke(task);
+        return true;
+    }
+
+    void run(worker* self) {
+        current_ = self;
+        // Spin a little before sleeping, work tends to come in bursts
+        constexpr int spins_before_sleep = 32;
+        int idle = 0;
+        for (;;) {
+            if (help(self)) {
+                idle = 0;
+                continue;
+            }
+            if (++idle < spins_before_sleep) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            sleeping_.fetch_add(1, std::memory_order_seq_cst);
+            wake_.wait(lock, [this] {
+                return stop_ || queued_.load(std::memory_order_seq_cst) > 0;
+            });
+            sleeping_.fetch_sub(1, std::memory_order_relaxed);
+            if (stop_ && queued_.load(std::memory_order_seq_cst) <= 0) {
+                return;
+            }
+            idle = 0;
+        }
+    }
+};
+
+class task_group {
+public:
+    explicit task_group(thread_pool& pool = thread_pool::global())
+        : pool_{pool} {}
+
+    // Tasks point back at us, so we can't go away before they're done
+    ~task_group() { join(); }
+
+    task_group(const task_group&) = delete;
+    task_group& operator=(const task_group&) = delete;
+
+    template <typename F> void run(F&& f) {
+        detail::pool_task* task = thread_pool::make_task(std::forward<F>(f),
+                                                         this);
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        pool_.spawn(task);
+    }
+
+    // Blocks until every run() so far has finished, rethrows the first error
+    void wait() {
+        join();
+        if (error_) {
+            std::rethrow_exception(std::exchange(error_, nullptr));
+        }
+    }
+
+private:
+    template <typename F> friend struct detail::pool_task_impl;
+
+    thread_pool& pool_;
+    std::atomic<size_t> pending_{0};
+    std::mutex mutex_;
+    std::condition_variable done_;
+    std::exception_ptr error_;
+
+    void join() {
+        if (pool_.on_worker()) {
+            // Blocking a worker could deadlock, run other tasks instead
+            while (pending_.load(std::memory_order_acquire) != 0) {
+                if (!pool_.help(thread_pool::current_)) {
+                    std::this_thread::yield();
+                }
+            }
+            // Wait out the last finish() still holding the lock
+            std::lock_guard<std::mutex> lock(mutex_);
+        }
+        else {
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_.wait(lock, [this] {
+                return pending_.load(std::memory_order_acquire) == 0;
+            });
+        }
+    }
+
+    void fail(std::exception_ptr e) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!error_) {
+            error_ = std::move(e);
+        }
+    }
+
+    void finish() {
+        // Only the last one out takes the lock, once it drops to zero a
+        // waiter may destroy us as soon as it can get the lock itself
+        size_t n = pending_.load(std::memory_order_relaxed);
+        while (n > 1 && !pending_.compare_exchange_weak(
+                            n, n - 1, std::memory_order_acq_rel)) {
+        }
+        if (n > 1) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            done_.notify_all();
+        }
+    }
+};
+
+template <typename F> void detail::pool_task_impl<F>::run(pool_task* base) {
+    std::unique_ptr<pool_task_impl> self(static_cast<pool_task_impl*>(base));
+    task_group* group = self->group;
+    try {
+        self->fn();
+    }
+    catch (...) {
+        // submit() wraps everything in a packaged_task, which never throws
+        group->fail(std::current_exception());
+    }
+    // Free the closure first, whatever it captured may belong to the waiter
+    self.reset();
+    if (group != nullptr) {
+        group->finish();
+    }
+}
+
+}; // namespace fun
@@ -0,0 +1,147 @@
+#include "parallel.hpp"
+#include "thread_pool.hpp"
+#include "vector.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <random>
+
+/*
+    Scaling from 1 thread up to the machine, the Arg is the pool size.
+    Each algorithm also has a plain serial std:: version as the baseline, so
+    1 thread shows the overhead of going through the pool at all.
+
+    ForEach is compute bound (a few transcendentals per element) and should
+    scale close to linearly. Reduce and Scan mostly stream memory and flatten
+    out once the memory bandwidth is used up.
+*/
+static constexpr size_t elems = 1 << 22;
+
+static fun::thread_pool& pool_of(size_t threads) {
+    static std::map<size_t, std::unique_ptr<fun::thread_pool>> pools;
+    auto& pool = pools[threads];
+    if (!pool) {
+        pool = std::make_unique<fun::thread_pool>(threads);
+    }
+    return *pool;
+}
+
+static void thread_counts(benchmark::internal::Benchmark* b) {
+    const auto max = static_cast<int64_t>(fun::thread_pool::default_size());
+    for (int64_t t = 1; t < max; t *= 2) {
+        b->Arg(t);
+    }
+    b->Arg(max);
+    b->UseRealTime();
+}
+
+static fun::vector<double> random_doubles(size_t n) {
+    std::mt19937_64 rng(1);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    fun::vector<double> v;
+    v.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        v.push_back(dist(rng));
+    }
+    return v;
+}
+
+static void heavy(double& x) { x = std::sin(x) * std::cos(x) + std::sqrt(x); }
+
+static void BM_ForEach(benchmark::State& state) {
+    auto& pool = pool_of(state.range(0));
+    auto v = random_doubles(elems);
+    for (auto _ : state) {
+        fun::parallel::for_each(v.begin(), v.end(), heavy, pool);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * elems);
+}
+
+static void BM_StdForEach(benchmark::State& state) {
+    auto v = random_doubles(elems);
+    for (auto _ : state) {
+        std::for_each(v.begin(), v.end(), heavy);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * elems);
+}
+
+static void BM_Reduce(benchmark::State& state) {
+    auto& pool = pool_of(state.range(0));
+    const auto v = random_doubles(elems);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fun::parallel::reduce(
+            v.begin(), v.end(), 0.0, std::plus<>{}, pool));
+    }
+    state.SetBytesProcessed(state.iterations() * elems * sizeof(double));
+}
+
+static void BM_StdReduce(benchmark::State& state) {
+    const auto v = random_doubles(elems);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::accumulate(v.begin(), v.end(), 0.0));
+    }
+    state.SetBytesProcessed(state.iterations() * elems * sizeof(double));
+}
+
+static void BM_Scan(benchmark::State& state) {
+    auto& pool = pool_of(state.range(0));
+    const auto v = random_doubles(elems);
+    fun::vector<double> out;
+    out.resize(elems);
+    for (auto _ : state) {
+        fun::parallel::inclusive_scan(v.begin(), v.end(), out.begin(),
+                                      std::plus<>{}, pool);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * elems * sizeof(double));
+}
+
+static void BM_StdScan(benchmark::State& state) {
+    const auto v = random_doubles(elems);
+    fun::vector<double> out;
+    out.resize(elems);
+    for (auto _ : state) {
+        std::inclusive_scan(v.begin(), v.end(), out.begin());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * elems * sizeof(double));
+}
+
+static void BM_Sort(benchmark::State& state) {
+    auto& pool = pool_of(state.range(0));
+    const auto input = random_doubles(elems);
+    fun::vector<double> v;
+    for (auto _ : state) {
+        state.PauseTiming();
+        v = input;
+        state.ResumeTiming();
+        fun::parallel::sort(v.begin(), v.end(), std::less<>{}, pool);
+    }
+    state.SetItemsProcessed(state.iterations() * elems);
+}
+
+static void BM_StdSort(benchmark::State& state) {
+    const auto input = random_doubles(elems);
+    fun::vector<double> v;
+    for (auto _ : state) {
+        state.PauseTiming();
+        v = input;
+        state.ResumeTiming();
+        std::sort(v.begin(), v.end());
+    }
+    state.SetItemsProcessed(state.iterations() * elems);
+}
+
+BENCHMARK(BM_StdForEach)->UseRealTime();
+BENCHMARK(BM_ForEach)->Apply(thread_counts);
+BENCHMARK(BM_StdReduce)->UseRealTime();
+BENCHMARK(BM_Reduce)->Apply(thread_counts);
+BENCHMARK(BM_StdScan)->UseRealTime();
+BENCHMARK(BM_Scan)->Apply(thread_counts);
+BENCHMARK(BM_StdSort)->UseRealTime();
+BENCHMARK(BM_Sort)->Apply(thread_counts);
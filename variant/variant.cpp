@@ -1,2 +1,291 @@
 #include "variant.hpp"
+#include <cstdint>
 #include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+// Lets one visitor be a set of lambdas
+template <typename... Fs> struct overloaded : Fs... {
+    using Fs::operator()...;
+};
+template <typename... Fs> overloaded(Fs...) -> overloaded<Fs...>;
+
+template <size_t I> struct Tag {
+    static constexpr size_t value = I;
+};
+
+struct Tracked {
+    static inline int alive = 0;
+
+    int id;
+
+    explicit Tracked(int id) : id{id} { alive++; }
+    Tracked(const Tracked& other) : id{other.id} { alive++; }
+    Tracked(Tracked&& other) noexcept : id{other.id} { alive++; }
+    Tracked& operator=(const Tracked&) = default;
+    Tracked& operator=(Tracked&&) = default;
+    ~Tracked() { alive--; }
+};
+
+struct ThrowingCopy {
+    ThrowingCopy() = default;
+    ThrowingCopy(const ThrowingCopy&) { throw std::runtime_error("copy"); }
+    ThrowingCopy& operator=(const ThrowingCopy&) = default;
+};
+
+struct Pinned {
+    explicit Pinned(int value) : value{value} {}
+    Pinned(const Pinned&) = delete;
+    Pinned& operator=(const Pinned&) = delete;
+
+    int value;
+};
+
+TEST(VariantTests, IndexOf) {
+    EXPECT_EQ((fun::index_of<int, int, double, std::string>()), 0);
+    EXPECT_EQ((fun::index_of<std::string, int, double, std::string>()), 2);
+}
+
+TEST(VariantTests, DefaultCtor) {
+    fun::variant<int, std::string> v;
+    EXPECT_EQ(v.index(), 0);
+    EXPECT_EQ(fun::get<int>(v), 0);
+    EXPECT_FALSE(v.valueless_by_exception());
+}
+
+TEST(VariantTests, ValueCtorPicksAlternative) {
+    fun::variant<int, double, std::string> i{42};
+    fun::variant<int, double, std::string> d{4.2};
+    fun::variant<int, double, std::string> s{"hello"};
+
+    EXPECT_EQ(i.index(), 0);
+    EXPECT_EQ(d.index(), 1);
+    EXPECT_EQ(s.index(), 2);
+    EXPECT_EQ(fun::get<2>(s), "hello");
+}
+
+TEST(VariantTests, ValueCtorSkipsNarrowing) {
+    // int -> float would narrow, int -> long doesn't
+    fun::variant<float, long> v{7};
+    EXPECT_TRUE(fun::holds_alternative<long>(v));
+}
+
+TEST(VariantTests, InPlace) {
+    fun::variant<int, std::string> by_index{std::in_place_index<1>, 3, 'x'};
+    fun::variant<int, std::string> by_type{std::in_place_type<std::string>,
+                                           "abc"};
+    EXPECT_EQ(fun::get<1>(by_index), "xxx");
+    EXPECT_EQ(fun::get<std::string>(by_type), "abc");
+
+    fun::variant<int, Pinned> pinned{std::in_place_type<Pinned>, 5};
+    EXPECT_EQ(fun::get<Pinned>(pinned).value, 5);
+    EXPECT_FALSE(
+        (std::is_copy_constructible_v<fun::variant<int, Pinned>>));
+}
+
+TEST(VariantTests, GetThrowsOnWrongAlternative) {
+    fun::variant<int, std::string> v{1};
+    EXPECT_THROW(fun::get<std::string>(v), fun::bad_variant_access);
+    EXPECT_THROW(fun::get<1>(v), std::logic_error);
+}
+
+TEST(VariantTests, GetIf) {
+    fun::variant<int, std::string> v{1};
+    ASSERT_NE(fun::get_if<int>(&v), nullptr);
+    EXPECT_EQ(*fun::get_if<int>(&v), 1);
+    EXPECT_EQ(fun::get_if<std::string>(&v), nullptr);
+    EXPECT_EQ(fun::get_if<0>(static_cast<fun::variant<int, std::string>*>(
+                  nullptr)),
+              nullptr);
+}
+
+TEST(VariantTests, GetRvalue) {
+    fun::variant<int, std::string> v{"moved"};
+    std::string s = fun::get<std::string>(std::move(v));
+    EXPECT_EQ(s, "moved");
+}
+
+TEST(VariantTests, AssignSameAndOtherAlternative) {
+    fun::variant<int, std::string> v{1};
+    v = 2;
+    EXPECT_EQ(fun::get<int>(v), 2);
+
+    v = "two";
+    EXPECT_EQ(v.index(), 1);
+    EXPECT_EQ(fun::get<std::string>(v), "two");
+
+    v = 3;
+    EXPECT_EQ(fun::get<int>(v), 3);
+}
+
+TEST(VariantTests, Emplace) {
+    fun::variant<int, std::string> v;
+    std::string& s = v.emplace<std::string>(2, 'y');
+    EXPECT_EQ(s, "yy");
+    EXPECT_EQ(v.emplace<0>(9), 9);
+    EXPECT_EQ(v.index(), 0);
+}
+
+TEST(VariantTests, CopyAndMove) {
+    fun::variant<int, std::string> a{"copy me"};
+    fun::variant<int, std::string> b{a};
+    EXPECT_EQ(fun::get<std::string>(b), "copy me");
+
+    fun::variant<int, std::string> c{std::move(a)};
+    EXPECT_EQ(fun::get<std::string>(c), "copy me");
+
+    fun::variant<int, std::string> d{5};
+    d = b;
+    EXPECT_EQ(fun::get<std::string>(d), "copy me");
+    d = fun::variant<int, std::string>{6};
+    EXPECT_EQ(fun::get<int>(d), 6);
+}
+
+TEST(VariantTests, DestroysActiveAlternative) {
+    Tracked::alive = 0;
+    {
+        fun::variant<int, Tracked> v{std::in_place_type<Tracked>, 1};
+        fun::variant<int, Tracked> copy{v};
+        EXPECT_EQ(Tracked::alive, 2);
+
+        v = 3;
+        EXPECT_EQ(Tracked::alive, 1);
+        copy = v;
+        EXPECT_EQ(Tracked::alive, 0);
+        v.emplace<Tracked>(2);
+        EXPECT_EQ(Tracked::alive, 1);
+    }
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(VariantTests, ValuelessAfterThrowingAssign) {
+    fun::variant<int, ThrowingCopy> v{1};
+    const fun::variant<int, ThrowingCopy> other{std::in_place_index<1>};
+
+    EXPECT_THROW(v = other, std::runtime_error);
+    EXPECT_TRUE(v.valueless_by_exception());
+    EXPECT_EQ(v.index(), fun::variant_npos);
+    EXPECT_THROW(fun::visit([](auto&&) {}, v), fun::bad_variant_access);
+
+    v = 2;
+    EXPECT_EQ(fun::get<int>(v), 2);
+}
+
+TEST(VariantTests, Equality) {
+    fun::variant<int, std::string> a{1};
+    fun::variant<int, std::string> b{1};
+    fun::variant<int, std::string> c{"1"};
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+    b = 2;
+    EXPECT_NE(a, b);
+}
+
+TEST(VariantLayoutTests, SmallestTag) {
+    static_assert(sizeof(fun::variant<char, uint8_t>) == 2);
+    static_assert(sizeof(fun::variant<int, float>) == 8);
+    static_assert(std::is_same_v<fun::detail::variant_index_t<2>, uint8_t>);
+    static_assert(std::is_same_v<fun::detail::variant_index_t<254>, uint8_t>);
+    static_assert(std::is_same_v<fun::detail::variant_index_t<300>, uint16_t>);
+    SUCCEED();
+}
+
+TEST(VariantLayoutTests, TrivialWhenAlternativesAre) {
+    using Trivial = fun::variant<int, double, Tag<0>>;
+    static_assert(std::is_trivially_copyable_v<Trivial>);
+    static_assert(std::is_trivially_destructible_v<Trivial>);
+
+    using NonTrivial = fun::variant<int, std::string>;
+    static_assert(!std::is_trivially_copyable_v<NonTrivial>);
+    static_assert(!std::is_trivially_destructible_v<NonTrivial>);
+    SUCCEED();
+}
+
+TEST(VariantLayoutTests, NothrowMoveWhenAlternativesAre) {
+    // What lets fun::vector move variants on regrow instead of copying them
+    using Strings = fun::variant<std::string, int>;
+    static_assert(std::is_nothrow_move_constructible_v<Strings>);
+    static_assert(std::is_nothrow_move_assignable_v<Strings>);
+
+    // ThrowingCopy has no move, so moving it copies and can throw
+    using Throwing = fun::variant<int, ThrowingCopy>;
+    static_assert(!std::is_nothrow_move_constructible_v<Throwing>);
+    static_assert(!std::is_nothrow_move_assignable_v<Throwing>);
+    SUCCEED();
+}
+
+TEST(VariantVisitTests, Single) {
+    fun::variant<int, double, std::string> v{"four"};
+    auto describe = overloaded{
+        [](int) { return std::string("int"); },
+        [](double) { return std::string("double"); },
+        [](const std::string& s) { return "string " + s; },
+    };
+
+    EXPECT_EQ(fun::visit(describe, v), "string four");
+    v = 1.5;
+    EXPECT_EQ(fun::visit(describe, v), "double");
+}
+
+TEST(VariantVisitTests, MutatesThroughReference) {
+    fun::variant<int, std::string> v{1};
+    fun::visit([](auto& x) { x += x; }, v);
+    EXPECT_EQ(fun::get<int>(v), 2);
+}
+
+TEST(VariantVisitTests, ManyAlternativesUseTable) {
+    using Wide = fun::variant<Tag<0>, Tag<1>, Tag<2>, Tag<3>, Tag<4>, Tag<5>,
+                              Tag<6>, Tag<7>, Tag<8>, Tag<9>, Tag<10>>;
+    const auto tag_value = [](auto tag) { return decltype(tag)::value; };
+
+    Wide v{Tag<9>{}};
+    EXPECT_EQ(fun::visit(tag_value, v), 9);
+    v = Tag<10>{};
+    EXPECT_EQ(fun::visit(tag_value, v), 10);
+    v = Tag<0>{};
+    EXPECT_EQ(fun::visit(tag_value, v), 0);
+}
+
+TEST(VariantVisitTests, MultipleVariants) {
+    fun::variant<int, double> a{2};
+    fun::variant<int, std::string, Tag<0>> b{"xy"};
+
+    auto combine = overloaded{
+        [](int x, int y) { return x + y; },
+        [](int x, const std::string& s) { return x * static_cast<int>(s.size()); },
+        [](double, const std::string&) { return -1; },
+        [](auto, auto) { return 0; },
+    };
+
+    EXPECT_EQ(fun::visit(combine, a, b), 4);
+    b = 5;
+    EXPECT_EQ(fun::visit(combine, a, b), 7);
+    a = 0.5;
+    b = "z";
+    EXPECT_EQ(fun::visit(combine, a, b), -1);
+    b = Tag<0>{};
+    EXPECT_EQ(fun::visit(combine, a, b), 0);
+}
+
+TEST(VariantVisitTests, ThreeVariantsPastSwitchSize) {
+    // 3 * 3 * 2 = 18 combinations, beyond the switch
+    using V3 = fun::variant<Tag<0>, Tag<1>, Tag<2>>;
+    using V2 = fun::variant<Tag<0>, Tag<1>>;
+    const auto encode = [](auto a, auto b, auto c) {
+        return decltype(a)::value * 100 + decltype(b)::value * 10 +
+               decltype(c)::value;
+    };
+
+    for (size_t i = 0; i < 3; i++) {
+        for (size_t j = 0; j < 3; j++) {
+            for (size_t k = 0; k < 2; k++) {
+                V3 a = i == 0 ? V3{Tag<0>{}} : i == 1 ? V3{Tag<1>{}} : V3{Tag<2>{}};
+                V3 b = j == 0 ? V3{Tag<0>{}} : j == 1 ? V3{Tag<1>{}} : V3{Tag<2>{}};
+                V2 c = k == 0 ? V2{Tag<0>{}} : V2{Tag<1>{}};
+                EXPECT_EQ(fun::visit(encode, a, b, c), i * 100 + j * 10 + k);
+            }
+        }
+    }
+}
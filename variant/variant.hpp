@@ -1,32 +1,30 @@
+#pragma once
 /*
     variant<int, double, std::string> my_variant;
+        -> holds an int (value-initialized) until something else is assigned
+        -> the tag is the smallest unsigned type that can count the
+           alternatives, so variant<int, float> is 8 bytes, not 16
+        -> copy/move/destroy are trivial when every alternative's is
+
+    fun::visit(visitor, a, b, ...) jumps straight to the right overload: a
+    switch when there are only a few combinations, a constexpr table of
+    function pointers otherwise, never a chain of index comparisons.
 
     Forbids duplicates for now
 */
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 namespace fun {
 
-template <typename... Types> class variant {
-public:
-    variant() {}
-
-    // template <size_t I, Type> constexpr get() {
-    //     // goal
-    // }
-
-private:
-    // {sizeof(Types)...} expands to {sizeof(int), sizeof(double), sizeof(std::string)}
-    static constexpr size_t max_size = std::max({sizeof(Types)...});
-    static constexpr size_t max_align = std::max({alignof(Types)...});
-
-    // Store a buffer of the largest Type provided, and interpret bytes as that
-    alignas(max_align) char buffer_[max_size];
-
-    // Store an index "tag" for what is currently active
-};
-
 // To find the index of each type we need a helper.
 template <typename TargetType, typename... Types> constexpr size_t index_of() {
     static_assert(sizeof...(Types) > 0, "index_of<T, Types...> is empty");
@@ -39,13 +37,13 @@ template <typename TargetType, typename... Types> constexpr size_t index_of() {
         This syntax is a bit rough. But essentially, of form
 
         ( (expr), ...) -> ( (expr1), (expr2), (expr3) ) for all Types...
-        
+
         where any "expr" is checking if the type T (target) is equal to the current Type
 
         std::is_same_v gets checked against all types
     */
     ((std::is_same_v<TargetType, Types>
-          ? (is_found ? void() : (is_found = true, result_idx = idx), void())
+          ? (is_found ? void() : void((is_found = true, result_idx = idx)))
           : void(),
       idx++),
      ...);
@@ -58,4 +56,521 @@ template <typename TargetType, typename... Types> constexpr size_t index_of() {
     return result_idx;
 }
 
+template <typename TargetType, typename... Types> constexpr size_t count_of() {
+    return (size_t{std::is_same_v<TargetType, Types>} + ... + 0);
+}
+
+inline constexpr size_t variant_npos = static_cast<size_t>(-1);
+
+class bad_variant_access : public std::logic_error {
+public:
+    bad_variant_access()
+        : std::logic_error("variant accessed as an inactive alternative!") {}
+};
+
+template <typename... Types> class variant;
+
+template <typename Variant> struct variant_size;
+template <typename... Types>
+struct variant_size<variant<Types...>>
+    : std::integral_constant<size_t, sizeof...(Types)> {};
+template <typename Variant>
+inline constexpr size_t variant_size_v =
+    variant_size<std::remove_cv_t<std::remove_reference_t<Variant>>>::value;
+
+template <size_t I, typename... Types>
+using nth_type_t = std::tuple_element_t<I, std::tuple<Types...>>;
+
+template <size_t I, typename Variant> struct variant_alternative;
+template <size_t I, typename... Types>
+struct variant_alternative<I, variant<Types...>> {
+    using type = nth_type_t<I, Types...>;
+};
+template <size_t I, typename Variant>
+using variant_alternative_t = typename variant_alternative<I, Variant>::type;
+
+namespace detail {
+
+template <size_t N>
+using variant_index_t = std::conditional_t<
+    (N < std::numeric_limits<uint8_t>::max()), uint8_t,
+    std::conditional_t<(N < std::numeric_limits<uint16_t>::max()), uint16_t,
+                       uint32_t>>;
+
+/*
+    Calls f(std::integral_constant<size_t, I0>{}, ...) for the alternatives
+    flattened into flat = (I0 * Size1 + I1) * Size2 + ... so one jump covers
+    any number of variants.
+*/
+template <typename R, size_t... Sizes> struct dispatch_table {
+    static constexpr size_t count = (Sizes * ...);
+    static constexpr size_t sizes[] = {Sizes...};
+
+    static constexpr size_t stride(size_t k) {
+        size_t s = 1;
+        for (size_t j = k + 1; j < sizeof...(Sizes); j++) {
+            s *= sizes[j];
+        }
+        return s;
+    }
+
+    template <size_t Flat, typename F, size_t... K>
+    static R call_at(F&& f, std::index_sequence<K...>) {
+        return std::forward<F>(f)(
+            std::integral_constant<size_t, Flat / stride(K) % sizes[K]>{}...);
+    }
+    template <size_t Flat, typename F> static R call(F&& f) {
+        return call_at<Flat>(std::forward<F>(f),
+                             std::make_index_sequence<sizeof...(Sizes)>{});
+    }
+
+    template <typename F, size_t... Flat>
+    static R jump(size_t flat, F&& f, std::index_sequence<Flat...>) {
+        static constexpr R (*table[])(F&&) = {&call<Flat, F>...};
+        return table[flat](std::forward<F>(f));
+    }
+
+    // Cases past count can't be hit, saying so lets the compiler drop them
+    // (and merge the ones that compile to the same code)
+    template <size_t I, typename F> static R call_case(F&& f) {
+        if constexpr (I < count) {
+            return call<I>(std::forward<F>(f));
+        }
+        else {
+            __builtin_unreachable();
+        }
+    }
+};
+
+template <typename R, size_t... Sizes, typename F>
+R dispatch(size_t flat, F&& f) {
+    using table = dispatch_table<R, Sizes...>;
+
+    // Few enough cases that the compiler can inline every one of them
+    if constexpr (table::count <= 8) {
+        switch (flat) {
+        case 0:
+            return table::template call_case<0>(std::forward<F>(f));
+        case 1:
+            return table::template call_case<1>(std::forward<F>(f));
+        case 2:
+            return table::template call_case<2>(std::forward<F>(f));
+        case 3:
+            return table::template call_case<3>(std::forward<F>(f));
+        case 4:
+            return table::template call_case<4>(std::forward<F>(f));
+        case 5:
+            return table::template call_case<5>(std::forward<F>(f));
+        case 6:
+            return table::template call_case<6>(std::forward<F>(f));
+        case 7:
+            return table::template call_case<7>(std::forward<F>(f));
+        default:
+            __builtin_unreachable();
+        }
+    }
+    else {
+        return table::jump(flat, std::forward<F>(f),
+                           std::make_index_sequence<table::count>{});
+    }
+}
+
+/*
+    The converting constructor picks an alternative the way a call to
+    f(T0), f(T1), ... would, skipping alternatives U would narrow into
+*/
+template <typename T> struct narrowing_probe {
+    T x[1];
+};
+template <typename T, size_t I> struct overload_leaf {
+    template <typename U>
+    auto operator()(T, U&&) const
+        -> decltype(void(narrowing_probe<T>{{std::declval<U>()}}),
+                    std::integral_constant<size_t, I>{});
+};
+template <typename Seq, typename... Types> struct overload_set;
+template <size_t... Is, typename... Types>
+struct overload_set<std::index_sequence<Is...>, Types...>
+    : overload_leaf<Types, Is>... {
+    using overload_leaf<Types, Is>::operator()...;
+};
+template <typename U, typename... Types>
+using best_match_t = decltype(overload_set<
+                              std::index_sequence_for<Types...>, Types...>{}(
+    std::declval<U>(), std::declval<U>()));
+
+struct variant_access {
+    template <size_t I, typename V> static decltype(auto) get(V&& v) {
+        if constexpr (std::is_lvalue_reference_v<V>) {
+            return (v.template raw<I>());
+        }
+        else {
+            return std::move(v.template raw<I>());
+        }
+    }
+};
+
+// The aligned buffer plus the tag, and every operation on them
+template <typename... Types> struct variant_storage {
+    using index_type = variant_index_t<sizeof...(Types)>;
+    static constexpr index_type npos = std::numeric_limits<index_type>::max();
+
+    // {sizeof(Types)...} expands to {sizeof(int), sizeof(double), sizeof(std::string)}
+    static constexpr size_t max_size = std::max({sizeof(Types)...});
+    static constexpr size_t max_align = std::max({alignof(Types)...});
+
+    // So containers of variants move them on regrow instead of copying
+    static constexpr bool nothrow_move_construct =
+        (std::is_nothrow_move_constructible_v<Types> && ...);
+    static constexpr bool nothrow_move_assign =
+        nothrow_move_construct &&
+        (std::is_nothrow_move_assignable_v<Types> && ...);
+
+    // Store a buffer of the largest Type provided, and interpret bytes as that
+    alignas(max_align) unsigned char buffer_[max_size];
+
+    // Store an index "tag" for what is currently active
+    index_type index_;
+
+    template <size_t I> nth_type_t<I, Types...>& raw() noexcept {
+        return *std::launder(
+            reinterpret_cast<nth_type_t<I, Types...>*>(buffer_));
+    }
+    template <size_t I> const nth_type_t<I, Types...>& raw() const noexcept {
+        return *std::launder(
+            reinterpret_cast<const nth_type_t<I, Types...>*>(buffer_));
+    }
+
+    template <size_t I, typename... Args> void construct(Args&&... args) {
+        new (buffer_) nth_type_t<I, Types...>(std::forward<Args>(args)...);
+        index_ = static_cast<index_type>(I);
+    }
+    void reset() noexcept {
+        if constexpr (!(std::is_trivially_destructible_v<Types> && ...)) {
+            if (index_ != npos) {
+                dispatch<void, sizeof...(Types)>(index_, [this](auto i) {
+                    using T = nth_type_t<decltype(i)::value, Types...>;
+                    raw<decltype(i)::value>().~T();
+                });
+            }
+        }
+        index_ = npos;
+    }
+
+    // If the new alternative's constructor throws we're left valueless
+    template <typename Other> void construct_from(Other&& other) {
+        index_ = npos;
+        if (other.index_ != npos) {
+            dispatch<void, sizeof...(Types)>(other.index_, [&](auto i) {
+                construct<decltype(i)::value>(
+                    variant_access::get<decltype(i)::value>(
+                        std::forward<Other>(other)));
+            });
+        }
+    }
+    template <typename Other> void assign_from(Other&& other) {
+        if (other.index_ == npos) {
+            reset();
+        }
+        else if (index_ == other.index_) {
+            dispatch<void, sizeof...(Types)>(index_, [&](auto i) {
+                raw<decltype(i)::value>() =
+                    variant_access::get<decltype(i)::value>(
+                        std::forward<Other>(other));
+            });
+        }
+        else {
+            reset();
+            construct_from(std::forward<Other>(other));
+        }
+    }
+};
+
+/*
+    Like fun::optional, the special members are layered so each one stays
+    trivial when all the alternatives' are:
+
+    storage -> destructor -> copy ctor -> move ctor -> copy assign ->
+    move assign
+*/
+template <typename Base, bool Trivial> struct variant_destroy : Base {};
+template <typename Base> struct variant_destroy<Base, false> : Base {
+    ~variant_destroy() { this->reset(); }
+};
+
+template <typename Base, bool Trivial> struct variant_copy_ctor : Base {};
+template <typename Base> struct variant_copy_ctor<Base, false> : Base {
+    variant_copy_ctor() = default;
+    variant_copy_ctor(const variant_copy_ctor& other) : Base() {
+        this->construct_from(other);
+    }
+    variant_copy_ctor(variant_copy_ctor&&) = default;
+    variant_copy_ctor& operator=(const variant_copy_ctor&) = default;
+    variant_copy_ctor& operator=(variant_copy_ctor&&) = default;
+};
+
+template <typename Base, bool Trivial> struct variant_move_ctor : Base {};
+template <typename Base> struct variant_move_ctor<Base, false> : Base {
+    variant_move_ctor() = default;
+    variant_move_ctor(const variant_move_ctor&) = default;
+    variant_move_ctor(variant_move_ctor&& other) noexcept(
+        Base::nothrow_move_construct)
+        : Base() {
+        this->construct_from(std::move(other));
+    }
+    variant_move_ctor& operator=(const variant_move_ctor&) = default;
+    variant_move_ctor& operator=(variant_move_ctor&&) = default;
+};
+
+template <typename Base, bool Trivial> struct variant_copy_assign : Base {};
+template <typename Base> struct variant_copy_assign<Base, false> : Base {
+    variant_copy_assign() = default;
+    variant_copy_assign(const variant_copy_assign&) = default;
+    variant_copy_assign(variant_copy_assign&&) = default;
+    variant_copy_assign& operator=(const variant_copy_assign& other) {
+        if (this != &other) {
+            this->assign_from(other);
+        }
+
+        return *this;
+    }
+    variant_copy_assign& operator=(variant_copy_assign&&) = default;
+};
+
+template <typename Base, bool Trivial> struct variant_move_assign : Base {};
+template <typename Base> struct variant_move_assign<Base, false> : Base {
+    variant_move_assign() = default;
+    variant_move_assign(const variant_move_assign&) = default;
+    variant_move_assign(variant_move_assign&&) = default;
+    variant_move_assign& operator=(const variant_move_assign&) = default;
+    variant_move_assign& operator=(variant_move_assign&& other) noexcept(
+        Base::nothrow_move_assign) {
+        if (this != &other) {
+            this->assign_from(std::move(other));
+        }
+
+        return *this;
+    }
+};
+
+template <typename... Types>
+using variant_base = variant_move_assign<
+    variant_copy_assign<
+        variant_move_ctor<
+            variant_copy_ctor<
+                variant_destroy<variant_storage<Types...>,
+                                (std::is_trivially_destructible_v<Types> &&
+                                 ...)>,
+                (std::is_trivially_copy_constructible_v<Types> && ...)>,
+            (std::is_trivially_move_constructible_v<Types> && ...)>,
+        ((std::is_trivially_copy_constructible_v<Types> &&
+          std::is_trivially_copy_assignable_v<Types> &&
+          std::is_trivially_destructible_v<Types>)&&...)>,
+    ((std::is_trivially_move_constructible_v<Types> &&
+      std::is_trivially_move_assignable_v<Types> &&
+      std::is_trivially_destructible_v<Types>)&&...)>;
+
+// Deletes whatever some alternative can't do
+template <bool Copy, bool Move> struct variant_enable_copy_move {};
+template <> struct variant_enable_copy_move<false, true> {
+    variant_enable_copy_move() = default;
+    variant_enable_copy_move(const variant_enable_copy_move&) = delete;
+    variant_enable_copy_move(variant_enable_copy_move&&) = default;
+    variant_enable_copy_move&
+    operator=(const variant_enable_copy_move&) = delete;
+    variant_enable_copy_move& operator=(variant_enable_copy_move&&) = default;
+};
+template <> struct variant_enable_copy_move<false, false> {
+    variant_enable_copy_move() = default;
+    variant_enable_copy_move(const variant_enable_copy_move&) = delete;
+    variant_enable_copy_move(variant_enable_copy_move&&) = delete;
+    variant_enable_copy_move&
+    operator=(const variant_enable_copy_move&) = delete;
+    variant_enable_copy_move& operator=(variant_enable_copy_move&&) = delete;
+};
+}; // namespace detail
+
+template <typename... Types>
+class variant
+    : private detail::variant_base<Types...>,
+      private detail::variant_enable_copy_move<
+          ((std::is_copy_constructible_v<Types> &&
+            std::is_copy_assignable_v<Types>)&&...),
+          ((std::is_move_constructible_v<Types> &&
+            std::is_move_assignable_v<Types>)&&...)> {
+    static_assert(sizeof...(Types) > 0, "variant needs an alternative");
+    static_assert(((count_of<Types, Types...>() == 1) && ...),
+                  "variant alternatives must be distinct");
+
+    using storage = detail::variant_storage<Types...>;
+    friend struct detail::variant_access;
+
+public:
+    template <typename First = nth_type_t<0, Types...>,
+              typename = std::enable_if_t<
+                  std::is_default_constructible_v<First>>>
+    variant() noexcept(std::is_nothrow_default_constructible_v<First>) {
+        this->template construct<0>();
+    }
+    template <typename U,
+              typename = std::enable_if_t<!std::is_same_v<
+                  std::remove_cv_t<std::remove_reference_t<U>>, variant>>,
+              size_t I = detail::best_match_t<U, Types...>::value>
+    variant(U&& val) {
+        this->template construct<I>(std::forward<U>(val));
+    }
+    template <size_t I, typename... Args>
+    explicit variant(std::in_place_index_t<I>, Args&&... args) {
+        this->template construct<I>(std::forward<Args>(args)...);
+    }
+    template <typename T, typename... Args>
+    explicit variant(std::in_place_type_t<T>, Args&&... args)
+        : variant(std::in_place_index<index_of<T, Types...>()>,
+                  std::forward<Args>(args)...) {
+        static_assert(count_of<T, Types...>() == 1, "T isn't an alternative");
+    }
+
+    template <typename U,
+              typename = std::enable_if_t<!std::is_same_v<
+                  std::remove_cv_t<std::remove_reference_t<U>>, variant>>,
+              size_t I = detail::best_match_t<U, Types...>::value>
+    variant& operator=(U&& val) {
+        if (this->index_ == I) {
+            this->template raw<I>() = std::forward<U>(val);
+        }
+        else {
+            emplace<I>(std::forward<U>(val));
+        }
+
+        return *this;
+    }
+
+    template <size_t I, typename... Args>
+    nth_type_t<I, Types...>& emplace(Args&&... args) {
+        this->reset();
+        this->template construct<I>(std::forward<Args>(args)...);
+        return this->template raw<I>();
+    }
+    template <typename T, typename... Args> T& emplace(Args&&... args) {
+        static_assert(count_of<T, Types...>() == 1, "T isn't an alternative");
+        return emplace<index_of<T, Types...>()>(std::forward<Args>(args)...);
+    }
+
+    size_t index() const noexcept {
+        return this->index_ == storage::npos ? variant_npos : this->index_;
+    }
+    // Only after an alternative's constructor threw mid-assignment
+    bool valueless_by_exception() const noexcept {
+        return this->index_ == storage::npos;
+    }
+};
+
+template <typename T, typename... Types>
+bool holds_alternative(const variant<Types...>& v) noexcept {
+    static_assert(count_of<T, Types...>() == 1, "T isn't an alternative");
+    return v.index() == index_of<T, Types...>();
+}
+
+template <size_t I, typename... Types>
+nth_type_t<I, Types...>& get(variant<Types...>& v) {
+    if (v.index() != I) {
+        throw bad_variant_access();
+    }
+    return detail::variant_access::get<I>(v);
+}
+template <size_t I, typename... Types>
+const nth_type_t<I, Types...>& get(const variant<Types...>& v) {
+    if (v.index() != I) {
+        throw bad_variant_access();
+    }
+    return detail::variant_access::get<I>(v);
+}
+template <size_t I, typename... Types>
+nth_type_t<I, Types...>&& get(variant<Types...>&& v) {
+    if (v.index() != I) {
+        throw bad_variant_access();
+    }
+    return detail::variant_access::get<I>(std::move(v));
+}
+template <typename T, typename... Types> T& get(variant<Types...>& v) {
+    static_assert(count_of<T, Types...>() == 1, "T isn't an alternative");
+    return get<index_of<T, Types...>()>(v);
+}
+template <typename T, typename... Types>
+const T& get(const variant<Types...>& v) {
+    static_assert(count_of<T, Types...>() == 1, "T isn't an alternative");
+    return get<index_of<T, Types...>()>(v);
+}
+template <typename T, typename... Types> T&& get(variant<Types...>&& v) {
+    static_assert(count_of<T, Types...>() == 1, "T isn't an alternative");
+    return get<index_of<T, Types...>()>(std::move(v));
+}
+
+// nullptr instead of throwing
+template <size_t I, typename... Types>
+nth_type_t<I, Types...>* get_if(variant<Types...>* v) noexcept {
+    return v != nullptr && v->index() == I
+               ? &detail::variant_access::get<I>(*v)
+               : nullptr;
+}
+template <size_t I, typename... Types>
+const nth_type_t<I, Types...>* get_if(const variant<Types...>* v) noexcept {
+    return v != nullptr && v->index() == I
+               ? &detail::variant_access::get<I>(*v)
+               : nullptr;
+}
+template <typename T, typename... Types>
+T* get_if(variant<Types...>* v) noexcept {
+    return get_if<index_of<T, Types...>()>(v);
+}
+template <typename T, typename... Types>
+const T* get_if(const variant<Types...>* v) noexcept {
+    return get_if<index_of<T, Types...>()>(v);
+}
+
+/*
+    fun::visit(f, a, b) calls f(get<i>(a), get<j>(b)) for the active i and j.
+    Every combination has to return the same type, which is whatever the
+    all-first-alternatives call returns.
+*/
+template <typename Visitor, typename... Variants>
+decltype(auto) visit(Visitor&& vis, Variants&&... vars) {
+    using R = decltype(std::invoke(
+        std::forward<Visitor>(vis),
+        detail::variant_access::get<0>(std::forward<Variants>(vars))...));
+
+    if ((vars.valueless_by_exception() || ...)) {
+        throw bad_variant_access();
+    }
+
+    size_t flat = 0;
+    ((flat = flat * variant_size_v<Variants> + vars.index()), ...);
+
+    return detail::dispatch<R, variant_size_v<Variants>...>(
+        flat, [&](auto... is) -> R {
+            return std::invoke(std::forward<Visitor>(vis),
+                               detail::variant_access::get<decltype(is)::value>(
+                                   std::forward<Variants>(vars))...);
+        });
+}
+
+template <typename... Types>
+bool operator==(const variant<Types...>& a, const variant<Types...>& b) {
+    if (a.index() != b.index()) {
+        return false;
+    }
+    if (a.valueless_by_exception()) {
+        return true;
+    }
+
+    return detail::dispatch<bool, sizeof...(Types)>(a.index(), [&](auto i) {
+        return detail::variant_access::get<decltype(i)::value>(a) ==
+               detail::variant_access::get<decltype(i)::value>(b);
+    });
+}
+template <typename... Types>
+bool operator!=(const variant<Types...>& a, const variant<Types...>& b) {
+    return !(a == b);
+}
+
 }; // namespace fun
@@ -0,0 +1,119 @@
+#include "variant.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <random>
+#include <variant>
+#include <vector>
+
+/*
+    A hot dispatch loop over a mixed stream of messages, the same visitor
+    through fun::visit and std::visit. Narrow has 4 message types (fun::visit
+    takes the switch), Wide has 12 (function pointer table).
+*/
+template <size_t I> struct Msg {
+    uint32_t payload;
+};
+
+struct Handler {
+    uint64_t& sum;
+
+    template <size_t I> void operator()(const Msg<I>& m) const {
+        sum += m.payload * (I + 1);
+    }
+};
+
+template <typename Variant, size_t... Is>
+static std::vector<Variant> make_stream(size_t n, std::index_sequence<Is...>) {
+    using Factory = Variant (*)(uint32_t);
+    static constexpr Factory factories[] = {
+        [](uint32_t p) { return Variant{Msg<Is>{p}}; }...};
+
+    std::mt19937 rng(42);
+    std::vector<Variant> stream;
+    stream.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        const uint32_t r = rng();
+        stream.push_back(factories[r % sizeof...(Is)](r));
+    }
+    return stream;
+}
+
+
+template <typename Variant, typename Visit, size_t Count>
+static void run(benchmark::State& state, Visit visit) {
+    const auto stream =
+        make_stream<Variant>(state.range(0), std::make_index_sequence<Count>{});
+
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        for (const Variant& msg : stream) {
+            visit(Handler{sum}, msg);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <size_t... Is>
+using FunMessages = fun::variant<Msg<Is>...>;
+template <size_t... Is>
+using StdMessages = std::variant<Msg<Is>...>;
+
+static const auto fun_visit = [](auto&& h, const auto& v) { fun::visit(h, v); };
+static const auto std_visit = [](auto&& h, const auto& v) { std::visit(h, v); };
+
+static void BM_NarrowFun(benchmark::State& state) {
+    run<FunMessages<0, 1, 2, 3>, decltype(fun_visit), 4>(state, fun_visit);
+}
+static void BM_NarrowStd(benchmark::State& state) {
+    run<StdMessages<0, 1, 2, 3>, decltype(std_visit), 4>(state, std_visit);
+}
+static void BM_WideFun(benchmark::State& state) {
+    run<FunMessages<0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11>,
+        decltype(fun_visit), 12>(state, fun_visit);
+}
+static void BM_WideStd(benchmark::State& state) {
+    run<StdMessages<0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11>,
+        decltype(std_visit), 12>(state, std_visit);
+}
+
+// Both dispatch on the pair, e.g. a (message, state) double dispatch
+static void BM_PairFun(benchmark::State& state) {
+    using V = FunMessages<0, 1, 2, 3>;
+    const auto a = make_stream<V>(state.range(0), std::make_index_sequence<4>{});
+    const auto b = make_stream<V>(state.range(0), std::make_index_sequence<4>{});
+
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < a.size(); i++) {
+            fun::visit([&](const auto& x, const auto& y) {
+                sum += x.payload ^ y.payload;
+            }, a[i], b[(i * 7) % b.size()]);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+static void BM_PairStd(benchmark::State& state) {
+    using V = StdMessages<0, 1, 2, 3>;
+    const auto a = make_stream<V>(state.range(0), std::make_index_sequence<4>{});
+    const auto b = make_stream<V>(state.range(0), std::make_index_sequence<4>{});
+
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < a.size(); i++) {
+            std::visit([&](const auto& x, const auto& y) {
+                sum += x.payload ^ y.payload;
+            }, a[i], b[(i * 7) % b.size()]);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_NarrowFun)->Arg(1 << 16);
+BENCHMARK(BM_NarrowStd)->Arg(1 << 16);
+BENCHMARK(BM_WideFun)->Arg(1 << 16);
+BENCHMARK(BM_WideStd)->Arg(1 << 16);
+BENCHMARK(BM_PairFun)->Arg(1 << 16);
+BENCHMARK(BM_PairStd)->Arg(1 << 16);
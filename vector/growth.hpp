@@ -0,0 +1,119 @@
+#pragma once
+#include <cstddef>
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+#include <type_traits>
+
+/*
+    Growth policies for fun::vector (and friends). A policy is a type with
+
+    static size_t next_capacity(size_t current, size_t required,
+                                size_t elem_size);
+
+    returning a capacity >= required. It may also provide
+
+    static size_t usable_capacity(const void* p, size_t capacity,
+                                  size_t elem_size);
+
+    which is asked about every fresh growth buffer, and may hand back a larger
+    capacity if the allocation really is bigger than what we asked for.
+*/
+namespace fun {
+
+// Classic 2x. Fewest regrows, but a freed block can never be reused by the
+// next one since 1 + 2 + ... + 2^k < 2^(k+1)
+struct doubling_growth {
+    static size_t next_capacity(size_t current, size_t required, size_t) {
+        const size_t grown = current * 2;
+        return grown > required ? grown : required;
+    }
+};
+
+// 1.5x, so after a few regrows the sum of the freed blocks is big enough for
+// the allocator to recycle them for the next buffer
+struct golden_growth {
+    static size_t next_capacity(size_t current, size_t required, size_t) {
+        const size_t grown = current + current / 2;
+        return grown > required ? grown : required;
+    }
+};
+
+/*
+    2x, but once the buffer passes large_threshold bytes the size is rounded up
+    to whole pages. Big allocations are mmap'd page by page anyway, so the
+    tail of the last page would otherwise be paid for and left unused.
+*/
+template <size_t PageSize = 4096, size_t LargeThreshold = 64 * 1024>
+struct basic_page_growth {
+    static_assert((PageSize & (PageSize - 1)) == 0,
+                  "page size must be a power of two");
+
+    static size_t next_capacity(size_t current, size_t required,
+                                size_t elem_size) {
+        const size_t capacity =
+            doubling_growth::next_capacity(current, required, elem_size);
+        const size_t bytes = capacity * elem_size;
+        if (bytes < LargeThreshold) {
+            return capacity;
+        }
+
+        const size_t rounded = (bytes + PageSize - 1) & ~(PageSize - 1);
+        return rounded / elem_size;
+    }
+};
+using page_growth = basic_page_growth<>;
+
+/*
+    2x, then take whatever malloc actually handed out. malloc rounds every
+    request up to one of its bucket sizes, and malloc_usable_size tells us how
+    much we really got, so those bytes become capacity instead of slack.
+
+    Only valid with an allocator that really calls malloc, i.e.
+    fun::malloc_allocator (fun::vector static_asserts this).
+*/
+struct malloc_usable_growth {
+    static size_t next_capacity(size_t current, size_t required,
+                                size_t elem_size) {
+        return doubling_growth::next_capacity(current, required, elem_size);
+    }
+    static size_t usable_capacity(const void* p, size_t capacity,
+                                  size_t elem_size) {
+        const size_t usable = malloc_usable_size(const_cast<void*>(p));
+        const size_t fits = usable / elem_size;
+        return fits > capacity ? fits : capacity;
+    }
+};
+
+// Plain malloc/free, for growth policies that need to query the heap
+template <typename T> struct malloc_allocator {
+    using value_type = T;
+
+    malloc_allocator() = default;
+    template <typename U> malloc_allocator(const malloc_allocator<U>&) {}
+
+    T* allocate(size_t n) {
+        static_assert(alignof(T) <= alignof(std::max_align_t),
+                      "malloc_allocator can't over-align");
+        if (void* p = std::malloc(n * sizeof(T))) {
+            return static_cast<T*>(p);
+        }
+        throw std::bad_alloc();
+    }
+    void deallocate(T* p, size_t) { std::free(p); }
+
+    bool operator==(const malloc_allocator&) const { return true; }
+    bool operator!=(const malloc_allocator&) const { return false; }
+};
+
+namespace detail {
+template <typename Growth, typename = void>
+struct has_usable_capacity : std::false_type {};
+template <typename Growth>
+struct has_usable_capacity<
+    Growth, std::void_t<decltype(Growth::usable_capacity(
+                static_cast<const void*>(nullptr), size_t{}, size_t{}))>>
+    : std::true_type {};
+}; // namespace detail
+
+}; // namespace fun
@@ -1,5 +1,9 @@
 #include "vector.hpp"
+#include "memory_resource.hpp"
 #include <gtest/gtest.h>
+#include <iterator>
+#include <list>
+#include <sstream>
 
 TEST(VectorTests, Ctor) {
     fun::vector<int> v;
@@ -117,3 +121,638 @@ TEST(VectorTests, PushBackMove) {
     // s was moved from — should be empty
     EXPECT_TRUE(s.empty());
 }
+
+// Owns a heap int, so it is not trivially copyable, but its bytes can be
+// moved around freely which is exactly what relocation needs.
+struct RelocatableBox {
+    static inline int live = 0;
+
+    int* val;
+
+    RelocatableBox(int v) : val{new int(v)} { live++; }
+    RelocatableBox(const RelocatableBox& other) : val{new int(*other.val)} {
+        live++;
+    }
+    RelocatableBox(RelocatableBox&& other) : val{other.val} {
+        other.val = nullptr;
+        live++;
+    }
+    ~RelocatableBox() {
+        delete val;
+        live--;
+    }
+};
+
+template <>
+struct fun::is_trivially_relocatable<RelocatableBox> : std::true_type {};
+
+TEST(VectorTests, TriviallyRelocatableTraits) {
+    struct Pod {
+        int a;
+        float b;
+    };
+
+    EXPECT_TRUE(fun::is_trivially_relocatable_v<int>);
+    EXPECT_TRUE(fun::is_trivially_relocatable_v<Pod>);
+    EXPECT_FALSE(fun::is_trivially_relocatable_v<std::string>);
+    EXPECT_TRUE(fun::is_trivially_relocatable_v<RelocatableBox>);
+    EXPECT_TRUE(fun::is_trivially_relocatable_v<fun::vector<std::string>>);
+}
+
+TEST(VectorTests, TrivialRegrowKeepsValues) {
+    fun::vector<int> v;
+    for (int i = 0; i < 1000; i++) {
+        v.push_back(i);
+    }
+
+    EXPECT_EQ(v.size(), 1000);
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_EQ(v[i], i);
+    }
+
+    fun::vector<int> v2(v);
+    fun::vector<int> v3 = {7};
+    v3 = v;
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_EQ(v2[i], i);
+        EXPECT_EQ(v3[i], i);
+    }
+}
+
+TEST(VectorTests, RelocatableRegrowSkipsDestructors) {
+    {
+        fun::vector<RelocatableBox> v;
+        for (int i = 0; i < 100; i++) {
+            v.push_back(RelocatableBox(i));
+        }
+
+        // Only the elements still in the vector are alive, relocation didn't
+        // leak or double destroy any boxes
+        EXPECT_EQ(RelocatableBox::live, 100);
+        for (int i = 0; i < 100; i++) {
+            EXPECT_EQ(*v[i].val, i);
+        }
+
+        fun::vector<RelocatableBox> v2(v);
+        EXPECT_EQ(RelocatableBox::live, 200);
+        EXPECT_NE(v2[0].val, v[0].val);
+    }
+
+    EXPECT_EQ(RelocatableBox::live, 0);
+}
+
+TEST(VectorTests, MovedFromCopy) {
+    fun::vector<int> v = {1, 2, 3};
+    fun::vector<int> v2(std::move(v));
+
+    // Copying an empty, moved-from vector shouldn't touch its null buffer
+    fun::vector<int> v3(v);
+    EXPECT_EQ(v3.size(), 0);
+}
+
+TEST(VectorArenaTests, ArenaBackedVector) {
+    fun::monotonic_arena arena;
+    {
+        fun::pmr::vector<int> v{&arena};
+        for (int i = 0; i < 1000; i++) {
+            v.push_back(i);
+        }
+
+        EXPECT_EQ(v.size(), 1000);
+        EXPECT_EQ(v[999], 999);
+        EXPECT_EQ(v.get_allocator().resource(), &arena);
+        EXPECT_GE(arena.bytes_allocated(), 1000 * sizeof(int));
+    }
+
+    arena.release();
+    EXPECT_EQ(arena.bytes_allocated(), 0);
+
+    // The retained chunk gets reused after a release
+    fun::pmr::vector<int> v{&arena};
+    for (int i = 0; i < 1000; i++) {
+        v.push_back(i);
+    }
+    EXPECT_EQ(v[500], 500);
+}
+
+TEST(VectorArenaTests, ArenaInitialBuffer) {
+    alignas(std::max_align_t) char buffer[256];
+    fun::monotonic_arena arena{buffer, sizeof(buffer)};
+
+    fun::pmr::vector<int> v({1, 2, 3}, &arena);
+    EXPECT_GE(reinterpret_cast<char*>(&v[0]), buffer);
+    EXPECT_LT(reinterpret_cast<char*>(&v[0]), buffer + sizeof(buffer));
+
+    // Overflowing the buffer spills into upstream chunks
+    for (int i = 0; i < 1000; i++) {
+        v.push_back(i);
+    }
+    EXPECT_EQ(v[1002], 999);
+}
+
+TEST(VectorArenaTests, ArenaAlignment) {
+    fun::monotonic_arena arena{64};
+
+    for (size_t align : {1, 8, 16, 64, 256}) {
+        void* p = arena.allocate(3, align);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % align, 0);
+    }
+}
+
+TEST(VectorArenaTests, PoolReusesBlocks) {
+    fun::pool_resource pool;
+
+    void* a = pool.allocate(24, 8);
+    pool.deallocate(a, 24, 8);
+    void* b = pool.allocate(32, 8);
+
+    // 24 and 32 share a size class, so the freed block comes straight back
+    EXPECT_EQ(a, b);
+    pool.deallocate(b, 32, 8);
+
+    void* big = pool.allocate(1 << 20, 64);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(big) % 64, 0);
+    pool.deallocate(big, 1 << 20, 64);
+}
+
+TEST(VectorArenaTests, PoolBackedVector) {
+    fun::pool_resource pool;
+    fun::pmr::vector<std::string> v{&pool};
+    for (int i = 0; i < 100; i++) {
+        v.push_back(std::to_string(i));
+    }
+
+    fun::pmr::vector<std::string> v2{v};
+    EXPECT_EQ(v2[42], "42");
+
+    // Copies don't inherit the resource, pmr allocators don't propagate
+    EXPECT_NE(v2.get_allocator().resource(), &pool);
+}
+
+TEST(VectorArenaTests, MoveAssignAcrossArenas) {
+    fun::monotonic_arena a, b;
+    fun::pmr::vector<std::string> va({"x", "y"}, &a);
+    fun::pmr::vector<std::string> vb{&b};
+
+    // b can't free a's memory, so the elements move instead of the buffer
+    vb = std::move(va);
+    EXPECT_EQ(vb.size(), 2);
+    EXPECT_EQ(vb[1], "y");
+    EXPECT_EQ(va.size(), 0);
+    EXPECT_EQ(vb.get_allocator().resource(), &b);
+}
+
+TEST(VectorBulkTests, EmplaceBack) {
+    fun::vector<std::pair<int, std::string>> v;
+    auto& ref = v.emplace_back(1, "one");
+    EXPECT_EQ(ref.first, 1);
+    EXPECT_EQ(&ref, &v[0]);
+
+    v.emplace_back(2, "two");
+    EXPECT_EQ(v.size(), 2);
+    EXPECT_EQ(v[1].second, "two");
+}
+
+TEST(VectorBulkTests, PushBackAfterMove) {
+    fun::vector<int> v = {1, 2};
+    fun::vector<int> v2(std::move(v));
+
+    // A moved-from vector has capacity 0 and still has to be able to grow
+    v.push_back(3);
+    EXPECT_EQ(v.size(), 1);
+    EXPECT_EQ(v[0], 3);
+}
+
+TEST(VectorBulkTests, AppendGrowsOnce) {
+    const int src[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    fun::vector<int> v = {0};
+
+    v.append(std::begin(src), std::end(src));
+    EXPECT_EQ(v.size(), 11);
+    EXPECT_EQ(v.capacity(), 11);
+    for (int i = 0; i < 11; i++) {
+        EXPECT_EQ(v[i], i);
+    }
+}
+
+TEST(VectorBulkTests, AppendRange) {
+    std::list<std::string> words = {"a", "b", "c"};
+    fun::vector<std::string> v;
+
+    v.append_range(words);
+    EXPECT_EQ(v.size(), 3);
+    EXPECT_EQ(v[2], "c");
+}
+
+TEST(VectorBulkTests, AppendInputIterator) {
+    std::istringstream in("4 5 6");
+    fun::vector<int> v;
+
+    v.append(std::istream_iterator<int>(in), std::istream_iterator<int>());
+    EXPECT_EQ(v.size(), 3);
+    EXPECT_EQ(v[2], 6);
+}
+
+TEST(VectorBulkTests, InsertMiddleInPlace) {
+    fun::vector<int> v = {1, 5};
+    v.reserve(10);
+    const int mid[] = {2, 3, 4};
+
+    int* it = v.insert(v.begin() + 1, std::begin(mid), std::end(mid));
+    EXPECT_EQ(*it, 2);
+    EXPECT_EQ(v.size(), 5);
+    EXPECT_EQ(v.capacity(), 10);
+    for (int i = 0; i < 5; i++) {
+        EXPECT_EQ(v[i], i + 1);
+    }
+}
+
+TEST(VectorBulkTests, InsertReallocates) {
+    fun::vector<std::string> v = {"a", "d"};
+    const std::string mid[] = {"b", "c"};
+
+    v.insert(v.begin() + 1, std::begin(mid), std::end(mid));
+    EXPECT_EQ(v.size(), 4);
+    EXPECT_EQ(v[0], "a");
+    EXPECT_EQ(v[1], "b");
+    EXPECT_EQ(v[2], "c");
+    EXPECT_EQ(v[3], "d");
+}
+
+TEST(VectorBulkTests, InsertShiftsNonTrivial) {
+    fun::vector<std::string> v = {"a", "b", "c"};
+    v.reserve(8);
+
+    v.insert(v.begin(), std::string("z"));
+    v.insert(v.end(), v[0]);
+    EXPECT_EQ(v.size(), 5);
+    EXPECT_EQ(v[0], "z");
+    EXPECT_EQ(v[1], "a");
+    EXPECT_EQ(v[3], "c");
+    EXPECT_EQ(v[4], "z");
+}
+
+TEST(VectorBulkTests, Resize) {
+    fun::vector<int> v = {1, 2, 3};
+
+    v.resize(5);
+    EXPECT_EQ(v.size(), 5);
+    EXPECT_EQ(v[2], 3);
+    EXPECT_EQ(v[3], 0);
+    EXPECT_EQ(v[4], 0);
+
+    v.resize(1);
+    EXPECT_EQ(v.size(), 1);
+    EXPECT_EQ(v[0], 1);
+}
+
+TEST(VectorBulkTests, ResizeWithValue) {
+    fun::vector<std::string> v = {"x"};
+
+    // The fill value aliases an element that the regrow moves away
+    v.resize(4, v[0]);
+    EXPECT_EQ(v.size(), 4);
+    for (size_t i = 0; i < 4; i++) {
+        EXPECT_EQ(v[i], "x");
+    }
+
+    v.resize(2, "y");
+    EXPECT_EQ(v.size(), 2);
+}
+
+TEST(VectorBulkTests, ResizeDefaultInit) {
+    fun::vector<int> v;
+    v.resize_default_init(100);
+    EXPECT_EQ(v.size(), 100);
+
+    // Caller fills the buffer directly, like a deserializer would
+    for (int i = 0; i < 100; i++) {
+        v.data()[i] = i;
+    }
+    EXPECT_EQ(v[99], 99);
+
+    fun::vector<std::string> strs;
+    strs.resize_default_init(3);
+    EXPECT_TRUE(strs[2].empty());
+}
+
+TEST(VectorBulkTests, ResizeGrowsGeometrically) {
+    // A deserializer growing a few elements at a time regrows like push_back
+    fun::vector<int> v;
+    size_t regrows = 0;
+    for (size_t i = 1; i <= 3000; i++) {
+        const size_t capacity = v.capacity();
+        if (i % 3 == 0) {
+            v.resize(i);
+        }
+        else if (i % 3 == 1) {
+            v.resize(i, 7);
+        }
+        else {
+            v.resize_default_init(i);
+        }
+        regrows += v.capacity() != capacity;
+    }
+    EXPECT_EQ(v.size(), 3000);
+    EXPECT_LE(regrows, 13);
+}
+
+TEST(VectorBulkTests, Iterators) {
+    fun::vector<int> v = {1, 2, 3};
+    int sum = 0;
+    for (int x : v) {
+        sum += x;
+    }
+
+    EXPECT_EQ(sum, 6);
+    EXPECT_EQ(v.end() - v.begin(), 3);
+}
+
+/*
+    Copy throws once armed and the budget of copies runs out. The move is not
+    noexcept, so relocation has to fall back to copies to stay rollbackable.
+*/
+struct ThrowingCopy {
+    static inline int copies_left = -1;
+    static inline int live = 0;
+
+    int val;
+
+    ThrowingCopy(int v) : val{v} { live++; }
+    ThrowingCopy(const ThrowingCopy& other) : val{other.val} {
+        if (copies_left == 0) {
+            throw std::runtime_error("copy failed");
+        }
+        if (copies_left > 0) {
+            copies_left--;
+        }
+        live++;
+    }
+    ThrowingCopy(ThrowingCopy&& other) : val{other.val} { live++; }
+    ~ThrowingCopy() { live--; }
+};
+
+TEST(VectorExceptionTests, NoexceptMoves) {
+    EXPECT_TRUE(std::is_nothrow_move_constructible_v<fun::vector<int>>);
+    EXPECT_TRUE(std::is_nothrow_move_assignable_v<fun::vector<int>>);
+    EXPECT_TRUE(
+        std::is_nothrow_move_constructible_v<fun::vector<std::string>>);
+
+    // pmr vectors may have to allocate when the resources differ
+    EXPECT_FALSE(std::is_nothrow_move_assignable_v<fun::pmr::vector<int>>);
+}
+
+TEST(VectorExceptionTests, ReserveRollsBack) {
+    {
+        fun::vector<ThrowingCopy> v;
+        v.reserve(4);
+        for (int i = 0; i < 4; i++) {
+            v.emplace_back(i);
+        }
+        ThrowingCopy* before = v.data();
+
+        // Relocation copies, and the third copy throws
+        ThrowingCopy::copies_left = 2;
+        EXPECT_THROW(v.reserve(16), std::runtime_error);
+        ThrowingCopy::copies_left = -1;
+
+        EXPECT_EQ(v.data(), before);
+        EXPECT_EQ(v.size(), 4);
+        EXPECT_EQ(v.capacity(), 4);
+        for (int i = 0; i < 4; i++) {
+            EXPECT_EQ(v[i].val, i);
+        }
+        EXPECT_EQ(ThrowingCopy::live, 4);
+    }
+
+    EXPECT_EQ(ThrowingCopy::live, 0);
+}
+
+TEST(VectorExceptionTests, PushBackRollsBack) {
+    {
+        fun::vector<ThrowingCopy> v;
+        v.emplace_back(0);
+        v.emplace_back(1);
+
+        // Full, so this push_back has to regrow and the relocation throws
+        ThrowingCopy::copies_left = 1;
+        EXPECT_THROW(v.push_back(ThrowingCopy(2)), std::runtime_error);
+        ThrowingCopy::copies_left = -1;
+
+        EXPECT_EQ(v.size(), 2);
+        EXPECT_EQ(v.capacity(), 2);
+        EXPECT_EQ(v[0].val, 0);
+        EXPECT_EQ(v[1].val, 1);
+        EXPECT_EQ(ThrowingCopy::live, 2);
+
+        v.push_back(ThrowingCopy(2));
+        EXPECT_EQ(v[2].val, 2);
+    }
+
+    EXPECT_EQ(ThrowingCopy::live, 0);
+}
+
+TEST(VectorExceptionTests, CopyCtorDoesNotLeak) {
+    {
+        fun::vector<ThrowingCopy> v;
+        for (int i = 0; i < 8; i++) {
+            v.emplace_back(i);
+        }
+
+        ThrowingCopy::copies_left = 5;
+        EXPECT_THROW(fun::vector<ThrowingCopy>{v}, std::runtime_error);
+        ThrowingCopy::copies_left = -1;
+
+        EXPECT_EQ(ThrowingCopy::live, 8);
+    }
+
+    EXPECT_EQ(ThrowingCopy::live, 0);
+}
+
+TEST(VectorExceptionTests, InsertRollsBack) {
+    {
+        fun::vector<ThrowingCopy> v;
+        v.emplace_back(0);
+        v.emplace_back(3);
+        const ThrowingCopy mid[] = {ThrowingCopy(1), ThrowingCopy(2)};
+
+        // Building the new elements throws, in place and on regrow
+        ThrowingCopy::copies_left = 1;
+        EXPECT_THROW(v.insert(v.begin() + 1, std::begin(mid), std::end(mid)),
+                     std::runtime_error);
+        ThrowingCopy::copies_left = -1;
+        v.reserve(8);
+        ThrowingCopy::copies_left = 1;
+        EXPECT_THROW(v.insert(v.begin() + 1, std::begin(mid), std::end(mid)),
+                     std::runtime_error);
+        ThrowingCopy::copies_left = -1;
+
+        EXPECT_EQ(v.size(), 2);
+        EXPECT_EQ(v[0].val, 0);
+        EXPECT_EQ(v[1].val, 3);
+        EXPECT_EQ(ThrowingCopy::live, 4);
+    }
+
+    EXPECT_EQ(ThrowingCopy::live, 0);
+}
+
+// Default ctor throws once ctors_left runs out
+struct ThrowingDefault {
+    static inline int ctors_left = -1;
+    static inline int live = 0;
+
+    ThrowingDefault() {
+        if (ctors_left == 0) {
+            throw std::runtime_error("ctor failed");
+        }
+        if (ctors_left > 0) {
+            ctors_left--;
+        }
+        live++;
+    }
+    ThrowingDefault(const ThrowingDefault&) { live++; }
+    ~ThrowingDefault() { live--; }
+};
+
+TEST(VectorExceptionTests, ResizeRollsBack) {
+    {
+        fun::vector<ThrowingDefault> v;
+        v.resize(2);
+
+        // The fourth new element throws, the three before it are undone
+        ThrowingDefault::ctors_left = 3;
+        EXPECT_THROW(v.resize(8), std::runtime_error);
+        ThrowingDefault::ctors_left = -1;
+
+        EXPECT_EQ(v.size(), 2);
+        EXPECT_EQ(ThrowingDefault::live, 2);
+    }
+
+    EXPECT_EQ(ThrowingDefault::live, 0);
+}
+
+TEST(VectorExceptionTests, ResizeValueRollsBack) {
+    {
+        fun::vector<ThrowingCopy> v;
+        v.reserve(8);
+        v.emplace_back(0);
+        const ThrowingCopy val(7);
+
+        ThrowingCopy::copies_left = 3;
+        EXPECT_THROW(v.resize(8, val), std::runtime_error);
+        ThrowingCopy::copies_left = -1;
+
+        EXPECT_EQ(v.size(), 1);
+        EXPECT_EQ(v[0].val, 0);
+        EXPECT_EQ(ThrowingCopy::live, 2);
+    }
+
+    EXPECT_EQ(ThrowingCopy::live, 0);
+}
+
+TEST(VectorExceptionTests, PushBackSelfReference) {
+    fun::vector<std::string> v = {"self"};
+
+    // Full vector, so v[0] is moved by the regrow it triggers
+    v.push_back(v[0]);
+    EXPECT_EQ(v.size(), 2);
+    EXPECT_EQ(v[1], "self");
+}
+
+TEST(VectorExceptionTests, NestedRegrow) {
+    fun::vector<fun::vector<std::string>> v;
+    for (int i = 0; i < 100; i++) {
+        v.push_back({std::to_string(i), "x"});
+    }
+
+    EXPECT_EQ(v.size(), 100);
+    EXPECT_EQ(v[57][0], "57");
+    EXPECT_EQ(v[99][1], "x");
+}
+
+TEST(VectorGrowthTests, DefaultCtorDoesNotAllocate) {
+    fun::vector<int> v;
+    EXPECT_EQ(v.capacity(), 0);
+    EXPECT_EQ(v.data(), nullptr);
+
+    v.push_back(1);
+    EXPECT_EQ(v.capacity(), 1);
+    EXPECT_EQ(v[0], 1);
+}
+
+TEST(VectorGrowthTests, Doubling) {
+    fun::vector<int> v;
+    size_t last = 0;
+    for (int i = 0; i < 100; i++) {
+        v.push_back(i);
+        if (v.capacity() != last) {
+            EXPECT_TRUE(last == 0 || v.capacity() == 2 * last);
+            last = v.capacity();
+        }
+    }
+}
+
+TEST(VectorGrowthTests, Golden) {
+    fun::vector<int, std::allocator<int>, fun::golden_growth> v;
+    for (int i = 0; i < 100; i++) {
+        v.push_back(i);
+    }
+
+    EXPECT_EQ(v.size(), 100);
+    EXPECT_EQ(v[99], 99);
+    EXPECT_EQ(fun::golden_growth::next_capacity(100, 101, sizeof(int)), 150);
+    EXPECT_EQ(fun::golden_growth::next_capacity(1, 2, sizeof(int)), 2);
+    EXPECT_EQ(fun::golden_growth::next_capacity(0, 1, sizeof(int)), 1);
+}
+
+TEST(VectorGrowthTests, PageRounded) {
+    using growth = fun::basic_page_growth<4096, 64 * 1024>;
+
+    // Small buffers just double
+    EXPECT_EQ(growth::next_capacity(16, 17, 8), 32);
+
+    // Large ones fill their last page up to less than one element
+    const size_t cap = growth::next_capacity(10000, 10001, 12);
+    const size_t page_slack = (4096 - (cap * 12) % 4096) % 4096;
+    EXPECT_GE(cap, 20000);
+    EXPECT_LT(cap * 12, 20000 * 12 + 4096);
+    EXPECT_LT(page_slack, 12);
+
+    fun::vector<double, std::allocator<double>, fun::page_growth> v;
+    v.resize(100000);
+    v.push_back(1.0);
+    EXPECT_EQ(v[100000], 1.0);
+}
+
+TEST(VectorGrowthTests, MallocUsable) {
+    using vec = fun::vector<char, fun::malloc_allocator<char>,
+                            fun::malloc_usable_growth>;
+    vec v;
+    v.push_back('a');
+
+    // glibc never hands out a 1 byte block, the slack becomes capacity
+    EXPECT_GE(v.capacity(), 1);
+    EXPECT_EQ(v.capacity(), malloc_usable_size(v.data()));
+    for (int i = 0; i < 1000; i++) {
+        v.push_back('b');
+    }
+    EXPECT_EQ(v.size(), 1001);
+    EXPECT_EQ(v[1000], 'b');
+}
+
+TEST(VectorGrowthTests, ShrinkToFit) {
+    fun::vector<std::string> v;
+    v.reserve(100);
+    v.push_back("a");
+    v.push_back("b");
+
+    v.shrink_to_fit();
+    EXPECT_EQ(v.capacity(), 2);
+    EXPECT_EQ(v[1], "b");
+
+    v.clear();
+    v.shrink_to_fit();
+    EXPECT_EQ(v.capacity(), 0);
+    v.push_back("c");
+    EXPECT_EQ(v[0], "c");
+}
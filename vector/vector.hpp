@@ -1,124 +1,473 @@
+#pragma once
+#include "growth.hpp"
+#include "instrument.hpp"
 #include <cstddef>
+#include <cstring>
 #include <initializer_list>
+#include <iterator>
 #include <iostream>
+#include <memory>
+#include <memory_resource>
 #include <new>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
 
 /*
-    Dynamically resizable array. Doubles on grow, and uses placement new.
-*/
+    Dynamically resizable array. Grows per the Growth policy (doubling by
+    default, see growth.hpp), and uses placement new.
+
+    Memory comes from the Allocator parameter (std::allocator by default), so
+    fun::pmr::vector<T> can sit on top of a fun::monotonic_arena and get
+    bump allocation + bulk release for short-lived scratch vectors.
 
-constexpr size_t GROWTH_FACTOR = 2;
+    Element copies/moves/destroys are dispatched at compile time, so for
+    trivially copyable T a regrow or copy is one memcpy instead of a loop.
+
+    Allocations and the element primitives below report to
+    fun::instrument (instrument.hpp) when built with FUN_INSTRUMENT.
+*/
 
 namespace fun {
 
-template <typename T> class vector {
-public:
-    vector() : data_{}, size_{0}, capacity_{1} {
-        data_ = raw_alloc_arr(capacity_);
+/*
+    Customization point: a type is trivially relocatable if moving it to a new
+    address and "forgetting" the old bytes (no destructor call) is the same as
+    move constructing + destroying it. Trivially copyable types get this for
+    free, but you can opt in other types, e.g.
+
+    template <> struct fun::is_trivially_relocatable<MyHandle> : std::true_type {};
+*/
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v =
+    is_trivially_relocatable<T>::value;
+
+/*
+    Element-range primitives shared by every contiguous container here
+    (vector, small_vector, ...). They only deal with constructing/destroying
+    elements in raw memory, never with allocating it.
+*/
+namespace detail {
+/*
+    Constructs count elements with make(slot). If one throws part way, the
+    ones already made are destroyed again before rethrowing.
+*/
+template <typename T, typename Make>
+void construct_arr(T* arr, size_t count, Make make) {
+    size_t i = 0;
+    try {
+        for (; i < count; i++) {
+            make(arr + i);
+        }
     }
-    vector(const std::initializer_list<T>& list)
-        : data_{}, size_{list.size()}, capacity_{list.size()} {
+    catch (...) {
+        for (size_t j = 0; j < i; j++) {
+            arr[j].~T();
+        }
+        throw;
+    }
+}
+template <typename T> void init_arr(T* arr, size_t count, const T& val) {
+    FUN_INSTRUMENT_HOOK(on_copy(count));
+    construct_arr(arr, count, [&](T* p) { new (p) T(val); });
+}
+template <typename T> void value_init_arr(T* arr, size_t count) {
+    construct_arr(arr, count, [](T* p) { new (p) T(); });
+}
+template <typename T> void default_init_arr(T* arr, size_t count) {
+    if constexpr (!std::is_trivially_default_constructible_v<T>) {
+        construct_arr(arr, count, [](T* p) { new (p) T; });
+    }
+}
+template <typename T> void copy_into_arr(T* dst, const T* src, size_t count) {
+    FUN_INSTRUMENT_HOOK(on_copy(count));
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        // src may be null for a moved-from vector, which memcpy forbids
+        if (count > 0) {
+            std::memcpy(dst, src, count * sizeof(T));
+        }
+    }
+    else {
+        construct_arr(dst, count, [&](T* p) { new (p) T(src[p - dst]); });
+    }
+}
+template <typename T> void move_into_arr(T* dst, T* src, size_t count) {
+    FUN_INSTRUMENT_HOOK(on_move(count));
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        if (count > 0) {
+            std::memcpy(dst, src, count * sizeof(T));
+        }
+    }
+    else {
+        for (size_t i = 0; i < count; i++) {
+            new (dst + i) T(std::move(src[i]));
+        }
+    }
+}
+template <typename T> void destroy_arr_elements(T* arr, size_t count) {
+    FUN_INSTRUMENT_HOOK(on_destroy(count));
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        for (size_t i = 0; i < count; i++) {
+            arr[i].~T();
+        }
+    }
+}
+/*
+    Same rule as std::move_if_noexcept: if T's move could throw but T is
+    copyable, relocation copies instead, so a throw leaves the source intact.
+*/
+template <typename T>
+inline constexpr bool relocate_by_copy_v =
+    !is_trivially_relocatable_v<T> && !std::is_nothrow_move_constructible_v<T> &&
+    std::is_copy_constructible_v<T>;
+
+/*
+    Move src into dst and end the lifetime of src, i.e. move + destroy.
+
+    With relocate_by_copy_v, a throw leaves src fully intact (and dst cleaned
+    up) so the caller can roll back.
+*/
+template <typename T> void relocate_arr(T* dst, T* src, size_t count) {
+    if constexpr (is_trivially_relocatable_v<T>) {
+        // A move + destroy that happens to be free, counted as just the move
+        FUN_INSTRUMENT_HOOK(on_move(count));
+        if (count > 0) {
+            std::memcpy(static_cast<void*>(dst),
+                        static_cast<const void*>(src), count * sizeof(T));
+        }
+    }
+    else if constexpr (!relocate_by_copy_v<T>) {
+        move_into_arr(dst, src, count);
+        destroy_arr_elements(src, count);
+    }
+    else {
+        copy_into_arr(dst, static_cast<const T*>(src), count);
+        destroy_arr_elements(src, count);
+    }
+}
+}; // namespace detail
+
+template <typename T, typename Allocator = std::allocator<T>,
+          typename Growth = doubling_growth>
+class vector {
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+    static_assert(!detail::has_usable_capacity<Growth>::value ||
+                      std::is_same_v<Allocator, malloc_allocator<T>>,
+                  "growth policies that query the heap need malloc_allocator");
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    // Empty vectors don't allocate, the first insert does
+    vector() : vector(Allocator()) {}
+    explicit vector(const Allocator& alloc)
+        : data_{nullptr}, size_{0}, capacity_{0}, alloc_{alloc} {}
+    vector(const std::initializer_list<T>& list,
+           const Allocator& alloc = Allocator())
+        : data_{}, size_{list.size()}, capacity_{list.size()}, alloc_{alloc} {
         data_ = raw_alloc_arr(size_);
         const T* list_arr = list.begin();
-        copy_into_arr(data_, list_arr, size_);
+        copy_or_free(list_arr, size_);
     }
     ~vector() {
         clear();
-        delete_arr(data_);
+        delete_arr(data_, capacity_);
     }
     vector(const vector& other)
-        : data_{}, size_{other.size_}, capacity_{other.capacity_} {
+        : data_{}, size_{other.size_}, capacity_{other.capacity_},
+          alloc_{alloc_traits::select_on_container_copy_construction(
+              other.alloc_)} {
         data_ = raw_alloc_arr(other.capacity_);
-        copy_into_arr(data_, other.data_, other.size_);
+        copy_or_free(other.data_, other.size_);
     }
     vector& operator=(const vector& other) {
         if (this != &other) {
             // Deallocate the elements we have
             clear();
 
+            // If we adopt their allocator, our buffer has to go back to ours
+            if constexpr (alloc_traits::
+                              propagate_on_container_copy_assignment::value) {
+                if (alloc_ != other.alloc_) {
+                    delete_arr(data_, capacity_);
+                    data_ = nullptr;
+                    capacity_ = 0;
+                }
+                alloc_ = other.alloc_;
+            }
+
             // Only do a realloc if the other buffer has a bigger capacity
             if (other.capacity_ > capacity_) {
-                delete_arr(data_);
-                data_ = raw_alloc_arr(other.capacity_);
+                T* new_data = raw_alloc_arr(other.capacity_);
+                delete_arr(data_, capacity_);
+                data_ = new_data;
 
                 capacity_ = other.capacity_;
             }
 
-            copy_into_arr(data_, other.data_, other.size_);
+            detail::copy_into_arr(data_, other.data_, other.size_);
             size_ = other.size_;
         }
 
         return *this;
     }
-    vector(vector&& other)
-        : data_{other.data_}, size_{other.size_}, capacity_{other.capacity_} {
+    // noexcept so containers of vectors (e.g. a vector<vector<T>>) move
+    // their elements on regrow instead of deep copying them
+    vector(vector&& other) noexcept
+        : data_{other.data_}, size_{other.size_}, capacity_{other.capacity_},
+          alloc_{std::move(other.alloc_)} {
         other.data_ = nullptr;
         other.size_ = 0;
         other.capacity_ = 0;
     }
-    vector& operator=(vector&& other) {
+    // Only noexcept when the buffer can always be stolen, otherwise we may
+    // have to allocate and move element-wise
+    vector& operator=(vector&& other) noexcept(
+        alloc_traits::propagate_on_container_move_assignment::value ||
+        alloc_traits::is_always_equal::value) {
         if (this != &other) {
             // Deallocate the elements we have
             clear();
-            delete_arr(data_);
 
-            data_ = other.data_;
-            capacity_ = other.capacity_;
-            size_ = other.size_;
+            // We can only steal the buffer if our allocator can free it
+            if (alloc_traits::propagate_on_container_move_assignment::value ||
+                alloc_ == other.alloc_) {
+                delete_arr(data_, capacity_);
+                if constexpr (alloc_traits::
+                                  propagate_on_container_move_assignment::
+                                      value) {
+                    alloc_ = std::move(other.alloc_);
+                }
+
+                data_ = other.data_;
+                capacity_ = other.capacity_;
+                size_ = other.size_;
 
-            other.data_ = nullptr;
-            other.capacity_ = 0;
-            other.size_ = 0;
+                other.data_ = nullptr;
+                other.capacity_ = 0;
+                other.size_ = 0;
+            }
+            else {
+                // Different arenas, so fall back to moving element-wise
+                reserve(other.size_);
+                detail::move_into_arr(data_, other.data_, other.size_);
+                size_ = other.size_;
+                other.clear();
+            }
         }
 
         return *this;
     }
 
-    // TODO(A): can we make this strong exception safe (support rollback)?
-    void push_back(const T& val) {
-        // Try placing value at size_ (data_[size_] = val), resize if needed
+    // Strong exception safe: if anything throws, the vector is unchanged
+    void push_back(const T& val) { emplace_back(val); }
+    void push_back(T&& val) { emplace_back(std::move(val)); }
+    template <typename... Args> T& emplace_back(Args&&... args) {
+        // Construct in place at size_ (data_[size_] = T(args...)), grow if needed
         if (size_ == capacity_) {
-            reserve(capacity_ * GROWTH_FACTOR);
+            return *realloc_emplace_back(std::forward<Args>(args)...);
         }
 
-        new (data_ + size_) T(val);
+        T* slot = new (data_ + size_) T(std::forward<Args>(args)...);
         size_++;
+        return *slot;
     }
-    void push_back(T&& val) {
-        // Try placing value at size_ (data_[size_] = val), resize if needed
-        if (size_ == capacity_) {
-            reserve(capacity_ * GROWTH_FACTOR);
+
+    /*
+        Appends [first, last) with at most one reallocation when the distance
+        is known up front (forward iterators), and a single memcpy when the
+        source is contiguous T. Input iterators fall back to emplace_back.
+    */
+    template <typename InputIt> void append(InputIt first, InputIt last) {
+        using category =
+            typename std::iterator_traits<InputIt>::iterator_category;
+
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag, category>) {
+            const size_t count = std::distance(first, last);
+            if (size_ + count > capacity_) {
+                grow_for(size_ + count);
+            }
+
+            construct_from(data_ + size_, first, count);
+            size_ += count;
+        }
+        else {
+            for (; first != last; ++first) {
+                emplace_back(*first);
+            }
         }
+    }
+    template <typename Range> void append_range(const Range& range) {
+        append(std::begin(range), std::end(range));
+    }
 
-        new (data_ + size_) T(std::move(val));
-        size_++;
+    // Inserts [first, last) before pos, returns an iterator to the first new
+    // element. Like std::vector, first/last must not point into *this.
+    template <typename ForwardIt>
+    T* insert(const T* pos, ForwardIt first, ForwardIt last) {
+        const size_t idx = pos - data_;
+        const size_t count = std::distance(first, last);
+        if (count == 0) {
+            return data_ + idx;
+        }
+
+        if (size_ + count > capacity_) {
+            // One new buffer: build the gap first, then relocate around it
+            size_t new_capacity = next_capacity(size_ + count);
+            T* new_data = raw_alloc_growth(new_capacity);
+            try {
+                construct_from(new_data + idx, first, count);
+            }
+            catch (...) {
+                delete_arr(new_data, new_capacity);
+                throw;
+            }
+            relocate_around_gap(new_data, idx, count, new_capacity);
+        }
+        else {
+            // Shift the tail up by count, then fill the hole. If filling
+            // throws, close the hole again so the vector stays valid
+            shift_tail_up(idx, count);
+            try {
+                construct_from(data_ + idx, first, count);
+            }
+            catch (...) {
+                shift_tail_down(idx, count);
+                throw;
+            }
+        }
+
+        size_ += count;
+        return data_ + idx;
+    }
+    T* insert(const T* pos, const T& val) {
+        // val may live inside *this, so take a copy before shifting anything
+        T copy(val);
+        return insert(pos, std::make_move_iterator(&copy),
+                      std::make_move_iterator(&copy + 1));
     }
+
     void clear() {
-        destroy_arr_elements(data_, size_);
+        detail::destroy_arr_elements(data_, size_);
         size_ = 0;
     }
+    // Strong exception safe: a throwing copy leaves the old buffer as it was
     void reserve(size_t new_capacity) {
         if (new_capacity > capacity_) {
-            // Alloc new capacity and std::move existing elements into
-            T* new_data = raw_alloc_arr(new_capacity);
-            move_into_arr(new_data, data_, size_);
+            // Alloc new capacity and relocate existing elements into it
+            T* new_data = raw_alloc_growth(new_capacity);
+            try {
+                detail::relocate_arr(new_data, data_, size_);
+            }
+            catch (...) {
+                delete_arr(new_data, new_capacity);
+                throw;
+            }
 
-            // Deallocate old data_
-            destroy_arr_elements(data_, size_);
-            delete_arr(data_);
+            // Old elements are already moved-from and destroyed
+            delete_arr(data_, capacity_);
             data_ = new_data;
             capacity_ = new_capacity;
         }
     }
-    void resize(size_t count) {}
-    void resize(size_t count, const T& val) {}
+    // Drops unused capacity, strong exception safe like reserve
+    void shrink_to_fit() {
+        if (size_ == capacity_) {
+            return;
+        }
+        if (size_ == 0) {
+            delete_arr(data_, capacity_);
+            data_ = nullptr;
+            capacity_ = 0;
+            return;
+        }
+
+        T* new_data = raw_alloc_arr(size_);
+        try {
+            detail::relocate_arr(new_data, data_, size_);
+        }
+        catch (...) {
+            delete_arr(new_data, size_);
+            throw;
+        }
+
+        delete_arr(data_, capacity_);
+        data_ = new_data;
+        capacity_ = size_;
+    }
+    /*
+        New elements are value-initialized, i.e. zeroed for ints. Grows per
+        the Growth policy like append, so resize(size() + k) in a loop stays
+        amortized O(1) per element.
+    */
+    void resize(size_t count) {
+        if (count <= size_) {
+            shrink_size_to(count);
+            return;
+        }
+
+        if (count > capacity_) {
+            grow_for(count);
+        }
+        detail::value_init_arr(data_ + size_, count - size_);
+        size_ = count;
+    }
+    void resize(size_t count, const T& val) {
+        if (count <= size_) {
+            shrink_size_to(count);
+            return;
+        }
+
+        if (count > capacity_) {
+            // val may be one of our elements, which the regrow would move
+            T copy(val);
+            grow_for(count);
+            detail::init_arr(data_ + size_, count - size_, copy);
+        }
+        else {
+            detail::init_arr(data_ + size_, count - size_, val);
+        }
+        size_ = count;
+    }
+    /*
+        Like resize(count), but new elements are default-initialized, so for
+        trivial T (ints, POD structs) the new slots are left as garbage and
+        nothing is written. Meant for deserializers that fill data() directly.
+    */
+    void resize_default_init(size_t count) {
+        if (count <= size_) {
+            shrink_size_to(count);
+            return;
+        }
+
+        if (count > capacity_) {
+            grow_for(count);
+        }
+        detail::default_init_arr(data_ + size_, count - size_);
+        size_ = count;
+    }
+
+    T* begin() noexcept { return data_; }
+    const T* begin() const noexcept { return data_; }
+    T* end() noexcept { return data_ + size_; }
+    const T* end() const noexcept { return data_ + size_; }
 
     [[nodiscard]] size_t size() const noexcept { return size_; }
     [[nodiscard]] size_t capacity() const noexcept { return capacity_; }
     bool empty() const noexcept { return size_ == 0; }
 
+    allocator_type get_allocator() const { return alloc_; }
+
+    T* data() noexcept { return data_; }
+    const T* data() const noexcept { return data_; }
+
     T& operator[](size_t idx) { return data_[idx]; }
     const T& operator[](size_t idx) const { return data_[idx]; }
 
@@ -141,35 +490,190 @@ private:
     T* data_;
     size_t size_;
     size_t capacity_;
+    Allocator alloc_;
 
-    static T* raw_alloc_arr(size_t desired_capacity) {
-        T* arr =
-            static_cast<T*>(::operator new[](desired_capacity * sizeof(T)));
+    T* raw_alloc_arr(size_t desired_capacity) {
+        T* arr = alloc_traits::allocate(alloc_, desired_capacity);
+        FUN_INSTRUMENT_HOOK(on_allocate(desired_capacity * sizeof(T)));
         return arr;
     }
-    static void init_arr(T* arr, size_t count, const T& val) {
-        for (size_t i = 0; i < count; i++) {
-            new (arr + i) T(val);
+    // Growth buffers may come back bigger than asked if the policy can tell
+    T* raw_alloc_growth(size_t& capacity) {
+        T* arr = raw_alloc_arr(capacity);
+        if constexpr (detail::has_usable_capacity<Growth>::value) {
+            const size_t usable =
+                Growth::usable_capacity(arr, capacity, sizeof(T));
+            // The slack gets freed with the rest, so count it as allocated
+            FUN_INSTRUMENT_HOOK(on_extend((usable - capacity) * sizeof(T)));
+            capacity = usable;
         }
+        return arr;
     }
-    static void copy_into_arr(T* dst, const T* src, size_t count) {
-        for (size_t i = 0; i < count; i++) {
-            new (dst + i) T(src[i]);
+
+    // Amortized growth, policies must handle capacity_ == 0 (empty/moved-from)
+    size_t next_capacity(size_t required) const {
+        return Growth::next_capacity(capacity_, required, sizeof(T));
+    }
+    void grow_for(size_t required) { reserve(next_capacity(required)); }
+
+    // The new element goes into the new buffer before anything is relocated,
+    // so args may alias our own elements and a throw changes nothing
+    template <typename... Args> T* realloc_emplace_back(Args&&... args) {
+        size_t new_capacity = next_capacity(size_ + 1);
+        T* new_data = raw_alloc_growth(new_capacity);
+        T* slot = nullptr;
+        try {
+            slot = new (new_data + size_) T(std::forward<Args>(args)...);
+            detail::relocate_arr(new_data, data_, size_);
         }
+        catch (...) {
+            if (slot != nullptr) {
+                slot->~T();
+            }
+            delete_arr(new_data, new_capacity);
+            throw;
+        }
+
+        delete_arr(data_, capacity_);
+        data_ = new_data;
+        capacity_ = new_capacity;
+        size_++;
+        return slot;
     }
-    static void move_into_arr(T* dst, T* src, size_t count) {
-        for (size_t i = 0; i < count; i++) {
-            new (dst + i) T(std::move(src[i]));
+
+    // Moves [0, idx) and [idx, size_) into new_data around an already built
+    // gap of count elements, then adopts new_data. On a throw, new_data is
+    // freed and data_ is untouched
+    void relocate_around_gap(T* new_data, size_t idx, size_t count,
+                             size_t new_capacity) {
+        try {
+            if constexpr (!detail::relocate_by_copy_v<T>) {
+                detail::relocate_arr(new_data, data_, idx);
+                detail::relocate_arr(new_data + idx + count, data_ + idx,
+                                     size_ - idx);
+            }
+            else {
+                // Copy both halves before destroying anything in data_
+                detail::copy_into_arr(new_data, data_, idx);
+                try {
+                    detail::copy_into_arr(new_data + idx + count, data_ + idx,
+                                          size_ - idx);
+                }
+                catch (...) {
+                    detail::destroy_arr_elements(new_data, idx);
+                    throw;
+                }
+                detail::destroy_arr_elements(data_, size_);
+            }
         }
+        catch (...) {
+            detail::destroy_arr_elements(new_data + idx, count);
+            delete_arr(new_data, new_capacity);
+            throw;
+        }
+
+        delete_arr(data_, capacity_);
+        data_ = new_data;
+        capacity_ = new_capacity;
     }
-    static void destroy_arr_elements(T* arr, size_t count) {
-        for (size_t i = 0; i < count; i++) {
-            arr[i].~T();
+
+    // Constructor helper, a failed copy must not leak the fresh buffer
+    void copy_or_free(const T* src, size_t count) {
+        try {
+            detail::copy_into_arr(data_, src, count);
+        }
+        catch (...) {
+            delete_arr(data_, capacity_);
+            throw;
+        }
+    }
+
+    void shrink_size_to(size_t count) {
+        detail::destroy_arr_elements(data_ + count, size_ - count);
+        size_ = count;
+    }
+
+    // Constructs count elements at dst from an iterator, memcpy if we can
+    template <typename ForwardIt>
+    static void construct_from(T* dst, ForwardIt first, size_t count) {
+        if constexpr (std::is_pointer_v<ForwardIt> &&
+                      std::is_same_v<std::remove_cv_t<std::remove_pointer_t<
+                                         ForwardIt>>,
+                                     T>) {
+            detail::copy_into_arr(dst, first, count);
+        }
+        else {
+            size_t i = 0;
+            try {
+                for (; i < count; i++, ++first) {
+                    new (dst + i) T(*first);
+                }
+            }
+            catch (...) {
+                detail::destroy_arr_elements(dst, i);
+                throw;
+            }
+        }
+    }
+
+    // Opens a hole of count slots at idx (capacity must already fit it)
+    void shift_tail_up(size_t idx, size_t count) {
+        const size_t tail = size_ - idx;
+        if constexpr (is_trivially_relocatable_v<T>) {
+            if (tail > 0) {
+                std::memmove(static_cast<void*>(data_ + idx + count),
+                             static_cast<const void*>(data_ + idx),
+                             tail * sizeof(T));
+            }
+        }
+        else {
+            // Back to front so we never overwrite an element not yet moved
+            for (size_t i = size_; i > idx; i--) {
+                new (data_ + i - 1 + count) T(std::move(data_[i - 1]));
+                data_[i - 1].~T();
+            }
+        }
+    }
+
+    // Undoes shift_tail_up once the hole turned out not to be fillable
+    void shift_tail_down(size_t idx, size_t count) {
+        const size_t tail = size_ - idx;
+        if constexpr (is_trivially_relocatable_v<T>) {
+            if (tail > 0) {
+                std::memmove(static_cast<void*>(data_ + idx),
+                             static_cast<const void*>(data_ + idx + count),
+                             tail * sizeof(T));
+            }
+        }
+        else {
+            for (size_t i = idx; i < size_; i++) {
+                new (data_ + i) T(std::move(data_[i + count]));
+                data_[i + count].~T();
+            }
+        }
+    }
+
+    void delete_arr(T* arr, size_t capacity) {
+        // Moved-from vectors hold nullptr, which not every allocator accepts
+        if (arr != nullptr) {
+            FUN_INSTRUMENT_HOOK(on_deallocate(capacity * sizeof(T)));
+            alloc_traits::deallocate(alloc_, arr, capacity);
         }
     }
-    static void delete_arr(T* arr) { ::operator delete[](arr); }
 };
 
 template <typename T> vector(std::initializer_list<T>) -> vector<T>;
 
+// A vector is just a pointer + sizes, nothing points back into it, so a
+// vector<vector<T>> can regrow with one memcpy
+template <typename T, typename Growth>
+struct is_trivially_relocatable<vector<T, std::allocator<T>, Growth>>
+    : std::true_type {};
+
+namespace pmr {
+// Vectors that draw from a std::pmr::memory_resource, e.g. fun::monotonic_arena
+template <typename T>
+using vector = fun::vector<T, std::pmr::polymorphic_allocator<T>>;
+}; // namespace pmr
+
 }; // namespace fun
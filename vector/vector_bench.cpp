@@ -0,0 +1,271 @@
+#include "vector.hpp"
+#include "memory_resource.hpp"
+#include "peak_rss.hpp"
+#include <benchmark/benchmark.h>
+#include <vector>
+
+/*
+    Regrow cost of the memcpy fast path vs. the old element-by-element path.
+
+    ScalarRecord has the exact same layout as Record, but a user-provided copy
+    and move constructor hide its triviality, so it takes the loop path that
+    every type used to take.
+*/
+struct Record {
+    int id;
+    float x, y, z;
+
+    Record() = default;
+    Record(int i) : id{i}, x{}, y{}, z{} {}
+};
+
+struct ScalarRecord {
+    int id;
+    float x, y, z;
+
+    ScalarRecord(int i) : id{i}, x{}, y{}, z{} {}
+    ScalarRecord(const ScalarRecord& o) : id{o.id}, x{o.x}, y{o.y}, z{o.z} {}
+    ScalarRecord(ScalarRecord&& o) : id{o.id}, x{o.x}, y{o.y}, z{o.z} {}
+    ~ScalarRecord() {}
+};
+
+template <typename T> static void BM_Regrow(benchmark::State& state) {
+    const size_t n = state.range(0);
+    for (auto _ : state) {
+        fun::vector<T> v;
+        for (size_t i = 0; i < n; i++) {
+            v.push_back(T{static_cast<int>(i)});
+        }
+        benchmark::DoNotOptimize(v[n - 1]);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK_TEMPLATE(BM_Regrow, Record)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_Regrow, ScalarRecord)->Range(1 << 10, 1 << 22);
+
+// A single reserve of an already full vector isolates the relocation itself
+template <typename T> static void BM_ReserveOnce(benchmark::State& state) {
+    const size_t n = state.range(0);
+    fun::vector<T> src;
+    for (size_t i = 0; i < n; i++) {
+        src.push_back(T{static_cast<int>(i)});
+    }
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        fun::vector<T> v(src);
+        state.ResumeTiming();
+
+        v.reserve(2 * v.capacity());
+        benchmark::DoNotOptimize(v[0]);
+    }
+    state.SetBytesProcessed(state.iterations() * n * sizeof(T));
+}
+BENCHMARK_TEMPLATE(BM_ReserveOnce, Record)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_ReserveOnce, ScalarRecord)->Range(1 << 10, 1 << 22);
+
+template <typename T> static void BM_CopyCtor(benchmark::State& state) {
+    const size_t n = state.range(0);
+    fun::vector<T> src;
+    for (size_t i = 0; i < n; i++) {
+        src.push_back(T{static_cast<int>(i)});
+    }
+
+    for (auto _ : state) {
+        fun::vector<T> v(src);
+        benchmark::DoNotOptimize(v[0]);
+    }
+    state.SetBytesProcessed(state.iterations() * n * sizeof(T));
+}
+BENCHMARK_TEMPLATE(BM_CopyCtor, Record)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_CopyCtor, ScalarRecord)->Range(1 << 10, 1 << 22);
+
+/*
+    Request-scoped scratch work: build a batch of short-lived vectors of
+    varying sizes, then tear everything down, once per "request".
+*/
+template <typename MakeVector>
+static void request_workload(benchmark::State& state, MakeVector make) {
+    const size_t num_vectors = state.range(0);
+    for (auto _ : state) {
+        for (size_t i = 0; i < num_vectors; i++) {
+            auto v = make();
+            const size_t n = 1 + (i * 7) % 64;
+            for (size_t j = 0; j < n; j++) {
+                v.push_back(static_cast<int>(j));
+            }
+            benchmark::DoNotOptimize(v[0]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * num_vectors);
+}
+
+static void BM_RequestGlobalHeap(benchmark::State& state) {
+    request_workload(state, [] { return fun::vector<int>{}; });
+}
+BENCHMARK(BM_RequestGlobalHeap)->Range(64, 4096);
+
+static void BM_RequestArena(benchmark::State& state) {
+    fun::monotonic_arena arena;
+    const size_t num_vectors = state.range(0);
+    for (auto _ : state) {
+        for (size_t i = 0; i < num_vectors; i++) {
+            fun::pmr::vector<int> v{&arena};
+            const size_t n = 1 + (i * 7) % 64;
+            for (size_t j = 0; j < n; j++) {
+                v.push_back(static_cast<int>(j));
+            }
+            benchmark::DoNotOptimize(v[0]);
+        }
+        // End of the request, everything goes at once
+        arena.release();
+    }
+    state.SetItemsProcessed(state.iterations() * num_vectors);
+}
+BENCHMARK(BM_RequestArena)->Range(64, 4096);
+
+static void BM_RequestPool(benchmark::State& state) {
+    fun::pool_resource pool;
+    request_workload(state, [&] { return fun::pmr::vector<int>{&pool}; });
+}
+BENCHMARK(BM_RequestPool)->Range(64, 4096);
+
+/*
+    Batched appends vs. a push_back loop, as seen by a deserializer that
+    knows how many records are coming.
+*/
+static void BM_PushBackLoop(benchmark::State& state) {
+    const size_t n = state.range(0);
+    fun::vector<Record> src;
+    src.resize_default_init(n);
+
+    for (auto _ : state) {
+        fun::vector<Record> v;
+        for (size_t i = 0; i < n; i++) {
+            v.push_back(src[i]);
+        }
+        benchmark::DoNotOptimize(v.data());
+    }
+    state.SetBytesProcessed(state.iterations() * n * sizeof(Record));
+}
+BENCHMARK(BM_PushBackLoop)->Range(1 << 8, 1 << 20);
+
+static void BM_Append(benchmark::State& state) {
+    const size_t n = state.range(0);
+    fun::vector<Record> src;
+    src.resize_default_init(n);
+
+    for (auto _ : state) {
+        fun::vector<Record> v;
+        v.append(src.begin(), src.end());
+        benchmark::DoNotOptimize(v.data());
+    }
+    state.SetBytesProcessed(state.iterations() * n * sizeof(Record));
+}
+BENCHMARK(BM_Append)->Range(1 << 8, 1 << 20);
+
+static void BM_ResizeDefaultInitFill(benchmark::State& state) {
+    const size_t n = state.range(0);
+    fun::vector<Record> src;
+    src.resize_default_init(n);
+
+    for (auto _ : state) {
+        fun::vector<Record> v;
+        v.resize_default_init(n);
+        std::memcpy(v.data(), src.data(), n * sizeof(Record));
+        benchmark::DoNotOptimize(v.data());
+    }
+    state.SetBytesProcessed(state.iterations() * n * sizeof(Record));
+}
+BENCHMARK(BM_ResizeDefaultInitFill)->Range(1 << 8, 1 << 20);
+
+/*
+    Outer containers only move their elements on regrow if the element's move
+    constructor is noexcept. LegacyVector is a fun::vector whose move is not
+    noexcept (like fun::vector used to be), so std::vector deep copies every
+    inner vector on each regrow.
+*/
+struct LegacyVector : fun::vector<int> {
+    LegacyVector() = default;
+    LegacyVector(const LegacyVector&) = default;
+    LegacyVector(LegacyVector&& other) : fun::vector<int>(std::move(other)) {}
+};
+
+template <typename Outer> static void BM_NestedRegrow(benchmark::State& state) {
+    const size_t outer = state.range(0);
+    const size_t inner = state.range(1);
+    for (auto _ : state) {
+        Outer v;
+        for (size_t i = 0; i < outer; i++) {
+            typename Outer::value_type row;
+            for (size_t j = 0; j < inner; j++) {
+                row.push_back(static_cast<int>(j));
+            }
+            v.push_back(std::move(row));
+        }
+        benchmark::DoNotOptimize(v.data());
+    }
+    state.SetItemsProcessed(state.iterations() * outer);
+}
+BENCHMARK_TEMPLATE(BM_NestedRegrow, std::vector<LegacyVector>)
+    ->Ranges({{1 << 8, 1 << 14}, {4, 256}});
+BENCHMARK_TEMPLATE(BM_NestedRegrow, std::vector<fun::vector<int>>)
+    ->Ranges({{1 << 8, 1 << 14}, {4, 256}});
+BENCHMARK_TEMPLATE(BM_NestedRegrow, fun::vector<fun::vector<int>>)
+    ->Ranges({{1 << 8, 1 << 14}, {4, 256}});
+
+/*
+    Growth policies on push-heavy workloads. Besides time, each run reports
+
+    bytes_copied: bytes relocated by regrows (size * sizeof(T) per regrow)
+    peak_rss_kb:  the process high-water mark, reset right before the run
+                  through /proc/self/clear_refs (see peak_rss.hpp)
+*/
+template <typename Vec> static void BM_GrowthPolicy(benchmark::State& state) {
+    const size_t n = state.range(0);
+    size_t bytes_copied = 0;
+    size_t peak_kb = 0;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        fun::reset_peak_rss();
+        bytes_copied = 0;
+        state.ResumeTiming();
+
+        Vec v;
+        size_t capacity = v.capacity();
+        for (size_t i = 0; i < n; i++) {
+            const size_t before = v.size();
+            v.push_back(Record{static_cast<int>(i)});
+            if (v.capacity() != capacity) {
+                bytes_copied += before * sizeof(Record);
+                capacity = v.capacity();
+            }
+        }
+        benchmark::DoNotOptimize(v.data());
+
+        state.PauseTiming();
+        peak_kb = fun::peak_rss_kb();
+        state.ResumeTiming();
+    }
+
+    state.counters["bytes_copied"] = bytes_copied;
+    state.counters["peak_rss_kb"] = peak_kb;
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK_TEMPLATE(BM_GrowthPolicy,
+                   fun::vector<Record, std::allocator<Record>,
+                               fun::doubling_growth>)
+    ->Range(1 << 10, 1 << 24);
+BENCHMARK_TEMPLATE(BM_GrowthPolicy,
+                   fun::vector<Record, std::allocator<Record>,
+                               fun::golden_growth>)
+    ->Range(1 << 10, 1 << 24);
+BENCHMARK_TEMPLATE(BM_GrowthPolicy,
+                   fun::vector<Record, std::allocator<Record>,
+                               fun::page_growth>)
+    ->Range(1 << 10, 1 << 24);
+BENCHMARK_TEMPLATE(BM_GrowthPolicy,
+                   fun::vector<Record, fun::malloc_allocator<Record>,
+                               fun::malloc_usable_growth>)
+    ->Range(1 << 10, 1 << 24);
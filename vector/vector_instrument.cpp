@@ -0,0 +1,120 @@
+#include "vector.hpp"
+#include <gtest/gtest.h>
+#include <sstream>
+
+/*
+    Built with FUN_INSTRUMENT, checks the hooks count what fun::vector
+    actually does, and shows the allocation budget pattern.
+*/
+using fun::instrument::counting_element;
+using fun::instrument::scope;
+
+static_assert(fun::instrument::histogram_bucket(0) == 0);
+static_assert(fun::instrument::histogram_bucket(1) == 0);
+static_assert(fun::instrument::histogram_bucket(64) == 6);
+static_assert(fun::instrument::histogram_bucket(127) == 6);
+
+TEST(VectorInstrumentTests, ReserveIsOneAllocation) {
+    scope s;
+    {
+        fun::vector<int> v;
+        v.reserve(100);
+        for (int i = 0; i < 100; i++) {
+            v.push_back(i);
+        }
+    }
+    const auto d = s.delta();
+    EXPECT_EQ(d.allocations, 1);
+    EXPECT_EQ(d.deallocations, 1);
+    EXPECT_EQ(d.bytes_allocated, 100 * sizeof(int));
+    EXPECT_EQ(d.live_bytes(), 0);
+    EXPECT_EQ(d.alloc_histogram[fun::instrument::histogram_bucket(400)], 1);
+}
+
+TEST(VectorInstrumentTests, GrowthBudget) {
+    scope s;
+    fun::vector<int> v;
+    for (int i = 0; i < 1000; i++) {
+        v.push_back(i);
+    }
+
+    // Doubling from 1 reaches 1000 in 11 allocations, everything but the
+    // last buffer is freed again
+    const auto d = s.delta();
+    EXPECT_LE(d.allocations, 11);
+    EXPECT_EQ(d.deallocations, d.allocations - 1);
+    EXPECT_EQ(d.live_bytes(), v.capacity() * sizeof(int));
+}
+
+TEST(VectorInstrumentTests, CopyAndMoveCounts) {
+    fun::vector<counting_element> src;
+    src.reserve(8);
+    for (int i = 0; i < 8; i++) {
+        src.emplace_back(i);
+    }
+
+    scope s;
+    counting_element::tally() = {};
+    fun::vector<counting_element> copy(src);
+    fun::vector<counting_element> moved(std::move(copy));
+
+    // The hooks agree with what the elements saw themselves
+    const auto d = s.delta();
+    EXPECT_EQ(d.copies, 8);
+    EXPECT_EQ(counting_element::tally().copies, 8);
+    // Moving the vector steals the buffer, no element is touched
+    EXPECT_EQ(d.moves, 0);
+    EXPECT_EQ(counting_element::tally().moves, 0);
+    EXPECT_EQ(d.allocations, 1);
+}
+
+TEST(VectorInstrumentTests, RegrowMovesEveryElement) {
+    fun::vector<counting_element> v;
+    v.reserve(4);
+    for (int i = 0; i < 4; i++) {
+        v.emplace_back(i);
+    }
+
+    scope s;
+    counting_element::tally() = {};
+    v.reserve(16);
+
+    const auto d = s.delta();
+    EXPECT_EQ(d.moves, 4);
+    EXPECT_EQ(d.destroys, 4);
+    EXPECT_EQ(counting_element::tally().moves, 4);
+    EXPECT_EQ(counting_element::tally().destroys, 4);
+}
+
+TEST(VectorInstrumentTests, MemcpyPathsStillCount) {
+    fun::vector<int> v;
+    v.resize(32, 7);
+
+    scope s;
+    fun::vector<int> copy(v);
+    v.reserve(64);
+    EXPECT_EQ(s.delta().copies, 32);
+    EXPECT_EQ(s.delta().moves, 32);
+}
+
+TEST(VectorInstrumentTests, ClearDestroys) {
+    fun::vector<counting_element> v;
+    v.resize(5);
+    counting_element::tally() = {};
+
+    scope s;
+    v.clear();
+    EXPECT_EQ(s.delta().destroys, 5);
+    EXPECT_EQ(counting_element::tally().destroys, 5);
+}
+
+TEST(VectorInstrumentTests, Report) {
+    fun::instrument::reset();
+    fun::vector<int> v;
+    v.reserve(10);
+
+    std::ostringstream out;
+    fun::instrument::report(out);
+    EXPECT_NE(out.str().find("allocations: 1 (40 bytes)"), std::string::npos);
+    EXPECT_NE(out.str().find("[32, 64): 1"), std::string::npos);
+}